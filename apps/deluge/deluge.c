@@ -90,6 +90,11 @@ static struct ctimer profile_timer;
    the next_object_id parameter. */
 static deluge_object_id_t next_object_id;
 
+#if DELUGE_COMPRESSION
+static char *image_file;
+static char *base_file;
+#endif
+
 /* Rime callbacks. */
 static void broadcast_recv(struct broadcast_conn *, const rimeaddr_t *);
 static void unicast_recv(struct unicast_conn *, const rimeaddr_t *);
@@ -113,6 +118,12 @@ transition(int state)
       ctimer_stop(&rx_timer);
       break;
     case DELUGE_STATE_TX:
+#if DELUGE_PIPELINING
+      /* Keep serving the current page while receiving the next one. */
+      if(state == DELUGE_STATE_RX) {
+        break;
+      }
+#endif
       ctimer_stop(&tx_timer);
       break;
     }
@@ -146,6 +157,165 @@ read_page(struct deluge_object *obj, unsigned pagenum, unsigned char *buf)
   return cfs_read(obj->cfs_fd, (char *)buf, S_PAGE);
 }
 
+#if DELUGE_COMPRESSION
+struct lz_input {
+  int fd;
+  cfs_offset_t offset;
+  cfs_offset_t end;
+  int len;
+  int pos;
+  unsigned char buf[32];
+};
+
+static int
+lz_getc(struct lz_input *in)
+{
+  if(in->pos == in->len) {
+    if(in->offset >= in->end ||
+       cfs_seek(in->fd, in->offset, CFS_SEEK_SET) != in->offset) {
+      return -1;
+    }
+    in->len = cfs_read(in->fd, (char *)in->buf, sizeof(in->buf));
+    if(in->len <= 0) {
+      return -1;
+    }
+    in->offset += in->len;
+    in->pos = 0;
+  }
+  return in->buf[in->pos++];
+}
+
+/* Copy len bytes from offset from in from_fd to the end of the output.
+   from_fd may be the output itself, in which case the source and the
+   destination can overlap. */
+static int
+lz_copy(int from_fd, cfs_offset_t from, int out_fd, cfs_offset_t *out_len,
+	unsigned len)
+{
+  unsigned char buf[32];
+  unsigned n;
+
+  while(len > 0) {
+    n = len > sizeof(buf) ? sizeof(buf) : len;
+    if(from_fd == out_fd && n > *out_len - from) {
+      n = *out_len - from;
+    }
+    if(cfs_seek(from_fd, from, CFS_SEEK_SET) != from ||
+       cfs_read(from_fd, (char *)buf, n) != n ||
+       cfs_seek(out_fd, *out_len, CFS_SEEK_SET) != *out_len ||
+       cfs_write(out_fd, (char *)buf, n) != n) {
+      return -1;
+    }
+    from += n;
+    *out_len += n;
+    len -= n;
+  }
+  return 0;
+}
+
+static int
+decompress_object(struct deluge_object *obj)
+{
+  struct lz_input in;
+  int out_fd, base_fd;
+  cfs_offset_t out_len;
+  cfs_offset_t base_offset;
+  int control, bits, c, c2, ret, i;
+  unsigned len, offset;
+
+  if(image_file == NULL) {
+    return -1;
+  }
+
+  in.fd = obj->cfs_fd;
+  in.offset = 0;
+  in.end = (cfs_offset_t)OBJECT_PAGE_COUNT(*obj) * S_PAGE;
+  in.len = in.pos = 0;
+
+  base_fd = -1;
+  if(base_file != NULL) {
+    base_fd = cfs_open(base_file, CFS_READ);
+  }
+  cfs_remove(image_file);
+  out_fd = cfs_open(image_file, CFS_READ | CFS_WRITE);
+  if(out_fd < 0) {
+    if(base_fd >= 0) {
+      cfs_close(base_fd);
+    }
+    return -1;
+  }
+
+  out_len = 0;
+  control = bits = 0;
+  ret = -1;
+  for(;;) {
+    if(bits == 0) {
+      control = lz_getc(&in);
+      if(control < 0) {
+        break;
+      }
+      bits = 8;
+    }
+    bits--;
+    c = lz_getc(&in);
+    if(c < 0) {
+      break;
+    }
+    if(control & 1) {
+      /* A literal. */
+      unsigned char literal = c;
+      if(cfs_seek(out_fd, out_len, CFS_SEEK_SET) != out_len ||
+         cfs_write(out_fd, (char *)&literal, 1) != 1) {
+        break;
+      }
+      out_len++;
+    } else {
+      c2 = lz_getc(&in);
+      if(c2 < 0) {
+        break;
+      }
+      if((c >> 4) != DELUGE_LZ_BASE_COPY) {
+        /* A match in the output. */
+        len = (c >> 4) + DELUGE_LZ_MIN_MATCH;
+        offset = (((unsigned)c & 0x0f) << 8 | c2) + 1;
+        if(offset > out_len ||
+           lz_copy(out_fd, out_len - offset, out_fd, &out_len, len) < 0) {
+          break;
+        }
+      } else {
+        len = ((unsigned)c & 0x0f) << 8 | c2;
+        if(len == 0) {
+          ret = 0;
+          break;
+        }
+        /* A match in the base image. */
+        base_offset = 0;
+        for(i = 0; i < 3; i++) {
+          c = lz_getc(&in);
+          if(c < 0) {
+            break;
+          }
+          base_offset = base_offset << 8 | c;
+        }
+        if(c < 0 || base_fd < 0 ||
+           lz_copy(base_fd, base_offset, out_fd, &out_len, len) < 0) {
+          break;
+        }
+      }
+    }
+    control >>= 1;
+  }
+
+  cfs_close(out_fd);
+  if(base_fd >= 0) {
+    cfs_close(base_fd);
+  }
+  PRINTF("Decompressed %ld bytes into %s: %s\n", (long)out_len, image_file,
+	ret == 0 ? "ok" : "failed");
+  return ret;
+}
+#endif /* DELUGE_COMPRESSION */
+
 static void
 init_page(struct deluge_object *obj, int pagenum, int have)
 {
@@ -205,6 +375,7 @@ init_object(struct deluge_object *obj, char *filename, unsigned version)
   obj->current_rx_page = 0;
   obj->nrequests = 0;
   obj->tx_set = 0;
+  obj->summary_available = 0;
 
   obj->pages = malloc(OBJECT_PAGE_COUNT(*obj) * sizeof(*obj->pages));
   if(obj->pages == NULL) {
@@ -333,6 +504,7 @@ handle_summary(struct deluge_msg_summary *msg, const rimeaddr_t *sender)
     }
 
     rimeaddr_copy(&current_object.summary_from, sender);
+    current_object.summary_available = msg->highest_available;
     transition(DELUGE_STATE_RX);
 
     if(ctimer_expired(&rx_timer)) {
@@ -389,6 +561,12 @@ tx_callback(void *arg)
       packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE,
 			 PACKETBUF_ATTR_PACKET_TYPE_STREAM_END);
       obj->current_tx_page = -1;
+#if DELUGE_PIPELINING
+      if(deluge_state == DELUGE_STATE_RX) {
+        /* Still receiving pages: keep the RX timer running. */
+        return;
+      }
+#endif
       transition(DELUGE_STATE_MAINTAIN);
     }
   }
@@ -422,7 +600,14 @@ handle_request(struct deluge_msg_request *msg)
       current_object.tx_set = msg->request_set;
     }
 
+#if DELUGE_PIPELINING
+    /* Serve the page without interrupting the reception of ours. */
+    if(deluge_state != DELUGE_STATE_RX) {
+      transition(DELUGE_STATE_TX);
+    }
+#else
     transition(DELUGE_STATE_TX);
+#endif
     ctimer_set(&tx_timer, CLOCK_SECOND, tx_callback, &current_object);
   }
 }
@@ -479,7 +664,21 @@ handle_packet(struct deluge_msg_packet *msg)
 	leds_on(LEDS_RED);
 	PRINTF("Update completed for object %u, version %u\n", 
 	       (unsigned)current_object.object_id, packet.version);
+#if DELUGE_COMPRESSION
+	decompress_object(&current_object);
+#endif
       } else if(current_object.current_rx_page < OBJECT_PAGE_COUNT(current_object)) {
+#if DELUGE_PIPELINING
+        if(current_object.current_rx_page <
+           current_object.summary_available) {
+          /* The neighbor has the next page too: request it right away
+             instead of waiting for its next summary. */
+          current_object.nrequests = 0;
+          ctimer_set(&rx_timer, (unsigned)random_rand() % T_R,
+		send_request, &current_object);
+          return;
+        }
+#endif
         if(ctimer_expired(&rx_timer)) {
 	  ctimer_set(&rx_timer,
 		CONST_OMEGA * ESTIMATED_TX_TIME + (random_rand() % T_R),
@@ -626,6 +825,15 @@ broadcast_recv(struct broadcast_conn *c, const rimeaddr_t *sender)
   command_dispatcher(sender);
 }
 
+#if DELUGE_COMPRESSION
+void
+deluge_set_image(char *image, char *base)
+{
+  image_file = image;
+  base_file = base;
+}
+#endif
+
 int
 deluge_disseminate(char *file, unsigned version)
 {
@@ -52,6 +52,40 @@ PROCESS_NAME(deluge_process);
     }							\
   } while (0)
 
+/* Pipelining lets a node request the next page from its neighbor as
+   soon as a page completes, and keep serving the pages it has while
+   it receives new ones. */
+#ifdef DELUGE_CONF_PIPELINING
+#define DELUGE_PIPELINING	DELUGE_CONF_PIPELINING
+#else
+#define DELUGE_PIPELINING	0
+#endif
+
+/* With compression, the disseminated object is a compressed stream
+   (see tools/deluge-compress.c) that the receivers decompress into
+   the image file set with deluge_set_image() once all the pages have
+   arrived. The object is forwarded in its compressed form.
+
+   The stream is a sequence of groups of a control byte followed by
+   eight items, one per bit of the control byte from the least
+   significant one. A set bit is a literal byte. A cleared bit is a
+   two-byte match LLLLOOOO OOOOOOOO: if LLLL is below 15, LLLL + 3
+   bytes are copied from O + 1 bytes back in the output. Otherwise,
+   the low nibble of the first byte and the second byte hold a length
+   of up to 4095 bytes, which are copied from the base image at the
+   big-endian 24-bit offset that follows. A length of 0 ends the
+   stream. */
+#ifdef DELUGE_CONF_COMPRESSION
+#define DELUGE_COMPRESSION	DELUGE_CONF_COMPRESSION
+#else
+#define DELUGE_COMPRESSION	0
+#endif
+
+#define DELUGE_LZ_MIN_MATCH	3
+#define DELUGE_LZ_MAX_MATCH	(14 + DELUGE_LZ_MIN_MATCH)
+#define DELUGE_LZ_WINDOW	4096
+#define DELUGE_LZ_BASE_COPY	15
+
 #define DELUGE_UNICAST_CHANNEL		55
 #define DELUGE_BROADCAST_CHANNEL	56
 
@@ -143,6 +177,7 @@ struct deluge_object {
   uint8_t tx_set;
   int cfs_fd;
   rimeaddr_t summary_from;
+  uint8_t summary_available;
 };
 
 struct deluge_page {
@@ -156,4 +191,11 @@ struct deluge_page {
 
 int deluge_disseminate(char *file, unsigned version);
 
+#if DELUGE_COMPRESSION
+/* Set the file that receives the decompressed object, and the file
+   holding the image that the matches of the delta refer to, or NULL.
+   The two files must be different. */
+void deluge_set_image(char *image, char *base);
+#endif
+
 #endif
@@ -280,17 +280,24 @@ static void
 send_udp_packet(struct uip_udp_conn *conn)
 {
   int numregs;
-  uint8_t buf[MAX_BUFSIZE];
+  uint8_t *buf;
+  int bufsize;
   int bufptr;
   servreg_hack_item_t *t;
 
+  /* Build the message directly in the outgoing packet. */
+  buf = uip_udp_packet_buf(&bufsize);
+  if(bufsize > MAX_BUFSIZE) {
+    bufsize = MAX_BUFSIZE;
+  }
+
   buf[MSG_FLAGS_OFFSET]   = 0;
 
   numregs = 0;
   bufptr = MSG_ADDRS_OFFSET;
   
   for(t = list_head(own_services);
-      (bufptr + MSG_ADDRS_LEN <= MAX_BUFSIZE) && t != NULL;
+      (bufptr + MSG_ADDRS_LEN <= bufsize) && t != NULL;
       t = list_item_next(t)) {
 
     uip_ipaddr_copy((uip_ipaddr_t *)&buf[bufptr + MSG_IPADDR_SUBOFFSET],
@@ -306,7 +313,7 @@ send_udp_packet(struct uip_udp_conn *conn)
   }
 
   for(t = servreg_hack_list_head();
-      (bufptr + MSG_ADDRS_LEN <= MAX_BUFSIZE) && t != NULL;
+      (bufptr + MSG_ADDRS_LEN <= bufsize) && t != NULL;
       t = list_item_next(t)) {
     uip_ipaddr_copy((uip_ipaddr_t *)&buf[bufptr + MSG_IPADDR_SUBOFFSET],
                     servreg_hack_item_address(t));
@@ -324,7 +331,7 @@ send_udp_packet(struct uip_udp_conn *conn)
 
   if(numregs > 0) {
     /*    printf("Sending buffer len %d\n", bufptr);*/
-    uip_udp_packet_send(conn, buf, bufptr);
+    uip_udp_packet_commit(conn, bufptr);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -32,7 +32,7 @@
 #include "dev/serial-line.h"
 #include <string.h> /* for memcpy() */
 
-#include "lib/ringbuf.h"
+#include "lib/ringbuf16.h"
 
 #ifdef SERIAL_LINE_CONF_BUFSIZE
 #define BUFSIZE SERIAL_LINE_CONF_BUFSIZE
@@ -45,10 +45,14 @@
 #error Change SERIAL_LINE_CONF_BUFSIZE in contiki-conf.h.
 #endif
 
+#if BUFSIZE > 32768
+#error SERIAL_LINE_CONF_BUFSIZE cannot be larger than 32768.
+#endif
+
 #define IGNORE_CHAR(c) (c == 0x0d)
 #define END 0x0a
 
-static struct ringbuf rxbuf;
+static struct ringbuf16 rxbuf;
 static uint8_t rxbuf_data[BUFSIZE];
 
 PROCESS(serial_line_process, "Serial driver");
@@ -67,14 +71,14 @@ serial_line_input_byte(unsigned char c)
 
   if(!overflow) {
     /* Add character */
-    if(ringbuf_put(&rxbuf, c) == 0) {
+    if(ringbuf16_put(&rxbuf, c) == 0) {
       /* Buffer overflow: ignore the rest of the line */
       overflow = 1;
     }
   } else {
     /* Buffer overflowed:
      * Only (try to) add terminator characters, otherwise skip */
-    if(c == END && ringbuf_put(&rxbuf, c) != 0) {
+    if(c == END && ringbuf16_put(&rxbuf, c) != 0) {
       overflow = 0;
     }
   }
@@ -95,20 +99,32 @@ PROCESS_THREAD(serial_line_process, ev, data)
   ptr = 0;
 
   while(1) {
-    /* Fill application buffer until newline or empty */
-    int c = ringbuf_get(&rxbuf);
-    
-    if(c == -1) {
+    /* Fill application buffer until newline or empty. The received
+       bytes are scanned in place, one contiguous span at a time. */
+    uint8_t *span;
+    uint16_t len, i, n;
+
+    len = ringbuf16_read_span(&rxbuf, &span);
+
+    if(len == 0) {
       /* Buffer empty, wait for poll */
       PROCESS_YIELD();
     } else {
-      if(c != END) {
-        if(ptr < BUFSIZE-1) {
-          buf[ptr++] = (uint8_t)c;
-        } else {
-          /* Ignore character (wait for EOL) */
-        }
+      for(i = 0; i < len && span[i] != END; i++);
+
+      /* Characters that do not fit are ignored (wait for EOL) */
+      n = BUFSIZE - 1 - ptr;
+      if(n > i) {
+        n = i;
+      }
+      memcpy(&buf[ptr], span, n);
+      ptr += n;
+
+      if(i == len) {
+        ringbuf16_consume(&rxbuf, len);
       } else {
+        ringbuf16_consume(&rxbuf, i + 1);
+
         /* Terminate */
         buf[ptr++] = (uint8_t)'\0';
 
@@ -131,7 +147,7 @@ PROCESS_THREAD(serial_line_process, ev, data)
 void
 serial_line_init(void)
 {
-  ringbuf_init(&rxbuf, rxbuf_data, sizeof(rxbuf_data));
+  ringbuf16_init(&rxbuf, rxbuf_data, sizeof(rxbuf_data));
   process_start(&serial_line_process, NULL);
 }
 /*---------------------------------------------------------------------------*/
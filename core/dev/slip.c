@@ -42,6 +42,7 @@
 #define BUF ((struct uip_tcpip_hdr *)&uip_buf[UIP_LLH_LEN])
 
 #include "dev/slip.h"
+#include "lib/ringbuf16.h"
 
 #define SLIP_END     0300
 #define SLIP_ESC     0333
@@ -59,31 +60,42 @@ uint16_t slip_rubbish, slip_twopackets, slip_overflow, slip_ip_drop;
 #define SLIP_STATISTICS(statement) statement
 #endif
 
-/* Must be at least one byte larger than UIP_BUFSIZE! */
-#define RX_BUFSIZE (UIP_BUFSIZE - UIP_LLH_LEN + 16)
+/*
+ * The UART receive interrupt only puts the raw bytes into rxbuf, which
+ * must be a power of two. They are decoded by slip_process. rxbuf holds
+ * at least one packet of UIP_BUFSIZE bytes plus some framing.
+ */
+#ifdef SLIP_CONF_RX_BUFSIZE
+#define RX_BUFSIZE SLIP_CONF_RX_BUFSIZE
+#elif UIP_BUFSIZE - UIP_LLH_LEN + 16 <= 128
+#define RX_BUFSIZE 128
+#elif UIP_BUFSIZE - UIP_LLH_LEN + 16 <= 256
+#define RX_BUFSIZE 256
+#elif UIP_BUFSIZE - UIP_LLH_LEN + 16 <= 512
+#define RX_BUFSIZE 512
+#elif UIP_BUFSIZE - UIP_LLH_LEN + 16 <= 1024
+#define RX_BUFSIZE 1024
+#else
+#define RX_BUFSIZE 2048
+#endif
 
-enum {
-  STATE_TWOPACKETS = 0,	/* We have 2 packets and drop incoming data. */
-  STATE_OK = 1,
-  STATE_ESC = 2,
-  STATE_RUBBISH = 3,
-};
+static struct ringbuf16 rxbuf;
+static uint8_t rxbuf_data[RX_BUFSIZE];
 
 /*
- * Variables begin and end manage the buffer space in a cyclic
- * fashion. The first used byte is at begin and end is one byte past
- * the last. I.e. [begin, end) is the actively used space.
- *
- * If begin != pkt_end we have a packet at [begin, pkt_end),
- * furthermore, if state == STATE_TWOPACKETS we have one more packet at
- * [pkt_end, end). If more bytes arrive in state STATE_TWOPACKETS
- * they are discarded.
+ * The number of packet ends put into rxbuf by the interrupt, and the
+ * number of packets taken from rxbuf by slip_process. Each side only
+ * writes its own counter.
  */
+static volatile uint8_t ends_in;
+static uint8_t ends_out;
+
+/* Set while the interrupt drops the rest of a packet that did not fit
+   in rxbuf. */
+static uint8_t overflow;
 
-static uint8_t state = STATE_TWOPACKETS;
-static uint16_t begin, end;
-static uint8_t rxbuf[RX_BUFSIZE];
-static uint16_t pkt_end;		/* SLIP_END tracker. */
+/* Set when a byte of the current packet has been put into rxbuf. */
+static uint8_t in_packet;
 
 static void (* input_callback)(void) = NULL;
 /*---------------------------------------------------------------------------*/
@@ -155,99 +167,108 @@ slip_write(const void *_ptr, int len)
 static void
 rxbuf_init(void)
 {
-  begin = end = pkt_end = 0;
-  state = STATE_OK;
+  ringbuf16_init(&rxbuf, rxbuf_data, sizeof(rxbuf_data));
+  ends_in = ends_out = 0;
+  overflow = in_packet = 0;
 }
 /*---------------------------------------------------------------------------*/
-/* Upper half does the polling. */
-static uint16_t
-slip_poll_handler(uint8_t *outbuf, uint16_t blen)
+/* Answer the requests that are sent without SLIP framing. Returns
+   non-zero if one was answered. */
+static int
+answer_request(void)
 {
+  uint8_t *span;
+  uint16_t len;
+  int i;
+
   /* This is a hack and won't work across buffer edge! */
-  if(rxbuf[begin] == 'C') {
-    int i;
-    if(begin < end && (end - begin) >= 6
-       && memcmp(&rxbuf[begin], "CLIENT", 6) == 0) {
-      state = STATE_TWOPACKETS;	/* Interrupts do nothing. */
-      memset(&rxbuf[begin], 0x0, 6);
-      
-      rxbuf_init();
-      
-      for(i = 0; i < 13; i++) {
-	slip_arch_writeb("CLIENTSERVER\300"[i]);
-      }
-      return 0;
+  len = ringbuf16_read_span(&rxbuf, &span);
+  if(len >= 6 && memcmp(span, "CLIENT", 6) == 0) {
+    ringbuf16_consume(&rxbuf, 6);
+    for(i = 0; i < 13; i++) {
+      slip_arch_writeb("CLIENTSERVER\300"[i]);
     }
+    return 1;
   }
-#ifdef SLIP_CONF_ANSWER_MAC_REQUEST
-  else if(rxbuf[begin] == '?') { 
-    /* Used by tapslip6 to request mac for auto configure */
-    int i, j;
-    char* hexchar = "0123456789abcdef";
-    if(begin < end && (end - begin) >= 2
-       && rxbuf[begin + 1] == 'M') {
-      state = STATE_TWOPACKETS; /* Interrupts do nothing. */
-      rxbuf[begin] = 0;
-      rxbuf[begin + 1] = 0;
-      
-      rxbuf_init();
-      
-      rimeaddr_t addr = get_mac_addr();
-      /* this is just a test so far... just to see if it works */
-      slip_arch_writeb('!');
-      slip_arch_writeb('M');
-      for(j = 0; j < 8; j++) {
-        slip_arch_writeb(hexchar[addr.u8[j] >> 4]);
-        slip_arch_writeb(hexchar[addr.u8[j] & 15]);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Decode the first packet of rxbuf into outbuf. Returns the length of
+   the packet, or 0 if it was empty, too long or corrupted. */
+static uint16_t
+slip_poll_handler(uint8_t *outbuf, uint16_t blen)
+{
+  uint8_t *span;
+  uint16_t len, n, i;
+  uint8_t c, esc, rubbish, done;
+
+  len = 0;
+  esc = rubbish = done = 0;
+  while(!done && (n = ringbuf16_read_span(&rxbuf, &span)) > 0) {
+    for(i = 0; i < n; i++) {
+      c = span[i];
+      if(c == SLIP_END) {
+        /* An escaped end marks a packet that the interrupt cut short. */
+        rubbish |= esc;
+        done = 1;
+        i++;
+        break;
       }
-      slip_arch_writeb(SLIP_END);
-      return 0;
-    }
-  }
-#endif /* SLIP_CONF_ANSWER_MAC_REQUEST */
-
-  /*
-   * Interrupt can not change begin but may change pkt_end.
-   * If pkt_end != begin it will not change again.
-   */
-  if(begin != pkt_end) {
-    uint16_t len;
-
-    if(begin < pkt_end) {
-      len = pkt_end - begin;
-      if(len > blen) {
-	len = 0;
-      } else {
-	memcpy(outbuf, &rxbuf[begin], len);
+      if(esc) {
+        esc = 0;
+        if(c == SLIP_ESC_END) {
+          c = SLIP_END;
+        } else if(c == SLIP_ESC_ESC) {
+          c = SLIP_ESC;
+        } else {
+          rubbish = 1;
+        }
+      } else if(c == SLIP_ESC) {
+        esc = 1;
+        continue;
       }
-    } else {
-      len = (RX_BUFSIZE - begin) + (pkt_end - 0);
-      if(len > blen) {
-	len = 0;
+      if(len < blen) {
+        outbuf[len++] = c;
       } else {
-	unsigned i;
-	for(i = begin; i < RX_BUFSIZE; i++) {
-	  *outbuf++ = rxbuf[i];
-	}
-	for(i = 0; i < pkt_end; i++) {
-	  *outbuf++ = rxbuf[i];
-	}
+        rubbish = 1;
       }
     }
+    ringbuf16_consume(&rxbuf, i);
+  }
 
-    /* Remove data from buffer together with the copied packet. */
-    begin = pkt_end;
-    if(state == STATE_TWOPACKETS) {
-      pkt_end = end;
-      state = STATE_OK;		/* Assume no bytes where lost! */
-      
-      /* One more packet is buffered, need to be polled again! */
-      process_poll(&slip_process);
+  if(done) {
+    ends_out++;
+  } else {
+    /* rxbuf ran out before the end of the packet. This should not
+       happen; drop what we got and count the packet ends again. */
+    rubbish = 1;
+    ends_out = ends_in;
+  }
+
+  if(rubbish) {
+    SLIP_STATISTICS(slip_rubbish++);
+    return 0;
+  }
+
+#ifdef SLIP_CONF_ANSWER_MAC_REQUEST
+  if(len == 2 && outbuf[0] == '?' && outbuf[1] == 'M') {
+    /* Used by tapslip6 to request mac for auto configure */
+    int j;
+    char* hexchar = "0123456789abcdef";
+    rimeaddr_t addr = get_mac_addr();
+    /* this is just a test so far... just to see if it works */
+    slip_arch_writeb('!');
+    slip_arch_writeb('M');
+    for(j = 0; j < 8; j++) {
+      slip_arch_writeb(hexchar[addr.u8[j] >> 4]);
+      slip_arch_writeb(hexchar[addr.u8[j] & 15]);
     }
-    return len;
+    slip_arch_writeb(SLIP_END);
+    return 0;
   }
+#endif /* SLIP_CONF_ANSWER_MAC_REQUEST */
 
-  return 0;
+  return len;
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(slip_process, ev, data)
@@ -261,9 +282,19 @@ PROCESS_THREAD(slip_process, ev, data)
     
     slip_active = 1;
 
+    if(ends_in == ends_out) {
+      /* No complete packet yet */
+      answer_request();
+      continue;
+    }
+
     /* Move packet from rxbuf to buffer provided by uIP. */
     uip_len = slip_poll_handler(&uip_buf[UIP_LLH_LEN],
 				UIP_BUFSIZE - UIP_LLH_LEN);
+    if(ends_in != ends_out) {
+      /* One more packet is buffered, need to be polled again! */
+      process_poll(&slip_process);
+    }
 #if !UIP_CONF_IPV6
     if(uip_len == 4 && strncmp((char*)&uip_buf[UIP_LLH_LEN], "?IPA", 4) == 0) {
       char buf[8];
@@ -318,74 +349,47 @@ PROCESS_THREAD(slip_process, ev, data)
 int
 slip_input_byte(unsigned char c)
 {
-  switch(state) {
-  case STATE_RUBBISH:
+  if(overflow) {
+    /* Drop the rest of the packet that did not fit */
     if(c == SLIP_END) {
-      state = STATE_OK;
+      overflow = 0;
     }
     return 0;
-    
-  case STATE_TWOPACKETS:       /* Two packets are already buffered! */
-    return 0;
+  }
 
-  case STATE_ESC:
-    if(c == SLIP_ESC_END) {
-      c = SLIP_END;
-    } else if(c == SLIP_ESC_ESC) {
-      c = SLIP_ESC;
-    } else {
-      state = STATE_RUBBISH;
-      SLIP_STATISTICS(slip_rubbish++);
-      end = pkt_end;		/* remove rubbish */
-      return 0;
-    }
-    state = STATE_OK;
-    break;
-
-  case STATE_OK:
-    if(c == SLIP_ESC) {
-      state = STATE_ESC;
-      return 0;
-    } else if(c == SLIP_END) {
-	/*
-	 * We have a new packet, possibly of zero length.
-	 *
-	 * There may already be one packet buffered.
-	 */
-      if(end != pkt_end) {	/* Non zero length. */
-	if(begin == pkt_end) {	/* None buffered. */
-	  pkt_end = end;
-	} else {
-	  state = STATE_TWOPACKETS;
-	  SLIP_STATISTICS(slip_twopackets++);
-	}
-	process_poll(&slip_process);
-	return 1;
+  if(c == SLIP_END) {
+    /* Empty packets are not stored. */
+    if(in_packet) {
+      in_packet = 0;
+      if(ringbuf16_put(&rxbuf, c)) {
+        ends_in++;
       }
-      return 0;
     }
-    break;
+    process_poll(&slip_process);
+    return 1;
   }
 
-  /* add_char: */
-  {
-    unsigned next;
-    next = end + 1;
-    if(next == RX_BUFSIZE) {
-      next = 0;
-    }
-    if(next == begin) {		/* rxbuf is full */
-      state = STATE_RUBBISH;
-      SLIP_STATISTICS(slip_overflow++);
-      end = pkt_end;		/* remove rubbish */
-      return 0;
+  /* Two bytes are kept free, so that a packet that does not fit can
+     always be ended. */
+  if(ringbuf16_space(&rxbuf) < 3) {
+    overflow = 1;
+    SLIP_STATISTICS(slip_overflow++);
+    if(in_packet) {
+      /* End the packet with an escaped end, which marks it as rubbish
+         for slip_process. */
+      in_packet = 0;
+      if(ringbuf16_put(&rxbuf, SLIP_ESC) && ringbuf16_put(&rxbuf, SLIP_END)) {
+        ends_in++;
+      }
+      process_poll(&slip_process);
     }
-    rxbuf[end] = c;
-    end = next;
+    return 0;
   }
+  ringbuf16_put(&rxbuf, c);
+  in_packet = 1;
 
   /* There could be a separate poll routine for this. */
-  if(c == 'T' && rxbuf[begin] == 'C') {
+  if(c == 'T') {
     process_poll(&slip_process);
     return 1;
   }
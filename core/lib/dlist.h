@@ -0,0 +1,144 @@
+/** \addtogroup lib
+    @{ */
+/**
+ * \defgroup dlist Doubly linked list library
+ *
+ * The doubly linked list library provides lists that keep pointers
+ * to both their first and last element, and elements that point to
+ * both their successor and predecessor. Adding an element at either
+ * end of the list and removing any element are constant-time
+ * operations, which makes these lists suitable for FIFO queues.
+ *
+ * A doubly linked list is made up of elements where the first two
+ * elements \b must be pointers: the first is the pointer to the next
+ * element, and the second is the pointer to the previous element. As
+ * the first element is the next pointer, a doubly linked list can be
+ * traversed by code written for the \ref list "linked list library",
+ * e.g. with list_item_next().
+ *
+ * Lists are declared with the DLIST() macro, and used in the same way
+ * as lists declared with LIST(), with the dlist_ prefix instead of
+ * the list_ prefix. Unlike list_add() and list_push(), dlist_add()
+ * and dlist_push() do not check if the element already is on the
+ * list: an element must be removed before it is added again.
+ *
+ * @{
+ */
+
+/**
+ * \file
+ * Doubly linked list manipulation routines.
+ *
+ */
+
+/*
+ * Copyright (c) 2026, The Contiki-PLB contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+#ifndef __DLIST_H__
+#define __DLIST_H__
+
+#include "lib/list.h"
+
+/**
+ * The doubly linked list type.
+ *
+ */
+struct dlist {
+  void *head;
+  void *tail;
+};
+typedef struct dlist * dlist_t;
+
+/**
+ * Declare a doubly linked list.
+ *
+ * This macro declares a doubly linked list. The elements \b must be
+ * structures (\c struct) with their first element being a pointer to
+ * the next element and their second element being a pointer to the
+ * previous element.
+ *
+ * The list variable is declared as static to make it easy to use in a
+ * single C module without unnecessarily exporting the name to other
+ * modules.
+ *
+ * \param name The name of the list.
+ */
+#define DLIST(name) \
+         static struct dlist LIST_CONCAT(name,_dlist) = { NULL, NULL }; \
+         static dlist_t name = &LIST_CONCAT(name,_dlist)
+
+/**
+ * Declare a doubly linked list inside a structure declaraction.
+ *
+ * The list is initialized with the DLIST_STRUCT_INIT() macro.
+ *
+ * \param name The name of the list.
+ */
+#define DLIST_STRUCT(name) \
+         struct dlist LIST_CONCAT(name,_dlist); \
+         dlist_t name
+
+/**
+ * Initialize a doubly linked list that is part of a structure.
+ *
+ * This macro must be called before using the list.
+ *
+ * \param struct_ptr A pointer to the struct
+ * \param name The name of the list.
+ */
+#define DLIST_STRUCT_INIT(struct_ptr, name)                             \
+    do {                                                                \
+       (struct_ptr)->name = &((struct_ptr)->LIST_CONCAT(name,_dlist));  \
+       dlist_init((struct_ptr)->name);                                  \
+    } while(0)
+
+void   dlist_init(dlist_t list);
+void * dlist_head(dlist_t list);
+void * dlist_tail(dlist_t list);
+void * dlist_pop (dlist_t list);
+void   dlist_push(dlist_t list, void *item);
+
+void * dlist_chop(dlist_t list);
+
+void   dlist_add(dlist_t list, void *item);
+void   dlist_remove(dlist_t list, void *item);
+
+int    dlist_length(dlist_t list);
+
+void   dlist_insert(dlist_t list, void *previtem, void *newitem);
+
+void * dlist_item_next(void *item);
+void * dlist_item_prev(void *item);
+
+#endif /* __DLIST_H__ */
+
+/** @} */
+/** @} */
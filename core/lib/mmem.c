@@ -57,8 +57,22 @@
 
 LIST(mmemlist);
 unsigned int avail_memory;
+static unsigned int hole_memory;
+static unsigned int compactions;
 static char memory[MMEM_SIZE];
 
+/*
+ * The allocated blocks are kept in mmemlist in address order. Freeing
+ * a block does not move any memory: it only leaves a hole between its
+ * neighbours. avail_memory counts all free bytes, hole_memory the
+ * ones that are in holes. The rest is the free tail after the last
+ * block, from which new blocks are normally allocated. The memory is
+ * compacted only when neither the tail nor any hole can hold a new
+ * block, or when mmem_compact() is called explicitly.
+ */
+#define TAIL_MEMORY() (avail_memory - hole_memory)
+#define TAIL_PTR()    (&memory[MMEM_SIZE - TAIL_MEMORY()])
+
 /*---------------------------------------------------------------------------*/
 /**
  * \brief      Allocate a managed memory block
@@ -78,22 +92,68 @@ static char memory[MMEM_SIZE];
  *             macro MMEM_PTR() is used to get a pointer to the
  *             allocated memory.
  *
+ *             \note If neither the free tail nor a hole can hold
+ *             the block, this function compacts the memory, which
+ *             moves the other allocated blocks. Pointers obtained
+ *             with MMEM_PTR() before the call must be obtained
+ *             again after it.
+ *
  */
 int
 mmem_alloc(struct mmem *m, unsigned int size)
 {
+  struct mmem *n, *prev, *best_prev;
+  char *cursor, *best;
+  unsigned int gap, best_gap;
+
   /* Check if we have enough memory left for this allocation. */
   if(avail_memory < size) {
     return 0;
   }
 
+  if(TAIL_MEMORY() < size) {
+    /* The free tail is too small: look for the smallest hole that
+       fits the block, so that large holes are kept for large
+       blocks. */
+    best = NULL;
+    best_prev = NULL;
+    best_gap = 0;
+    prev = NULL;
+    cursor = memory;
+    if(hole_memory >= size) {
+      for(n = list_head(mmemlist); n != NULL; n = n->next) {
+        gap = (char *)n->ptr - cursor;
+        if(gap >= size && (best == NULL || gap < best_gap)) {
+          best = cursor;
+          best_prev = prev;
+          best_gap = gap;
+        }
+        cursor = (char *)n->ptr + n->size;
+        prev = n;
+      }
+    }
+
+    if(best != NULL) {
+      list_insert(mmemlist, best_prev, m);
+      m->ptr = best;
+      m->size = size;
+      hole_memory -= size;
+      avail_memory -= size;
+      return 1;
+    }
+
+    /* No hole is large enough: compact the memory so that all free
+       memory ends up in the tail. */
+    mmem_compact();
+  }
+
   /* We had enough memory so we add this memory block to the end of
      the list of allocated memory blocks. */
   list_add(mmemlist, m);
 
   /* Set up the pointer so that it points to the first available byte
      in the memory block. */
-  m->ptr = &memory[MMEM_SIZE - avail_memory];
+  m->ptr = TAIL_PTR();
 
   /* Remember the size of this memory block. */
   m->size = size;
@@ -112,31 +172,97 @@ mmem_alloc(struct mmem *m, unsigned int size)
  * \author     Adam Dunkels
  *
  *             This function deallocates a managed memory block that
- *             previously has been allocated with mmem_alloc().
+ *             previously has been allocated with mmem_alloc(). The
+ *             memory of the block is not reused until a later
+ *             allocation needs it, so freeing a block is cheap.
  *
  */
 void
 mmem_free(struct mmem *m)
+{
+  struct mmem *last;
+  int was_last;
+
+  was_last = (m->next == NULL);
+
+  /* Remove the memory block from the list. */
+  list_remove(mmemlist, m);
+
+  avail_memory += m->size;
+
+  if(was_last) {
+    /* The block was at the end of the allocated memory: it and the
+       hole in front of it, if any, become part of the free tail. */
+    last = list_tail(mmemlist);
+    if(last == NULL) {
+      hole_memory = 0;
+    } else {
+      hole_memory = avail_memory -
+        (&memory[MMEM_SIZE] - ((char *)last->ptr + last->size));
+    }
+  } else {
+    hole_memory += m->size;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Compact the managed memory
+ *
+ *             This function moves all allocated blocks downwards so
+ *             that all free memory becomes one contiguous block. It
+ *             is called by mmem_alloc() when needed, but may also be
+ *             called when the system is idle to make later
+ *             allocations faster. Pointers obtained with MMEM_PTR()
+ *             are invalid after this function has been called.
+ *
+ */
+void
+mmem_compact(void)
 {
   struct mmem *n;
+  char *cursor;
 
-  if(m->next != NULL) {
-    /* Compact the memory after the allocation that is to be removed
-       by moving it downwards. */
-    memmove(m->ptr, m->next->ptr,
-	    &memory[MMEM_SIZE - avail_memory] - (char *)m->next->ptr);
-    
-    /* Update all the memory pointers that points to memory that is
-       after the allocation that is to be removed. */
-    for(n = m->next; n != NULL; n = n->next) {
-      n->ptr = (void *)((char *)n->ptr - m->size);
+  if(hole_memory == 0) {
+    return;
+  }
+
+  cursor = memory;
+  for(n = list_head(mmemlist); n != NULL; n = n->next) {
+    if(n->ptr != cursor) {
+      memmove(cursor, n->ptr, n->size);
+      n->ptr = cursor;
     }
+    cursor += n->size;
   }
+  hole_memory = 0;
+  ++compactions;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get statistics about the managed memory
+ * \param stats A pointer to a struct mmem_stats that is filled in
+ *
+ */
+void
+mmem_stats(struct mmem_stats *stats)
+{
+  struct mmem *n;
+  char *cursor;
+  unsigned int gap;
 
-  avail_memory += m->size;
+  stats->live_bytes = MMEM_SIZE - avail_memory;
+  stats->free_bytes = avail_memory;
+  stats->largest_free = TAIL_MEMORY();
+  stats->compactions = compactions;
 
-  /* Remove the memory block from the list. */
-  list_remove(mmemlist, m);
+  cursor = memory;
+  for(n = list_head(mmemlist); n != NULL; n = n->next) {
+    gap = (char *)n->ptr - cursor;
+    if(gap > stats->largest_free) {
+      stats->largest_free = gap;
+    }
+    cursor = (char *)n->ptr + n->size;
+  }
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -153,6 +279,8 @@ mmem_init(void)
 {
   list_init(mmemlist);
   avail_memory = MMEM_SIZE;
+  hole_memory = 0;
+  compactions = 0;
 }
 /*---------------------------------------------------------------------------*/
 
@@ -39,7 +39,9 @@
  *
  * The managed memory allocator is a fragmentation-free memory
  * manager. It keeps the allocated memory free from fragmentation by
- * compacting the memory when blocks are freed. A program that uses
+ * compacting the memory when an allocation would otherwise fail.
+ * Freed blocks leave holes that are reused by later allocations of
+ * a fitting size, so freeing a block is cheap. A program that uses
  * the managed memory module cannot be sure that allocated memory
  * stays in place. Therefore, a level of indirection is used: access
  * to allocated memory must always be done using a special macro.
@@ -83,8 +85,23 @@ struct mmem {
 /* XXX: tagga minne med "interrupt usage", vilke gr att man r
    speciellt varsam under free(). */
 
+/**
+ * \brief      Statistics about the managed memory
+ */
+struct mmem_stats {
+  unsigned int live_bytes;   /**< Bytes in allocated blocks. */
+  unsigned int free_bytes;   /**< Free bytes, including holes. */
+  unsigned int largest_free; /**< Largest contiguous free run. */
+  unsigned int compactions;  /**< Number of compactions done. */
+};
+
+/* mmem_alloc() may compact the memory, which moves the allocated
+   blocks: a pointer obtained with MMEM_PTR() is only valid until the
+   next mmem_alloc() or mmem_compact() call. */
 int  mmem_alloc(struct mmem *m, unsigned int size);
 void mmem_free(struct mmem *);
+void mmem_compact(void);
+void mmem_stats(struct mmem_stats *stats);
 void mmem_init(void);
 
 #endif /* __MMEM_H__ */
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2026, The Contiki-PLB contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Bulk ring buffer library implementation
+ */
+
+#include <string.h>
+
+#include "lib/ringbuf16.h"
+#include "sys/cc.h"
+
+/* The indices are shared between the producer and the consumer, which
+   may run in an interrupt. On CPUs that load and store 16 bits in two
+   instructions, they are accessed with the interrupts masked so that
+   neither side sees half of an update. */
+#if defined(RINGBUF16_CONF_INDEX_LOCK)
+#define INDEX_LOCK()   RINGBUF16_CONF_INDEX_LOCK()
+#define INDEX_UNLOCK() RINGBUF16_CONF_INDEX_UNLOCK()
+#elif defined(__AVR__)
+#include <avr/interrupt.h>
+#define INDEX_LOCK()   uint8_t sreg = SREG; cli()
+#define INDEX_UNLOCK() SREG = sreg
+#endif
+/*---------------------------------------------------------------------------*/
+#ifdef INDEX_LOCK
+static uint16_t
+load_index(volatile uint16_t *index)
+{
+  uint16_t value;
+  INDEX_LOCK();
+  value = *index;
+  INDEX_UNLOCK();
+  return value;
+}
+/*---------------------------------------------------------------------------*/
+static void
+store_index(volatile uint16_t *index, uint16_t value)
+{
+  INDEX_LOCK();
+  /* The data must be in place before the new index is published. */
+  CC_BARRIER();
+  *index = value;
+  INDEX_UNLOCK();
+}
+#else /* INDEX_LOCK */
+#define load_index(index) (*(index))
+#define store_index(index, value) do {	\
+    CC_BARRIER();				\
+    *(index) = (value);				\
+  } while(0)
+#endif /* INDEX_LOCK */
+/*---------------------------------------------------------------------------*/
+void
+ringbuf16_init(struct ringbuf16 *r, uint8_t *dataptr, uint16_t size)
+{
+  r->data = dataptr;
+  r->mask = size - 1;
+  r->put_ptr = 0;
+  r->get_ptr = 0;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+ringbuf16_size(struct ringbuf16 *r)
+{
+  return r->mask + 1;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+ringbuf16_elements(struct ringbuf16 *r)
+{
+  /* The indices are free-running, so their difference is the number
+     of elements even after they have wrapped around. */
+  return (uint16_t)(load_index(&r->put_ptr) - load_index(&r->get_ptr));
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+ringbuf16_space(struct ringbuf16 *r)
+{
+  return ringbuf16_size(r) - ringbuf16_elements(r);
+}
+/*---------------------------------------------------------------------------*/
+int
+ringbuf16_put(struct ringbuf16 *r, uint8_t c)
+{
+  uint16_t put_ptr = load_index(&r->put_ptr);
+
+  if((uint16_t)(put_ptr - load_index(&r->get_ptr)) > r->mask) {
+    return 0;
+  }
+  r->data[put_ptr & r->mask] = c;
+  /* Update the pointer only after the data is in place, so that the
+     consumer never sees a byte that has not been written yet. */
+  store_index(&r->put_ptr, put_ptr + 1);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+ringbuf16_get(struct ringbuf16 *r)
+{
+  uint16_t get_ptr = load_index(&r->get_ptr);
+  uint8_t c;
+
+  if(load_index(&r->put_ptr) == get_ptr) {
+    return -1;
+  }
+  c = r->data[get_ptr & r->mask];
+  store_index(&r->get_ptr, get_ptr + 1);
+  return c;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+ringbuf16_write_span(struct ringbuf16 *r, uint8_t **ptr)
+{
+  uint16_t offset, space, contiguous;
+
+  offset = load_index(&r->put_ptr) & r->mask;
+  space = ringbuf16_space(r);
+  contiguous = ringbuf16_size(r) - offset;
+  *ptr = &r->data[offset];
+  return space < contiguous ? space : contiguous;
+}
+/*---------------------------------------------------------------------------*/
+void
+ringbuf16_commit(struct ringbuf16 *r, uint16_t len)
+{
+  store_index(&r->put_ptr, load_index(&r->put_ptr) + len);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+ringbuf16_read_span(struct ringbuf16 *r, uint8_t **ptr)
+{
+  uint16_t offset, elements, contiguous;
+
+  offset = load_index(&r->get_ptr) & r->mask;
+  elements = ringbuf16_elements(r);
+  contiguous = ringbuf16_size(r) - offset;
+  *ptr = &r->data[offset];
+  return elements < contiguous ? elements : contiguous;
+}
+/*---------------------------------------------------------------------------*/
+void
+ringbuf16_consume(struct ringbuf16 *r, uint16_t len)
+{
+  store_index(&r->get_ptr, load_index(&r->get_ptr) + len);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+ringbuf16_write(struct ringbuf16 *r, const uint8_t *src, uint16_t len)
+{
+  uint16_t written, n;
+  uint8_t *ptr;
+
+  /* The free space is at most two spans: up to the end of the array,
+     and from its beginning. */
+  for(written = 0; written < len; written += n) {
+    n = ringbuf16_write_span(r, &ptr);
+    if(n == 0) {
+      break;
+    }
+    if(n > len - written) {
+      n = len - written;
+    }
+    memcpy(ptr, src + written, n);
+    ringbuf16_commit(r, n);
+  }
+  return written;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+ringbuf16_read(struct ringbuf16 *r, uint8_t *dst, uint16_t len)
+{
+  uint16_t read, n;
+  uint8_t *ptr;
+
+  for(read = 0; read < len; read += n) {
+    n = ringbuf16_read_span(r, &ptr);
+    if(n == 0) {
+      break;
+    }
+    if(n > len - read) {
+      n = len - read;
+    }
+    memcpy(dst + read, ptr, n);
+    ringbuf16_consume(r, n);
+  }
+  return read;
+}
+/*---------------------------------------------------------------------------*/
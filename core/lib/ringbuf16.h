@@ -0,0 +1,204 @@
+/** \addtogroup lib
+ * @{ */
+
+/**
+ * \defgroup ringbuf16 Bulk ring buffer library
+ * @{
+ *
+ * The bulk ring buffer library implements a ring (circular) buffer
+ * with 16-bit sizes, for buffers larger than the 128 bytes supported
+ * by the \ref ringbuf "ring buffer library". Besides single bytes,
+ * data can be written and read in blocks, or directly in place
+ * through contiguous spans of the buffer.
+ *
+ * A bulk ring buffer is safe to use with one producer and one
+ * consumer running concurrently, e.g. an interrupt handler that
+ * writes and a process that reads: the producer only modifies the
+ * put pointer and the consumer only modifies the get pointer. The
+ * pointers are 16-bit quantities, so this requires a platform where
+ * 16-bit loads and stores are atomic (e.g., the MSP430 and ARM).
+ *
+ */
+/*
+ * Copyright (c) 2026, The Contiki-PLB contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Header file for the bulk ring buffer library
+ */
+
+#ifndef __RINGBUF16_H__
+#define __RINGBUF16_H__
+
+#include "contiki-conf.h"
+
+/**
+ * \brief      Structure that holds the state of a bulk ring buffer.
+ *
+ *             This structure holds the state of a bulk ring
+ *             buffer. The actual buffer needs to be defined
+ *             separately. This struct is an opaque structure with no
+ *             user-visible elements.
+ *
+ */
+struct ringbuf16 {
+  uint8_t *data;
+  uint16_t mask;
+
+  /* Free-running indices, masked on access. Only the producer writes
+     put_ptr and only the consumer writes get_ptr. On CPUs that cannot
+     access them atomically, they are accessed with the interrupts
+     masked: by default on AVR, elsewhere by defining
+     RINGBUF16_CONF_INDEX_LOCK() and RINGBUF16_CONF_INDEX_UNLOCK(). */
+  volatile uint16_t put_ptr, get_ptr;
+};
+
+/**
+ * \brief      Initialize a bulk ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param a    A pointer to an array to hold the data in the buffer
+ * \param size_power_of_two The size of the ring buffer, which must be a power of two
+ *
+ *             This function initiates a bulk ring buffer. The data in
+ *             the buffer is stored in an external array, to which a
+ *             pointer must be supplied. The size of the ring buffer
+ *             must be a power of two and cannot be larger than 32768
+ *             bytes.
+ *
+ */
+void     ringbuf16_init(struct ringbuf16 *r, uint8_t *a,
+                        uint16_t size_power_of_two);
+
+/**
+ * \brief      Insert a byte into the ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param c    The byte to be written to the buffer
+ * \return     Non-zero if there data could be written, or zero if the buffer was full.
+ */
+int      ringbuf16_put(struct ringbuf16 *r, uint8_t c);
+
+/**
+ * \brief      Get a byte from the ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \return     The data from the buffer, or -1 if the buffer was empty
+ */
+int      ringbuf16_get(struct ringbuf16 *r);
+
+/**
+ * \brief      Write a block of data into the ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param src  A pointer to the data to be written
+ * \param len  The number of bytes to write
+ * \return     The number of bytes that were written
+ *
+ *             This function copies as much of the data as there is
+ *             room for into the ring buffer, using at most two
+ *             memcpy() calls.
+ *
+ */
+uint16_t ringbuf16_write(struct ringbuf16 *r, const uint8_t *src, uint16_t len);
+
+/**
+ * \brief      Read a block of data from the ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param dst  A pointer to the buffer that receives the data
+ * \param len  The maximum number of bytes to read
+ * \return     The number of bytes that were read
+ */
+uint16_t ringbuf16_read(struct ringbuf16 *r, uint8_t *dst, uint16_t len);
+
+/**
+ * \brief      Get the contiguous span of data at the head of the ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param ptr  A pointer that is set to the first byte of the span
+ * \return     The number of bytes in the span
+ *
+ *             This function lets the consumer process data in place,
+ *             without copying it out of the ring buffer. The span
+ *             ends at the end of the buffered data or at the end of
+ *             the underlying array, whichever comes first. The data
+ *             stays in the buffer until ringbuf16_consume() is called.
+ *
+ */
+uint16_t ringbuf16_read_span(struct ringbuf16 *r, uint8_t **ptr);
+
+/**
+ * \brief      Remove data from the head of the ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param len  The number of bytes to remove, at most ringbuf16_elements()
+ */
+void     ringbuf16_consume(struct ringbuf16 *r, uint16_t len);
+
+/**
+ * \brief      Get the contiguous span of free space at the tail of the ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param ptr  A pointer that is set to the first free byte of the span
+ * \return     The number of bytes in the span
+ *
+ *             This function lets the producer write data in place
+ *             (e.g., from a DMA transfer). The data becomes visible
+ *             to the consumer when ringbuf16_commit() is called.
+ *
+ */
+uint16_t ringbuf16_write_span(struct ringbuf16 *r, uint8_t **ptr);
+
+/**
+ * \brief      Add data written in place to the tail of the ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param len  The number of bytes to add, at most the length of the write span
+ */
+void     ringbuf16_commit(struct ringbuf16 *r, uint16_t len);
+
+/**
+ * \brief      Get the size of a ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \return     The size of the buffer.
+ */
+uint16_t ringbuf16_size(struct ringbuf16 *r);
+
+/**
+ * \brief      Get the number of elements currently in the ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \return     The number of elements in the buffer.
+ */
+uint16_t ringbuf16_elements(struct ringbuf16 *r);
+
+/**
+ * \brief      Get the amount of free space in the ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \return     The number of bytes that can be written to the buffer.
+ */
+uint16_t ringbuf16_space(struct ringbuf16 *r);
+
+#endif /* __RINGBUF16_H__ */
+
+/** @} */
+/** @} */
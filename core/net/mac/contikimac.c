@@ -89,20 +89,56 @@
 #define WITH_PHASE_OPTIMIZATION 0
 #endif
 
+/* Let each node pick its own channel check rate at run-time with
+   contikimac_set_channel_check_rate(). The rate is advertised in the
+   ContikiMAC header of every packet and kept by the phase module, so
+   that the senders strobe for the cycle time of the receiver. */
+#ifdef CONTIKIMAC_CONF_WITH_ASYMMETRIC_RATES
+#define WITH_ASYMMETRIC_RATES        CONTIKIMAC_CONF_WITH_ASYMMETRIC_RATES
+#else
+#define WITH_ASYMMETRIC_RATES        0
+#endif
+
+#if WITH_ASYMMETRIC_RATES
+#if !WITH_CONTIKIMAC_HEADER
+#error CONTIKIMAC_CONF_WITH_ASYMMETRIC_RATES requires the ContikiMAC header
+#endif
+/* The lowest rate that a neighbor may use. Broadcasts, and unicasts
+   to the neighbors whose rate is unknown, are strobed for its cycle
+   time. */
+#ifdef CONTIKIMAC_CONF_MIN_CHANNEL_CHECK_RATE
+#define MIN_CHANNEL_CHECK_RATE       CONTIKIMAC_CONF_MIN_CHANNEL_CHECK_RATE
+#else
+#define MIN_CHANNEL_CHECK_RATE       NETSTACK_RDC_CHANNEL_CHECK_RATE
+#endif
+#ifdef CONTIKIMAC_CONF_MAX_CHANNEL_CHECK_RATE
+#define MAX_CHANNEL_CHECK_RATE       CONTIKIMAC_CONF_MAX_CHANNEL_CHECK_RATE
+#else
+#define MAX_CHANNEL_CHECK_RATE       64
+#endif
+#endif /* WITH_ASYMMETRIC_RATES */
+
 #if WITH_CONTIKIMAC_HEADER
 #define CONTIKIMAC_ID 0x00
 
 struct hdr {
   uint8_t id;
   uint8_t len;
+#if WITH_ASYMMETRIC_RATES
+  /* The base 2 logarithm of the channel check rate of the sender. */
+  uint8_t rate;
+#endif /* WITH_ASYMMETRIC_RATES */
 };
 #endif /* WITH_CONTIKIMAC_HEADER */
 
-/* CYCLE_TIME for channel cca checks, in rtimer ticks. */
+/* CYCLE_TIME for channel cca checks, in rtimer ticks, and the
+   CHANNEL_CHECK_RATE that it gives. */
 #ifdef CONTIKIMAC_CONF_CYCLE_TIME
 #define CYCLE_TIME (CONTIKIMAC_CONF_CYCLE_TIME)
+#define CHANNEL_CHECK_RATE (RTIMER_ARCH_SECOND / CYCLE_TIME)
 #else
 #define CYCLE_TIME (RTIMER_ARCH_SECOND / NETSTACK_RDC_CHANNEL_CHECK_RATE)
+#define CHANNEL_CHECK_RATE NETSTACK_RDC_CHANNEL_CHECK_RATE
 #endif
 
 /* CHANNEL_CHECK_RATE is enforced to be a power of two.
@@ -116,6 +152,17 @@ struct hdr {
 #define SYNC_CYCLE_STARTS                    1
 #endif
 
+#if WITH_ASYMMETRIC_RATES
+static rtimer_clock_t own_cycle_time = CYCLE_TIME;
+static uint8_t own_channel_check_rate = CHANNEL_CHECK_RATE;
+#define OWN_CYCLE_TIME                       own_cycle_time
+#define OWN_CHANNEL_CHECK_RATE               own_channel_check_rate
+#define MAX_CYCLE_TIME                       (RTIMER_ARCH_SECOND / MIN_CHANNEL_CHECK_RATE)
+#else /* WITH_ASYMMETRIC_RATES */
+#define OWN_CYCLE_TIME                       CYCLE_TIME
+#define OWN_CHANNEL_CHECK_RATE               NETSTACK_RDC_CHANNEL_CHECK_RATE
+#endif /* WITH_ASYMMETRIC_RATES */
+
 /* Are we currently receiving a burst? */
 static int we_are_receiving_burst = 0;
 
@@ -182,10 +229,6 @@ static int we_are_receiving_burst = 0;
 
 
 
-/* STROBE_TIME is the maximum amount of time a transmitted packet
-   should be repeatedly transmitted as part of a transmission. */
-#define STROBE_TIME                        (CYCLE_TIME + 2 * CHECK_TIME)
-
 /* GUARD_TIME is the time before the expected phase of a neighbor that
    a transmitted should begin transmitting packets. */
 #define GUARD_TIME                         10 * CHECK_TIME + CHECK_TIME_TX
@@ -251,11 +294,11 @@ static volatile unsigned char radio_is_on = 0;
 static struct compower_activity current_packet;
 #endif /* CONTIKIMAC_CONF_COMPOWER */
 
-#if WITH_PHASE_OPTIMIZATION
+#if WITH_PHASE_OPTIMIZATION || WITH_ASYMMETRIC_RATES
 
 #include "net/mac/phase.h"
 
-#endif /* WITH_PHASE_OPTIMIZATION */
+#endif /* WITH_PHASE_OPTIMIZATION || WITH_ASYMMETRIC_RATES */
 
 #define DEFAULT_STREAM_TIME (4 * CYCLE_TIME)
 
@@ -389,19 +432,19 @@ powercycle(struct rtimer *t, void *ptr)
 #if SYNC_CYCLE_STARTS
     /* Compute cycle start when RTIMER_ARCH_SECOND is not a multiple
        of CHANNEL_CHECK_RATE */
-    if(sync_cycle_phase++ == NETSTACK_RDC_CHANNEL_CHECK_RATE) {
+    if(sync_cycle_phase++ >= OWN_CHANNEL_CHECK_RATE) {
       sync_cycle_phase = 0;
       sync_cycle_start += RTIMER_ARCH_SECOND;
       cycle_start = sync_cycle_start;
     } else {
-#if (RTIMER_ARCH_SECOND * NETSTACK_RDC_CHANNEL_CHECK_RATE) > 65535
-      cycle_start = sync_cycle_start + ((unsigned long)(sync_cycle_phase*RTIMER_ARCH_SECOND))/NETSTACK_RDC_CHANNEL_CHECK_RATE;
+#if (RTIMER_ARCH_SECOND * NETSTACK_RDC_CHANNEL_CHECK_RATE) > 65535 || WITH_ASYMMETRIC_RATES
+      cycle_start = sync_cycle_start + ((unsigned long)(sync_cycle_phase*RTIMER_ARCH_SECOND))/OWN_CHANNEL_CHECK_RATE;
 #else
       cycle_start = sync_cycle_start + (sync_cycle_phase*RTIMER_ARCH_SECOND)/NETSTACK_RDC_CHANNEL_CHECK_RATE;
 #endif
     }
 #else
-    cycle_start += CYCLE_TIME;
+    cycle_start += OWN_CYCLE_TIME;
 #endif
 
     packet_seen = 0;
@@ -485,7 +528,7 @@ powercycle(struct rtimer *t, void *ptr)
       }
     }
 
-    if(RTIMER_CLOCK_LT(RTIMER_NOW() - cycle_start, CYCLE_TIME - CHECK_TIME * 4)) {
+    if(RTIMER_CLOCK_LT(RTIMER_NOW() - cycle_start, OWN_CYCLE_TIME - CHECK_TIME * 4)) {
       /* Schedule the next powercycle interrupt, or sleep the mcu
 	 until then.  Sleeping will not exit from this interrupt, so
 	 ensure an occasional wake cycle or foreground processing will
@@ -493,14 +536,14 @@ powercycle(struct rtimer *t, void *ptr)
 #if RDC_CONF_MCU_SLEEP
       static uint8_t sleepcycle;
       if((sleepcycle++ < 16) && !we_are_sending && !radio_is_on) {
-        rtimer_arch_sleep(CYCLE_TIME - (RTIMER_NOW() - cycle_start));
+        rtimer_arch_sleep(OWN_CYCLE_TIME - (RTIMER_NOW() - cycle_start));
       } else {
         sleepcycle = 0;
-        schedule_powercycle_fixed(t, CYCLE_TIME + cycle_start);
+        schedule_powercycle_fixed(t, OWN_CYCLE_TIME + cycle_start);
         PT_YIELD(&pt);
       }
 #else
-      schedule_powercycle_fixed(t, CYCLE_TIME + cycle_start);
+      schedule_powercycle_fixed(t, OWN_CYCLE_TIME + cycle_start);
       PT_YIELD(&pt);
 #endif
     }
@@ -548,6 +591,7 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   int ret;
   uint8_t contikimac_was_on;
   uint8_t seqno;
+  rtimer_clock_t cycle_time;
 #if WITH_CONTIKIMAC_HEADER
   struct hdr *chdr;
 #endif /* WITH_CONTIKIMAC_HEADER */
@@ -594,6 +638,18 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   is_reliable = packetbuf_attr(PACKETBUF_ATTR_RELIABLE) ||
     packetbuf_attr(PACKETBUF_ATTR_ERELIABLE);
 
+  /* The cycle time of the receiver, which the strobes must cover. */
+#if WITH_ASYMMETRIC_RATES
+  if(is_broadcast) {
+    cycle_time = MAX_CYCLE_TIME;
+  } else {
+    cycle_time = phase_cycle_time(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                                  MAX_CYCLE_TIME);
+  }
+#else /* WITH_ASYMMETRIC_RATES */
+  cycle_time = CYCLE_TIME;
+#endif /* WITH_ASYMMETRIC_RATES */
+
   packetbuf_set_attr(PACKETBUF_ATTR_MAC_ACK, 1);
 
 #if WITH_CONTIKIMAC_HEADER
@@ -606,6 +662,11 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   chdr = packetbuf_hdrptr();
   chdr->id = CONTIKIMAC_ID;
   chdr->len = hdrlen;
+#if WITH_ASYMMETRIC_RATES
+  /* Round the rate down, so that receivers never strobe for less than
+     our cycle time. */
+  for(chdr->rate = 0; (2 << chdr->rate) <= OWN_CHANNEL_CHECK_RATE; chdr->rate++);
+#endif /* WITH_ASYMMETRIC_RATES */
   
   /* Create the MAC header for the data packet. */
   hdrlen = NETSTACK_FRAMER.create();
@@ -656,7 +717,7 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   if(!is_broadcast && !is_receiver_awake) {
 #if WITH_PHASE_OPTIMIZATION
     ret = phase_wait(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
-                     CYCLE_TIME, GUARD_TIME,
+                     cycle_time, GUARD_TIME,
                      mac_callback, mac_callback_ptr, buf_list);
     if(ret == PHASE_DEFERRED) {
       return MAC_TX_DEFERRED;
@@ -748,7 +809,8 @@ send_packet(mac_callback_t mac_callback, void *mac_callback_ptr,
   seqno = packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO);
   for(strobes = 0, collisions = 0;
       got_strobe_ack == 0 && collisions == 0 &&
-      RTIMER_CLOCK_LT(RTIMER_NOW(), t0 + STROBE_TIME); strobes++) {
+      RTIMER_CLOCK_LT(RTIMER_NOW(), t0 + cycle_time + 2 * CHECK_TIME);
+      strobes++) {
 
     watchdog_periodic();
 
@@ -960,6 +1022,12 @@ input_packet(void)
     }
     packetbuf_hdrreduce(sizeof(struct hdr));
     packetbuf_set_datalen(chdr->len);
+#if WITH_ASYMMETRIC_RATES
+    if(chdr->rate < 16) {
+      phase_set_cycle_time(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                           RTIMER_ARCH_SECOND >> chdr->rate);
+    }
+#endif /* WITH_ASYMMETRIC_RATES */
 #endif /* WITH_CONTIKIMAC_HEADER */
 
     if(packetbuf_datalen() > 0 &&
@@ -1036,14 +1104,14 @@ init(void)
   radio_is_on = 0;
   PT_INIT(&pt);
 
-  rtimer_set(&rt, RTIMER_NOW() + CYCLE_TIME, 1,
+  rtimer_set(&rt, RTIMER_NOW() + OWN_CYCLE_TIME, 1,
              (void (*)(struct rtimer *, void *))powercycle, NULL);
 
   contikimac_is_on = 1;
 
-#if WITH_PHASE_OPTIMIZATION
+#if WITH_PHASE_OPTIMIZATION || WITH_ASYMMETRIC_RATES
   phase_init();
-#endif /* WITH_PHASE_OPTIMIZATION */
+#endif /* WITH_PHASE_OPTIMIZATION || WITH_ASYMMETRIC_RATES */
 
 }
 /*---------------------------------------------------------------------------*/
@@ -1053,7 +1121,7 @@ turn_on(void)
   if(contikimac_is_on == 0) {
     contikimac_is_on = 1;
     contikimac_keep_radio_on = 0;
-    rtimer_set(&rt, RTIMER_NOW() + CYCLE_TIME, 1,
+    rtimer_set(&rt, RTIMER_NOW() + OWN_CYCLE_TIME, 1,
                (void (*)(struct rtimer *, void *))powercycle, NULL);
   }
   return 1;
@@ -1076,8 +1144,29 @@ turn_off(int keep_radio_on)
 static unsigned short
 duty_cycle(void)
 {
-  return (1ul * CLOCK_SECOND * CYCLE_TIME) / RTIMER_ARCH_SECOND;
+  return (1ul * CLOCK_SECOND * OWN_CYCLE_TIME) / RTIMER_ARCH_SECOND;
+}
+/*---------------------------------------------------------------------------*/
+#if WITH_ASYMMETRIC_RATES
+int
+contikimac_set_channel_check_rate(uint8_t rate)
+{
+  if(rate < MIN_CHANNEL_CHECK_RATE || rate > MAX_CHANNEL_CHECK_RATE ||
+     (rate & (rate - 1)) != 0) {
+    return 0;
+  }
+  /* The power cycle picks the new cycle time up at its next cycle. */
+  own_channel_check_rate = rate;
+  own_cycle_time = RTIMER_ARCH_SECOND / rate;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+contikimac_channel_check_rate(void)
+{
+  return own_channel_check_rate;
 }
+#endif /* WITH_ASYMMETRIC_RATES */
 /*---------------------------------------------------------------------------*/
 const struct rdc_driver contikimac_driver = {
   "ContikiMAC",
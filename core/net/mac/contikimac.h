@@ -46,4 +46,13 @@
 
 extern const struct rdc_driver contikimac_driver;
 
+#if CONTIKIMAC_CONF_WITH_ASYMMETRIC_RATES
+/* Set the channel check rate of this node, a power of two between
+   CONTIKIMAC_CONF_MIN_CHANNEL_CHECK_RATE and
+   CONTIKIMAC_CONF_MAX_CHANNEL_CHECK_RATE. Returns 0 if the rate is
+   not allowed. */
+int contikimac_set_channel_check_rate(uint8_t rate);
+uint8_t contikimac_channel_check_rate(void);
+#endif /* CONTIKIMAC_CONF_WITH_ASYMMETRIC_RATES */
+
 #endif /* CONTIKIMAC_H */
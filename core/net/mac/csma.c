@@ -49,6 +49,7 @@
 #include "net/netstack.h"
 
 #include "lib/list.h"
+#include "lib/dlist.h"
 #include "lib/memb.h"
 
 #include <string.h>
@@ -76,11 +77,43 @@
 #error Change CSMA_CONF_MAX_MAC_TRANSMISSIONS in contiki-conf.h or in your Makefile.
 #endif /* CSMA_CONF_MAX_MAC_TRANSMISSIONS < 1 */
 
+/* The number of buckets of the neighbor queue index, a power of
+   two. With 0, the neighbor queues are looked up in a list. */
+#ifdef CSMA_CONF_NEIGHBOR_HASH_SIZE
+#define CSMA_NEIGHBOR_HASH_SIZE CSMA_CONF_NEIGHBOR_HASH_SIZE
+#else
+#define CSMA_NEIGHBOR_HASH_SIZE 0
+#endif /* CSMA_CONF_NEIGHBOR_HASH_SIZE */
+
+#if CSMA_NEIGHBOR_HASH_SIZE & (CSMA_NEIGHBOR_HASH_SIZE - 1)
+#error CSMA_CONF_NEIGHBOR_HASH_SIZE must be a power of two
+#endif
+
+/* With fair scheduling, a neighbor whose transmit timer expires does
+   not transmit right away but waits for its turn: the neighbors take
+   turns of CSMA_SCHEDULING_QUANTUM transmissions each, the control
+   class first, so that a neighbor that needs many retransmissions
+   does not hold the channel from the others. */
+#ifdef CSMA_CONF_FAIR_SCHEDULING
+#define CSMA_FAIR_SCHEDULING CSMA_CONF_FAIR_SCHEDULING
+#else
+#define CSMA_FAIR_SCHEDULING 0
+#endif /* CSMA_CONF_FAIR_SCHEDULING */
+
+#ifdef CSMA_CONF_SCHEDULING_QUANTUM
+#define CSMA_SCHEDULING_QUANTUM CSMA_CONF_SCHEDULING_QUANTUM
+#else
+#define CSMA_SCHEDULING_QUANTUM 1
+#endif /* CSMA_CONF_SCHEDULING_QUANTUM */
+
 /* Packet metadata */
 struct qbuf_metadata {
   mac_callback_t sent;
   void *cptr;
   uint8_t max_transmissions;
+#if CSMA_FAIR_SCHEDULING
+  uint8_t class;
+#endif /* CSMA_FAIR_SCHEDULING */
 };
 
 /* Every neighbor has its own packet queue */
@@ -90,7 +123,14 @@ struct neighbor_queue {
   struct ctimer transmit_timer;
   uint8_t transmissions;
   uint8_t collisions, deferrals;
-  LIST_STRUCT(queued_packet_list);
+  DLIST_STRUCT(queued_packet_list);
+#if CSMA_NEIGHBOR_HASH_SIZE
+  struct neighbor_queue *hash_next;
+#endif /* CSMA_NEIGHBOR_HASH_SIZE */
+#if CSMA_FAIR_SCHEDULING
+  struct neighbor_queue *ready_next;
+  uint8_t deficit;
+#endif /* CSMA_FAIR_SCHEDULING */
 };
 
 /* The maximum number of co-existing neighbor queues */
@@ -104,15 +144,53 @@ struct neighbor_queue {
 MEMB(neighbor_memb, struct neighbor_queue, CSMA_MAX_NEIGHBOR_QUEUES);
 MEMB(packet_memb, struct rdc_buf_list, MAX_QUEUED_PACKETS);
 MEMB(metadata_memb, struct qbuf_metadata, MAX_QUEUED_PACKETS);
+#if CSMA_NEIGHBOR_HASH_SIZE
+static struct neighbor_queue *neighbor_hash[CSMA_NEIGHBOR_HASH_SIZE];
+#else /* CSMA_NEIGHBOR_HASH_SIZE */
 LIST(neighbor_list);
+#endif /* CSMA_NEIGHBOR_HASH_SIZE */
+
+#if CSMA_FAIR_SCHEDULING
+/* The neighbors waiting for their turn, per class. */
+static struct neighbor_queue *ready_head[CSMA_NUM_CLASSES];
+static struct neighbor_queue *ready_tail[CSMA_NUM_CLASSES];
+/* The neighbor whose packet the RDC layer is sending. */
+static struct neighbor_queue *transmitting;
+static struct ctimer schedule_timer;
+#endif /* CSMA_FAIR_SCHEDULING */
 
 static void packet_sent(void *ptr, int status, int num_transmissions);
 static void transmit_packet_list(void *ptr);
 
+/*---------------------------------------------------------------------------*/
+#if CSMA_NEIGHBOR_HASH_SIZE
+static unsigned
+neighbor_hash_index(const rimeaddr_t *addr)
+{
+  unsigned h;
+  int i;
+
+  h = 0;
+  for(i = 0; i < sizeof(rimeaddr_t); i++) {
+    h = h * 31 + addr->u8[i];
+  }
+  return h & (CSMA_NEIGHBOR_HASH_SIZE - 1);
+}
+#endif /* CSMA_NEIGHBOR_HASH_SIZE */
 /*---------------------------------------------------------------------------*/
 static struct neighbor_queue *
 neighbor_queue_from_addr(const rimeaddr_t *addr)
 {
+#if CSMA_NEIGHBOR_HASH_SIZE
+  struct neighbor_queue *n = neighbor_hash[neighbor_hash_index(addr)];
+  while(n != NULL) {
+    if(rimeaddr_cmp(&n->addr, addr)) {
+      return n;
+    }
+    n = n->hash_next;
+  }
+  return NULL;
+#else /* CSMA_NEIGHBOR_HASH_SIZE */
   struct neighbor_queue *n = list_head(neighbor_list);
   while(n != NULL) {
     if(rimeaddr_cmp(&n->addr, addr)) {
@@ -121,8 +199,64 @@ neighbor_queue_from_addr(const rimeaddr_t *addr)
     n = list_item_next(n);
   }
   return NULL;
+#endif /* CSMA_NEIGHBOR_HASH_SIZE */
 }
 /*---------------------------------------------------------------------------*/
+static void
+add_neighbor_queue(struct neighbor_queue *n)
+{
+#if CSMA_NEIGHBOR_HASH_SIZE
+  unsigned i = neighbor_hash_index(&n->addr);
+  n->hash_next = neighbor_hash[i];
+  neighbor_hash[i] = n;
+#else /* CSMA_NEIGHBOR_HASH_SIZE */
+  list_add(neighbor_list, n);
+#endif /* CSMA_NEIGHBOR_HASH_SIZE */
+}
+/*---------------------------------------------------------------------------*/
+static void
+free_neighbor_queue(struct neighbor_queue *n)
+{
+#if CSMA_NEIGHBOR_HASH_SIZE
+  struct neighbor_queue **np;
+
+  for(np = &neighbor_hash[neighbor_hash_index(&n->addr)];
+      *np != NULL; np = &(*np)->hash_next) {
+    if(*np == n) {
+      *np = n->hash_next;
+      break;
+    }
+  }
+#else /* CSMA_NEIGHBOR_HASH_SIZE */
+  list_remove(neighbor_list, n);
+#endif /* CSMA_NEIGHBOR_HASH_SIZE */
+#if CSMA_FAIR_SCHEDULING
+  if(transmitting == n) {
+    transmitting = NULL;
+  }
+#endif /* CSMA_FAIR_SCHEDULING */
+  memb_free(&neighbor_memb, n);
+}
+/*---------------------------------------------------------------------------*/
+#if CSMA_FAIR_SCHEDULING
+static uint8_t
+packet_class(void)
+{
+  switch(packetbuf_attr(PACKETBUF_ATTR_TRAFFIC_CLASS)) {
+  case PACKETBUF_ATTR_TRAFFIC_CLASS_CONTROL:
+    return CSMA_CLASS_CONTROL;
+  case PACKETBUF_ATTR_TRAFFIC_CLASS_DATA:
+    return CSMA_CLASS_DATA;
+  }
+  if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
+     PACKETBUF_ATTR_PACKET_TYPE_ACK ||
+     rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), &rimeaddr_null)) {
+    return CSMA_CLASS_CONTROL;
+  }
+  return CSMA_CLASS_DATA;
+}
+#endif /* CSMA_FAIR_SCHEDULING */
+/*---------------------------------------------------------------------------*/
 static clock_time_t
 default_timebase(void)
 {
@@ -140,17 +274,93 @@ default_timebase(void)
   return time;
 }
 /*---------------------------------------------------------------------------*/
+#if CSMA_FAIR_SCHEDULING
+static uint8_t
+queued_packet_class(struct rdc_buf_list *q)
+{
+  return ((struct qbuf_metadata *)q->ptr)->class;
+}
+/*---------------------------------------------------------------------------*/
+static void
+schedule(void *ptr)
+{
+  struct neighbor_queue *n;
+  struct rdc_buf_list *q;
+  int c;
+
+  if(transmitting != NULL) {
+    return;
+  }
+  for(c = 0; c < CSMA_NUM_CLASSES; c++) {
+    while(ready_head[c] != NULL) {
+      n = ready_head[c];
+      ready_head[c] = n->ready_next;
+      if(ready_head[c] == NULL) {
+        ready_tail[c] = NULL;
+      }
+      q = dlist_head(n->queued_packet_list);
+      if(q == NULL) {
+        continue;
+      }
+      PRINTF("csma: turn of %d.%d, class %d, deficit %d\n",
+             n->addr.u8[0], n->addr.u8[1], c, n->deficit);
+      n->deficit--;
+      transmitting = n;
+      NETSTACK_RDC.send_list(packet_sent, n, q);
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The transmit timer of the neighbor has expired: queue it for its
+   turn. A neighbor that has transmissions left in its turn goes
+   first in its class, the others go last. */
+static void
+make_ready(struct neighbor_queue *n)
+{
+  struct rdc_buf_list *q;
+  int c;
+
+  q = dlist_head(n->queued_packet_list);
+  if(q == NULL) {
+    return;
+  }
+  c = queued_packet_class(q);
+  if(n->deficit > 0) {
+    n->ready_next = ready_head[c];
+    ready_head[c] = n;
+    if(ready_tail[c] == NULL) {
+      ready_tail[c] = n;
+    }
+  } else {
+    n->deficit = CSMA_SCHEDULING_QUANTUM;
+    n->ready_next = NULL;
+    if(ready_tail[c] == NULL) {
+      ready_head[c] = n;
+    } else {
+      ready_tail[c]->ready_next = n;
+    }
+    ready_tail[c] = n;
+  }
+  schedule(NULL);
+}
+#endif /* CSMA_FAIR_SCHEDULING */
+/*---------------------------------------------------------------------------*/
 static void
 transmit_packet_list(void *ptr)
 {
   struct neighbor_queue *n = ptr;
   if(n) {
-    struct rdc_buf_list *q = list_head(n->queued_packet_list);
+    struct rdc_buf_list *q = dlist_head(n->queued_packet_list);
     if(q != NULL) {
       PRINTF("csma: preparing number %d %p, queue len %d\n", n->transmissions, q,
-          list_length(n->queued_packet_list));
+          dlist_length(n->queued_packet_list));
+#if CSMA_FAIR_SCHEDULING
+      make_ready(n);
+#else /* CSMA_FAIR_SCHEDULING */
       /* Send packets in the neighbor's list */
       NETSTACK_RDC.send_list(packet_sent, n, q);
+#endif /* CSMA_FAIR_SCHEDULING */
     }
   }
 }
@@ -160,14 +370,14 @@ free_packet(struct neighbor_queue *n, struct rdc_buf_list *p)
 {
   if(p != NULL) {
     /* Remove packet from list and deallocate */
-    list_remove(n->queued_packet_list, p);
+    dlist_remove(n->queued_packet_list, p);
 
     queuebuf_free(p->buf);
     memb_free(&metadata_memb, p->ptr);
     memb_free(&packet_memb, p);
     PRINTF("csma: free_queued_packet, queue length %d\n",
-        list_length(n->queued_packet_list));
-    if(list_head(n->queued_packet_list) != NULL) {
+        dlist_length(n->queued_packet_list));
+    if(dlist_head(n->queued_packet_list) != NULL) {
       /* There is a next packet. We reset current tx information */
       n->transmissions = 0;
       n->collisions = 0;
@@ -178,8 +388,7 @@ free_packet(struct neighbor_queue *n, struct rdc_buf_list *p)
     } else {
       /* This was the last packet in the queue, we free the neighbor */
       ctimer_stop(&n->transmit_timer);
-      list_remove(neighbor_list, n);
-      memb_free(&neighbor_memb, n);
+      free_neighbor_queue(n);
     }
   }
 }
@@ -200,6 +409,14 @@ packet_sent(void *ptr, int status, int num_transmissions)
   if(n == NULL) {
     return;
   }
+#if CSMA_FAIR_SCHEDULING
+  if(n == transmitting) {
+    /* Let the next neighbor in line transmit, once the RDC layer is
+       done with this packet. */
+    transmitting = NULL;
+    ctimer_set(&schedule_timer, 0, schedule, NULL);
+  }
+#endif /* CSMA_FAIR_SCHEDULING */
   switch(status) {
   case MAC_TX_OK:
   case MAC_TX_NOACK:
@@ -213,8 +430,8 @@ packet_sent(void *ptr, int status, int num_transmissions)
     break;
   }
 
-  for(q = list_head(n->queued_packet_list);
-      q != NULL; q = list_item_next(q)) {
+  for(q = dlist_head(n->queued_packet_list);
+      q != NULL; q = dlist_item_next(q)) {
     if(queuebuf_attr(q->buf, PACKETBUF_ATTR_MAC_SEQNO) ==
        packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO)) {
       break;
@@ -315,10 +532,13 @@ send_packet(mac_callback_t sent, void *ptr)
       n->transmissions = 0;
       n->collisions = 0;
       n->deferrals = 0;
+#if CSMA_FAIR_SCHEDULING
+      n->deficit = 0;
+#endif /* CSMA_FAIR_SCHEDULING */
       /* Init packet list for this neighbor */
-      LIST_STRUCT_INIT(n, queued_packet_list);
+      DLIST_STRUCT_INIT(n, queued_packet_list);
       /* Add neighbor to the list */
-      list_add(neighbor_list, n);
+      add_neighbor_queue(n);
     }
   }
 
@@ -342,17 +562,42 @@ send_packet(mac_callback_t sent, void *ptr)
 	  metadata->sent = sent;
 	  metadata->cptr = ptr;
 
+#if CSMA_FAIR_SCHEDULING
+	  {
+	    struct rdc_buf_list *prev;
+	    int was_empty = dlist_head(n->queued_packet_list) == NULL;
+
+	    /* Queue the packet after those of its class or a lower one,
+	       but never before the packet that is being sent. */
+	    metadata->class = packet_class();
+	    for(prev = dlist_tail(n->queued_packet_list);
+		prev != NULL && prev != dlist_head(n->queued_packet_list) &&
+		  queued_packet_class(prev) > metadata->class;
+		prev = dlist_item_prev(prev));
+	    if(prev == NULL) {
+	      dlist_add(n->queued_packet_list, q);
+	    } else {
+	      dlist_insert(n->queued_packet_list, prev, q);
+	    }
+
+	    /* If the queue was empty, send asap */
+	    if(was_empty) {
+	      ctimer_set(&n->transmit_timer, 0, transmit_packet_list, n);
+	    }
+	  }
+#else /* CSMA_FAIR_SCHEDULING */
 	  if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
 	     PACKETBUF_ATTR_PACKET_TYPE_ACK) {
-	    list_push(n->queued_packet_list, q);
+	    dlist_push(n->queued_packet_list, q);
 	  } else {
-	    list_add(n->queued_packet_list, q);
+	    dlist_add(n->queued_packet_list, q);
 	  }
 
 	  /* If q is the first packet in the neighbor's queue, send asap */
-	  if(list_head(n->queued_packet_list) == q) {
+	  if(dlist_head(n->queued_packet_list) == q) {
 	    ctimer_set(&n->transmit_timer, 0, transmit_packet_list, n);
 	  }
+#endif /* CSMA_FAIR_SCHEDULING */
 	  return;
 	}
 	memb_free(&metadata_memb, q->ptr);
@@ -362,9 +607,8 @@ send_packet(mac_callback_t sent, void *ptr)
       PRINTF("csma: could not allocate queuebuf, dropping packet\n");
     }
     /* The packet allocation failed. Remove and free neighbor entry if empty. */
-    if(list_length(n->queued_packet_list) == 0) {
-      list_remove(neighbor_list, n);
-      memb_free(&neighbor_memb, n);
+    if(dlist_head(n->queued_packet_list) == NULL) {
+      free_neighbor_queue(n);
     }
     PRINTF("csma: could not allocate packet, dropping packet\n");
   } else {
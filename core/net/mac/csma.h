@@ -44,6 +44,17 @@
 #include "net/mac/mac.h"
 #include "dev/radio.h"
 
+/* The priority classes of the packets. With
+   CSMA_CONF_FAIR_SCHEDULING, the neighbors whose next packet is of
+   a lower class are served first, and the packets of a neighbor are
+   sorted by class. The class comes from PACKETBUF_ATTR_TRAFFIC_CLASS.
+   Packets without one are control packets if they are link-layer
+   ACKs or broadcasts (routing beacons, DIOs, neighbor discovery), and
+   data packets otherwise. */
+#define CSMA_CLASS_CONTROL 0
+#define CSMA_CLASS_DATA    1
+#define CSMA_NUM_CLASSES   2
+
 extern const struct mac_driver csma_driver;
 
 const struct mac_driver *csma_init(const struct mac_driver *r);
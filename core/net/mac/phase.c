@@ -57,8 +57,18 @@ struct phase {
 #endif
   uint8_t noacks;
   struct timer noacks_timer;
+#if PHASE_WITH_CYCLE_TIME
+  rtimer_clock_t cycle_time;
+  uint8_t has_phase;
+#endif /* PHASE_WITH_CYCLE_TIME */
 };
 
+#if PHASE_WITH_CYCLE_TIME
+#define HAS_PHASE(e) ((e) != NULL && (e)->has_phase)
+#else
+#define HAS_PHASE(e) ((e) != NULL)
+#endif
+
 struct phase_queueitem {
   struct ctimer timer;
   mac_callback_t mac_callback;
@@ -95,7 +105,7 @@ phase_update(const rimeaddr_t *neighbor, rtimer_clock_t time,
 
   /* If we have an entry for this neighbor already, we renew it. */
   e = nbr_table_get_from_lladdr(nbr_phase, neighbor);
-  if(e != NULL) {
+  if(HAS_PHASE(e)) {
     if(mac_status == MAC_TX_OK) {
 #if PHASE_DRIFT_CORRECT
       e->drift = time-e->time;
@@ -113,7 +123,12 @@ phase_update(const rimeaddr_t *neighbor, rtimer_clock_t time,
       }
       if(e->noacks >= MAX_NOACKS || timer_expired(&e->noacks_timer)) {
         PRINTF("drop %d\n", neighbor->u8[0]);
+#if PHASE_WITH_CYCLE_TIME
+        /* Forget the phase, but keep the cycle time. */
+        e->has_phase = 0;
+#else
         nbr_table_remove(nbr_phase, e);
+#endif
         return;
       }
     } else if(mac_status == MAC_TX_OK) {
@@ -121,14 +136,24 @@ phase_update(const rimeaddr_t *neighbor, rtimer_clock_t time,
     }
   } else {
     /* No matching phase was found, so we allocate a new one. */
-    if(mac_status == MAC_TX_OK && e == NULL) {
-      e = nbr_table_add_lladdr(nbr_phase, neighbor);
+    if(mac_status == MAC_TX_OK) {
+      if(e == NULL) {
+        e = nbr_table_add_lladdr(nbr_phase, neighbor);
+#if PHASE_WITH_CYCLE_TIME
+        if(e) {
+          e->cycle_time = 0;
+        }
+#endif
+      }
       if(e) {
         e->time = time;
 #if PHASE_DRIFT_CORRECT
       e->drift = 0;
 #endif
       e->noacks = 0;
+#if PHASE_WITH_CYCLE_TIME
+        e->has_phase = 1;
+#endif
       }
     }
   }
@@ -163,7 +188,7 @@ phase_wait(const rimeaddr_t *neighbor, rtimer_clock_t cycle_time,
      time for the next expected phase and setup a ctimer to switch on
      the radio just before the phase. */
   e = nbr_table_get_from_lladdr(nbr_phase, neighbor);
-  if(e != NULL) {
+  if(HAS_PHASE(e)) {
     rtimer_clock_t wait, now, expected, sync;
     clock_time_t ctimewait;
     
@@ -237,6 +262,37 @@ phase_wait(const rimeaddr_t *neighbor, rtimer_clock_t cycle_time,
   return PHASE_UNKNOWN;
 }
 /*---------------------------------------------------------------------------*/
+#if PHASE_WITH_CYCLE_TIME
+void
+phase_set_cycle_time(const rimeaddr_t *neighbor, rtimer_clock_t cycle_time)
+{
+  struct phase *e;
+
+  e = nbr_table_get_from_lladdr(nbr_phase, neighbor);
+  if(e == NULL) {
+    e = nbr_table_add_lladdr(nbr_phase, neighbor);
+    if(e == NULL) {
+      return;
+    }
+    e->has_phase = 0;
+    e->noacks = 0;
+  }
+  e->cycle_time = cycle_time;
+}
+/*---------------------------------------------------------------------------*/
+rtimer_clock_t
+phase_cycle_time(const rimeaddr_t *neighbor, rtimer_clock_t default_cycle_time)
+{
+  struct phase *e;
+
+  e = nbr_table_get_from_lladdr(nbr_phase, neighbor);
+  if(e == NULL || e->cycle_time == 0) {
+    return default_cycle_time;
+  }
+  return e->cycle_time;
+}
+#endif /* PHASE_WITH_CYCLE_TIME */
+/*---------------------------------------------------------------------------*/
 void
 phase_init(void)
 {
@@ -47,6 +47,15 @@
 #include "lib/memb.h"
 #include "net/netstack.h"
 
+/* With asymmetric channel check rates, the phase entries also hold
+   the cycle time that each neighbor advertises, and an entry may
+   exist before the phase of the neighbor is known. */
+#ifdef CONTIKIMAC_CONF_WITH_ASYMMETRIC_RATES
+#define PHASE_WITH_CYCLE_TIME CONTIKIMAC_CONF_WITH_ASYMMETRIC_RATES
+#else
+#define PHASE_WITH_CYCLE_TIME 0
+#endif
+
 typedef enum {
   PHASE_UNKNOWN,
   PHASE_SEND_NOW,
@@ -63,4 +72,11 @@ void phase_update(const rimeaddr_t *neighbor,
                   rtimer_clock_t time, int mac_status);
 void phase_remove(const rimeaddr_t *neighbor);
 
+#if PHASE_WITH_CYCLE_TIME
+void phase_set_cycle_time(const rimeaddr_t *neighbor,
+                          rtimer_clock_t cycle_time);
+rtimer_clock_t phase_cycle_time(const rimeaddr_t *neighbor,
+                                rtimer_clock_t default_cycle_time);
+#endif /* PHASE_WITH_CYCLE_TIME */
+
 #endif /* PHASE_H */
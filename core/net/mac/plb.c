@@ -44,6 +44,7 @@
 #include "net/queuebuf.h"
 #include "net/netstack.h"
 #include "sys/pt.h"
+#include "sys/process.h"
 #include "sys/rtimer.h"
 #include "net/rime.h"
 #include <string.h>/*need?*/
@@ -145,6 +146,16 @@ static int preamble_got = 0;    // later, time out -> get_preamble reset
 /* send */
 static mac_callback_t sent_callback;
 static void* sent_ptr;
+
+/* Packetbuf contexts: the staged outbound data frame, and a received
+   frame that must survive while we build and send an ACK for it. */
+static struct packetbuf_ctx tx_ctx;
+static struct packetbuf_ctx rx_ctx;
+
+/* The power cycle runs from an rtimer, and must not overwrite the
+   packetbuf under the code it interrupted: it polls this process,
+   which sends the staged data frame. */
+PROCESS(plb_send_process, "PLB send");
 /*---------------------------------------------------------------------------*/
 static char plb_powercycle(void);
 static int plb_beacon_sd(void);
@@ -236,6 +247,9 @@ plb_send_data(mac_callback_t sent, void *ptr)
 	int temp=0;
 
 	acked = 0;
+	/* The strobes below reuse the packetbuf, so keep the data frame
+	   in its own context until the receiver has woken up. */
+	packetbuf_ctx_save(&tx_ctx);
 	//packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &rimeaddr_node_addr); plb_create_header assigns SENDER_ADDR  JJH
 
 	if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE)==0) //if packet_type ==0, DATA JJH_START
@@ -244,7 +258,7 @@ plb_send_data(mac_callback_t sent, void *ptr)
 		if(acked==1)
 		{
 			PRINT("plb_send_data DATA_PREAMBLE_ACKED!\n");
-			packetbuf_clear();
+			packetbuf_ctx_restore(&tx_ctx);
 			if (plb_create_header(packetbuf_addr(PACKETBUF_ADDR_NEXT),DATA) < 0)
 			{
 				PRINTF("ERROR: plb_create_header ");
@@ -394,6 +408,7 @@ plb_send(mac_callback_t sent, void *ptr)
   if ( packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) == 0 )	//data
   {
 	  PRINT("plb_send : DATA\n");
+	  packetbuf_ctx_save(&tx_ctx);
 	  send_req = 1;
 	  sent_callback = sent;
 	  sent_ptr = ptr;
@@ -444,10 +459,13 @@ plb_send_ack(uint8_t type){
 
 	PRINT("plb_send_ack : type: %x dst: %u.%u\n", type, addr_ack.u8[0], addr_ack.u8[1]);
 
+	/* Keep the received frame: it is passed up after the ACK is sent. */
+	packetbuf_ctx_save(&rx_ctx);
 	packetbuf_clear();
 	if ((ack_len = plb_create_header(&addr_ack, type)) < 0) // type 4 = ack
 			{
 		PRINTF("ERROR: plb_create_header ");
+		packetbuf_ctx_restore(&rx_ctx);
 		return;
 	}
 	ack_len++;
@@ -457,10 +475,12 @@ plb_send_ack(uint8_t type){
 	if (ack_len > (int) sizeof(ack)) {
 		// Failed to send //
 		PRINTF("plb: send failed, too large header\n");
+		packetbuf_ctx_restore(&rx_ctx);
 		return;
 	}
 
 	memcpy(ack, packetbuf_hdrptr(), ack_len);
+	packetbuf_ctx_restore(&rx_ctx);
 
 	PRINTF("(ack)pbe len: %u | %u\n", packetbuf_hdrlen(), packetbuf_datalen());
 	PRINTF("data: %s\n", (char* ) packetbuf_dataptr());
@@ -573,6 +593,7 @@ plb_init(void)
   has_data = 0;
   wait_packet = 0;
   is_init = 1;
+  process_start(&plb_send_process, NULL);
   sync_req = 0;
   sync_ack = 0;
   sync_end = 0;
@@ -814,7 +835,7 @@ plb_powercycle(void)
     if(send_req && c_wait==1){
     	PRINT("plb_powercycle send DATA\n");
     	send_req = 0;	//avoid repeat sending
-    	plb_send_data(sent_callback, sent_ptr);
+    	process_poll(&plb_send_process);
     }
 
     /* on */
@@ -835,6 +856,19 @@ plb_powercycle(void)
   PT_END(&pt);
 }
 /*---------------------------------------------------------------------------*/
+PROCESS_THREAD(plb_send_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    packetbuf_ctx_restore(&tx_ctx);
+    plb_send_data(sent_callback, sent_ptr);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
 static void hold_time(rtimer_clock_t interval)
 {
   rtimer_clock_t rct;
@@ -47,6 +47,8 @@
 /* List of packets to be sent by RDC layer */
 struct rdc_buf_list {
   struct rdc_buf_list *next;
+  /* Kept second so that rdc_buf_lists can be used with lib/dlist. */
+  struct rdc_buf_list *prev;
   struct queuebuf *buf;
   void *ptr;
 };
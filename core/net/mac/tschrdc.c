@@ -0,0 +1,618 @@
+/*
+ * Copyright (c) 2026, The Contiki-PLB contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         A time-slotted, channel hopping RDC driver
+ *
+ *         Time is divided in slots, which are grouped into repeating
+ *         slotframes. A schedule of links tells, for each timeslot of
+ *         the slotframe, whether the node transmits, receives or
+ *         sleeps and on which channel offset. The radio is only on in
+ *         the slots of the schedule, so there is no idle listening
+ *         outside of them and the per-hop latency is bounded by the
+ *         slotframe length rather than by a wake-up period.
+ *
+ *         The slots are aligned on the network time of the timesynch
+ *         module when it is enabled. As the rtimer clock wraps, the
+ *         slots are numbered from the start of each period of the
+ *         network clock; the tail of the period that does not fit a
+ *         whole slot is left idle. The channel of a slot is picked
+ *         from the hopping sequence with the slot number and the
+ *         channel offset of the link.
+ *
+ *         Packets are queued until a TX link to their receiver comes
+ *         up, and each send is a single transmission: the
+ *         retransmissions are left to the MAC layer, as with the other
+ *         RDC drivers.
+ */
+
+#include "contiki.h"
+#include "net/mac/tschrdc.h"
+#include "net/packetbuf.h"
+#include "net/queuebuf.h"
+#include "net/netstack.h"
+#include "dev/radio.h"
+#include "sys/rtimer.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+#include "lib/random.h"
+#if TIMESYNCH_CONF_ENABLED
+#include "net/rime/timesynch.h"
+#endif /* TIMESYNCH_CONF_ENABLED */
+
+#include <string.h>
+
+#define DEBUG 0
+#if DEBUG
+#include <stdio.h>
+#define PRINTF(...) printf(__VA_ARGS__)
+#else
+#define PRINTF(...)
+#endif
+
+/* The duration of a slot, in rtimer ticks. */
+#ifdef TSCHRDC_CONF_SLOT_DURATION
+#define SLOT_DURATION TSCHRDC_CONF_SLOT_DURATION
+#else
+#define SLOT_DURATION (RTIMER_ARCH_SECOND / 100)
+#endif
+
+/* The number of slots in a slotframe. */
+#ifdef TSCHRDC_CONF_SLOTFRAME_LENGTH
+#define SLOTFRAME_LENGTH TSCHRDC_CONF_SLOTFRAME_LENGTH
+#else
+#define SLOTFRAME_LENGTH 7
+#endif
+
+/* The time from the start of a slot to the start of a transmission,
+   and the time that a receiver listens before and after it to make up
+   for the synchronization error. */
+#ifdef TSCHRDC_CONF_TX_OFFSET
+#define TX_OFFSET TSCHRDC_CONF_TX_OFFSET
+#else
+#define TX_OFFSET (SLOT_DURATION / 4)
+#endif
+#ifdef TSCHRDC_CONF_GUARD_TIME
+#define GUARD_TIME TSCHRDC_CONF_GUARD_TIME
+#else
+#define GUARD_TIME (SLOT_DURATION / 10)
+#endif
+
+/* The channels to hop over, and the function that switches the radio
+   to a channel. The radio driver interface has no channel switching,
+   so the platform provides it, for example with
+   #define TSCHRDC_CONF_SET_CHANNEL(c) cc2420_set_channel(c)
+   Without it, all slots use the channel of the radio. */
+#ifdef TSCHRDC_CONF_HOPPING_SEQUENCE
+#define HOPPING_SEQUENCE TSCHRDC_CONF_HOPPING_SEQUENCE
+#else
+#define HOPPING_SEQUENCE { 26 }
+#endif
+#ifdef TSCHRDC_CONF_SET_CHANNEL
+#define SET_CHANNEL(c) TSCHRDC_CONF_SET_CHANNEL(c)
+#else
+#define SET_CHANNEL(c) (void)(c)
+#endif
+
+#ifdef TSCHRDC_CONF_MAX_LINKS
+#define MAX_LINKS TSCHRDC_CONF_MAX_LINKS
+#else
+#define MAX_LINKS 8
+#endif
+
+#ifdef TSCHRDC_CONF_QUEUE_LENGTH
+#define QUEUE_LENGTH TSCHRDC_CONF_QUEUE_LENGTH
+#else
+#define QUEUE_LENGTH 8
+#endif
+
+/* The minimal schedule is a single shared slot at the start of the
+   slotframe, in which all nodes listen and may transmit. */
+#ifdef TSCHRDC_CONF_WITH_MINIMAL_SCHEDULE
+#define WITH_MINIMAL_SCHEDULE TSCHRDC_CONF_WITH_MINIMAL_SCHEDULE
+#else
+#define WITH_MINIMAL_SCHEDULE 1
+#endif
+
+/* The backoff exponents on shared links. After a failed transmission
+   on a shared link, the packets wait for a random number of shared TX
+   slots, below 2^BE, before they are sent again, and BE grows up to
+   MAX_BE. A successful transmission resets BE to MIN_BE. */
+#ifdef TSCHRDC_CONF_MIN_BE
+#define MIN_BE TSCHRDC_CONF_MIN_BE
+#else
+#define MIN_BE 1
+#endif
+#ifdef TSCHRDC_CONF_MAX_BE
+#define MAX_BE TSCHRDC_CONF_MAX_BE
+#else
+#define MAX_BE 5
+#endif
+
+/* The number of whole slots in a period of the rtimer clock. */
+#define SLOTS_PER_PERIOD ((rtimer_clock_t)~0 / SLOT_DURATION)
+
+struct link {
+  rimeaddr_t neighbor;
+  uint16_t timeslot;
+  uint8_t channel_offset;
+  uint8_t options;
+};
+
+#define TX_PENDING -1
+
+struct tx_packet {
+  struct tx_packet *next;
+  struct queuebuf *buf;
+  mac_callback_t sent;
+  void *ptr;
+  rimeaddr_t receiver;
+  volatile int status;
+};
+
+static struct link links[MAX_LINKS];
+
+MEMB(tx_packet_memb, struct tx_packet, QUEUE_LENGTH);
+LIST(tx_packet_list);
+
+static const uint8_t hopping_sequence[] = HOPPING_SEQUENCE;
+#define HOPPING_SEQUENCE_LENGTH (sizeof(hopping_sequence) / sizeof(hopping_sequence[0]))
+
+static struct rtimer rt;
+static struct pt pt;
+
+static volatile uint8_t tschrdc_is_on = 0;
+static volatile uint8_t tschrdc_keep_radio_on = 0;
+static volatile uint8_t we_are_listening = 0;
+
+/* Set while tschrdc_process changes tx_packet_list: the slot operation
+   then sends nothing, rather than walk a list that is being changed. */
+static volatile uint8_t tx_list_locked = 0;
+
+/* The backoff on shared links, only used by the slot operation. */
+static uint8_t backoff_exponent = MIN_BE;
+static uint8_t backoff_window = 0;
+
+/* The next active slot: its number in the period of the network
+   clock, its start in local rtimer time, and its link. */
+static rtimer_clock_t slot_number;
+static rtimer_clock_t slot_start;
+static struct link *current_link;
+static struct tx_packet *current_packet;
+
+PROCESS(tschrdc_process, "TSCH RDC process");
+/*---------------------------------------------------------------------------*/
+static rtimer_clock_t
+to_network_time(rtimer_clock_t t)
+{
+#if TIMESYNCH_CONF_ENABLED
+  return timesynch_rtimer_to_time(t);
+#else
+  return t;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static rtimer_clock_t
+to_local_time(rtimer_clock_t t)
+{
+#if TIMESYNCH_CONF_ENABLED
+  return timesynch_time_to_rtimer(t);
+#else
+  return t;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static struct link *
+find_link(uint16_t timeslot)
+{
+  int i;
+
+  for(i = 0; i < MAX_LINKS; i++) {
+    if(links[i].options != 0 && links[i].timeslot == timeslot) {
+      return &links[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+next_active_slot(void)
+{
+  int i;
+
+  slot_number = to_network_time(RTIMER_NOW()) / SLOT_DURATION + 1;
+  current_link = NULL;
+  for(i = 0; i < SLOTFRAME_LENGTH; i++) {
+    if(slot_number >= SLOTS_PER_PERIOD) {
+      slot_number = 0;
+    }
+    current_link = find_link(slot_number % SLOTFRAME_LENGTH);
+    if(current_link != NULL) {
+      break;
+    }
+    slot_number++;
+  }
+  if(slot_number >= SLOTS_PER_PERIOD) {
+    slot_number = 0;
+  }
+  slot_start = to_local_time((rtimer_clock_t)(slot_number * SLOT_DURATION));
+}
+/*---------------------------------------------------------------------------*/
+static struct tx_packet *
+next_packet(const struct link *l)
+{
+  struct tx_packet *p;
+
+  for(p = list_head(tx_packet_list); p != NULL; p = list_item_next(p)) {
+    if(p->status == TX_PENDING &&
+       (rimeaddr_cmp(&l->neighbor, &rimeaddr_null) ||
+        rimeaddr_cmp(&l->neighbor, &p->receiver))) {
+      return p;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+radio_off(void)
+{
+  we_are_listening = 0;
+  if(!tschrdc_keep_radio_on) {
+    NETSTACK_RADIO.off();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static char slot_operation(struct rtimer *t, void *ptr);
+static void
+schedule_slot_operation(struct rtimer *t, rtimer_clock_t fixed_time)
+{
+  int r;
+
+  if(tschrdc_is_on) {
+
+    if(RTIMER_CLOCK_LT(fixed_time, RTIMER_NOW() + 1)) {
+      fixed_time = RTIMER_NOW() + 1;
+    }
+
+    r = rtimer_set(t, fixed_time, 1,
+                   (void (*)(struct rtimer *, void *))slot_operation, NULL);
+    if(r != RTIMER_OK) {
+      PRINTF("schedule_slot_operation: could not set rtimer\n");
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static char
+slot_operation(struct rtimer *t, void *ptr)
+{
+  PT_BEGIN(&pt);
+
+  while(1) {
+    next_active_slot();
+    schedule_slot_operation(t, slot_start);
+    PT_YIELD(&pt);
+
+    if(current_link == NULL) {
+      continue;
+    }
+
+    SET_CHANNEL(hopping_sequence[(slot_number + current_link->channel_offset) %
+                                 HOPPING_SEQUENCE_LENGTH]);
+
+    current_packet = NULL;
+    if((current_link->options & TSCHRDC_LINK_OPTION_TX) && !tx_list_locked) {
+      current_packet = next_packet(current_link);
+      if(current_packet != NULL &&
+         (current_link->options & TSCHRDC_LINK_OPTION_SHARED) &&
+         backoff_window > 0) {
+        /* Let this shared slot go by. */
+        backoff_window--;
+        current_packet = NULL;
+      }
+    }
+
+    if(current_packet != NULL) {
+      NETSTACK_RADIO.prepare(queuebuf_dataptr(current_packet->buf),
+                             queuebuf_datalen(current_packet->buf));
+      schedule_slot_operation(t, slot_start + TX_OFFSET);
+      PT_YIELD(&pt);
+
+      switch(NETSTACK_RADIO.transmit(queuebuf_datalen(current_packet->buf))) {
+      case RADIO_TX_OK:
+        current_packet->status = MAC_TX_OK;
+        break;
+      case RADIO_TX_COLLISION:
+        current_packet->status = MAC_TX_COLLISION;
+        break;
+      case RADIO_TX_NOACK:
+        current_packet->status = MAC_TX_NOACK;
+        break;
+      default:
+        current_packet->status = MAC_TX_ERR;
+        break;
+      }
+      if(current_link->options & TSCHRDC_LINK_OPTION_SHARED) {
+        if(current_packet->status == MAC_TX_OK) {
+          backoff_exponent = MIN_BE;
+          backoff_window = 0;
+        } else {
+          if(backoff_exponent < MAX_BE) {
+            backoff_exponent++;
+          }
+          backoff_window = random_rand() % (1 << backoff_exponent);
+        }
+      }
+      process_poll(&tschrdc_process);
+
+    } else if(current_link->options & TSCHRDC_LINK_OPTION_RX) {
+      /* Listen from GUARD_TIME before to GUARD_TIME after the expected
+         start of the transmission. */
+      schedule_slot_operation(t, slot_start + TX_OFFSET - GUARD_TIME);
+      PT_YIELD(&pt);
+      we_are_listening = 1;
+      NETSTACK_RADIO.on();
+      schedule_slot_operation(t, slot_start + TX_OFFSET + GUARD_TIME);
+      PT_YIELD(&pt);
+
+      if(NETSTACK_RADIO.receiving_packet()) {
+        /* Let the packet in before the end of the slot. */
+        schedule_slot_operation(t, slot_start + SLOT_DURATION - GUARD_TIME);
+        PT_YIELD(&pt);
+      }
+      /* A pending packet is read with the radio on; packet_input()
+         turns it off. */
+      if(NETSTACK_RADIO.pending_packet()) {
+        we_are_listening = 0;
+      } else {
+        radio_off();
+      }
+    }
+  }
+
+  PT_END(&pt);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tschrdc_process, ev, data)
+{
+  struct tx_packet *p, *next;
+  mac_callback_t sent;
+  void *ptr;
+  int status;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    /* Report the packets that were transmitted since the last poll. */
+    for(p = list_head(tx_packet_list); p != NULL; p = next) {
+      next = list_item_next(p);
+      if(p->status != TX_PENDING) {
+        sent = p->sent;
+        ptr = p->ptr;
+        status = p->status;
+        queuebuf_to_packetbuf(p->buf);
+        tx_list_locked = 1;
+        list_remove(tx_packet_list, p);
+        tx_list_locked = 0;
+        queuebuf_free(p->buf);
+        memb_free(&tx_packet_memb, p);
+        mac_call_sent_callback(sent, ptr, status, 1);
+      }
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+static int
+queue_packet(mac_callback_t sent, void *ptr)
+{
+  struct tx_packet *p;
+
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &rimeaddr_node_addr);
+  if(NETSTACK_FRAMER.create() < 0) {
+    PRINTF("tschrdc: send failed, too large header\n");
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR_FATAL, 1);
+    return 0;
+  }
+
+  p = memb_alloc(&tx_packet_memb);
+  if(p == NULL) {
+    PRINTF("tschrdc: send failed, queue full\n");
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 1);
+    return 0;
+  }
+  p->buf = queuebuf_new_from_packetbuf();
+  if(p->buf == NULL) {
+    memb_free(&tx_packet_memb, p);
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 1);
+    return 0;
+  }
+  p->sent = sent;
+  p->ptr = ptr;
+  rimeaddr_copy(&p->receiver, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+  p->status = TX_PENDING;
+  tx_list_locked = 1;
+  list_add(tx_packet_list, p);
+  tx_list_locked = 0;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(mac_callback_t sent, void *ptr)
+{
+  queue_packet(sent, ptr);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
+{
+  while(buf_list != NULL) {
+    /* We backup the next pointer, as it may be nullified by
+     * mac_call_sent_callback() */
+    struct rdc_buf_list *next = buf_list->next;
+
+    queuebuf_to_packetbuf(buf_list->buf);
+    if(!queue_packet(sent, ptr)) {
+      return;
+    }
+    buf_list = next;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_input(void)
+{
+  if(tschrdc_is_on && !we_are_listening) {
+    radio_off();
+  }
+
+  if(NETSTACK_FRAMER.parse() < 0) {
+    PRINTF("tschrdc: failed to parse %u\n", packetbuf_datalen());
+  } else if(!rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                          &rimeaddr_node_addr) &&
+            !rimeaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                          &rimeaddr_null)) {
+    PRINTF("tschrdc: not for us\n");
+  } else {
+    NETSTACK_MAC.input();
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+tschrdc_add_link(uint16_t timeslot, uint8_t channel_offset,
+                 uint8_t options, const rimeaddr_t *neighbor)
+{
+  struct link *l;
+  int i;
+
+  if(timeslot >= SLOTFRAME_LENGTH || options == 0) {
+    return 0;
+  }
+
+  l = find_link(timeslot);
+  for(i = 0; l == NULL && i < MAX_LINKS; i++) {
+    if(links[i].options == 0) {
+      l = &links[i];
+    }
+  }
+  if(l == NULL) {
+    return 0;
+  }
+
+  l->timeslot = timeslot;
+  l->channel_offset = channel_offset;
+  if(neighbor != NULL) {
+    rimeaddr_copy(&l->neighbor, neighbor);
+  } else {
+    rimeaddr_copy(&l->neighbor, &rimeaddr_null);
+  }
+  l->options = options;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+tschrdc_remove_link(uint16_t timeslot)
+{
+  struct link *l;
+
+  l = find_link(timeslot);
+  if(l != NULL) {
+    l->options = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tschrdc_clear_schedule(void)
+{
+  memset(links, 0, sizeof(links));
+}
+/*---------------------------------------------------------------------------*/
+static int
+turn_on(void)
+{
+  if(tschrdc_is_on == 0) {
+    tschrdc_is_on = 1;
+    tschrdc_keep_radio_on = 0;
+    NETSTACK_RADIO.off();
+    PT_INIT(&pt);
+    rtimer_set(&rt, RTIMER_NOW() + 1, 1,
+               (void (*)(struct rtimer *, void *))slot_operation, NULL);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+turn_off(int keep_radio_on)
+{
+  tschrdc_is_on = 0;
+  tschrdc_keep_radio_on = keep_radio_on;
+  if(keep_radio_on) {
+    return NETSTACK_RADIO.on();
+  } else {
+    return NETSTACK_RADIO.off();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return (1ul * CLOCK_SECOND * SLOT_DURATION * SLOTFRAME_LENGTH) /
+    RTIMER_ARCH_SECOND;
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  memb_init(&tx_packet_memb);
+  list_init(tx_packet_list);
+  tschrdc_clear_schedule();
+#if WITH_MINIMAL_SCHEDULE
+  tschrdc_add_link(0, 0, TSCHRDC_LINK_OPTION_TX | TSCHRDC_LINK_OPTION_RX |
+                   TSCHRDC_LINK_OPTION_SHARED, NULL);
+#endif /* WITH_MINIMAL_SCHEDULE */
+  process_start(&tschrdc_process, NULL);
+  turn_on();
+}
+/*---------------------------------------------------------------------------*/
+const struct rdc_driver tschrdc_driver = {
+  "TSCH RDC",
+  init,
+  send_packet,
+  send_list,
+  packet_input,
+  turn_on,
+  turn_off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026, The Contiki-PLB contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+
+/**
+ * \file
+ *         Header file for a time-slotted, channel hopping RDC driver
+ */
+
+#ifndef TSCHRDC_H
+#define TSCHRDC_H
+
+#include "net/mac/rdc.h"
+#include "net/rime/rimeaddr.h"
+
+/* The options of a link. A TX link with a neighbor address only
+   carries the packets to that neighbor, a TX link without one carries
+   any packet, including broadcasts. Shared links may be used by
+   several senders and are open to collisions: after a failed
+   transmission on a shared link, the sender backs off for a random
+   number of shared TX slots. */
+#define TSCHRDC_LINK_OPTION_TX      1
+#define TSCHRDC_LINK_OPTION_RX      2
+#define TSCHRDC_LINK_OPTION_SHARED  4
+
+extern const struct rdc_driver tschrdc_driver;
+
+/**
+ * \brief      Add a link to the schedule
+ * \param timeslot The timeslot of the link in the slotframe
+ * \param channel_offset The channel offset of the link
+ * \param options The TSCHRDC_LINK_OPTION_ options of the link
+ * \param neighbor The neighbor of a TX link, or NULL for any neighbor
+ * \return     Non-zero if the link was added
+ *
+ *             A node has at most one link in each timeslot, so this
+ *             function replaces any link that is already in the
+ *             timeslot.
+ */
+int tschrdc_add_link(uint16_t timeslot, uint8_t channel_offset,
+                     uint8_t options, const rimeaddr_t *neighbor);
+
+/**
+ * \brief      Remove the link of a timeslot from the schedule
+ * \param timeslot The timeslot of the link in the slotframe
+ */
+void tschrdc_remove_link(uint16_t timeslot);
+
+/**
+ * \brief      Remove all links from the schedule
+ */
+void tschrdc_clear_schedule(void);
+
+#endif /* TSCHRDC_H */
@@ -62,6 +62,17 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_MAX_NEIGHBORS > 254
+#error NBR_TABLE_MAX_NEIGHBORS must be at most 254
+#endif
+#if (NBR_TABLE_HASH_SIZE & (NBR_TABLE_HASH_SIZE - 1)) != 0 || \
+    NBR_TABLE_HASH_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error NBR_TABLE_HASH_SIZE must be a power of two larger than NBR_TABLE_MAX_NEIGHBORS
+#endif
+/* Open addressing hash table indexing the keys by link-layer address,
+ * with linear probing. A slot holds the neighbor index + 1, or 0 if empty. */
+static uint8_t lladdr_hash[NBR_TABLE_HASH_SIZE];
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -105,22 +116,78 @@ key_from_item(nbr_table_t *table, nbr_table_item_t *item)
   return key_from_index(index_from_item(table, item));
 }
 /*---------------------------------------------------------------------------*/
+/* Get the first hash table slot to probe for a link-layer address */
+static unsigned
+hash_slot(const rimeaddr_t *lladdr)
+{
+  unsigned h = 0;
+  int i;
+  for(i = 0; i < RIMEADDR_SIZE; i++) {
+    h = h * 31 + lladdr->u8[i];
+  }
+  return h & (NBR_TABLE_HASH_SIZE - 1);
+}
+/*---------------------------------------------------------------------------*/
+/* Index the key of a neighbor in the hash table */
+static void
+hash_insert(int index)
+{
+  unsigned i = hash_slot(&key_from_index(index)->lladdr);
+  while(lladdr_hash[i] != 0) {
+    i = (i + 1) & (NBR_TABLE_HASH_SIZE - 1);
+  }
+  lladdr_hash[i] = index + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove the key of a neighbor from the hash table */
+static void
+hash_remove(int index)
+{
+  unsigned i, j, k;
+
+  i = hash_slot(&key_from_index(index)->lladdr);
+  while(lladdr_hash[i] != index + 1) {
+    if(lladdr_hash[i] == 0) {
+      return;
+    }
+    i = (i + 1) & (NBR_TABLE_HASH_SIZE - 1);
+  }
+
+  /* Move back the following entries of the probe sequence, so that no
+   * entry is separated from its home slot by an empty slot. */
+  j = i;
+  while(1) {
+    j = (j + 1) & (NBR_TABLE_HASH_SIZE - 1);
+    if(lladdr_hash[j] == 0) {
+      break;
+    }
+    k = hash_slot(&key_from_index(lladdr_hash[j] - 1)->lladdr);
+    /* Move the entry unless its home slot k is cyclically in ]i, j] */
+    if(i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+      continue;
+    }
+    lladdr_hash[i] = lladdr_hash[j];
+    i = j;
+  }
+  lladdr_hash[i] = 0;
+}
+/*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const rimeaddr_t *lladdr)
 {
-  nbr_table_key_t *key;
+  unsigned i;
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by rimeaddr_null. */
   if(lladdr == NULL) {
     lladdr = &rimeaddr_null;
   }
-  key = list_head(nbr_table_keys);
-  while(key != NULL) {
-    if(lladdr && rimeaddr_cmp(lladdr, &key->lladdr)) {
-      return index_from_key(key);
+  i = hash_slot(lladdr);
+  while(lladdr_hash[i] != 0) {
+    if(rimeaddr_cmp(lladdr, &key_from_index(lladdr_hash[i] - 1)->lladdr)) {
+      return lladdr_hash[i] - 1;
     }
-    key = list_item_next(key);
+    i = (i + 1) & (NBR_TABLE_HASH_SIZE - 1);
   }
   return -1;
 }
@@ -216,8 +283,9 @@ nbr_table_allocate(void)
       }
       /* Empty used map */
       used_map[index_from_key(least_used_key)] = 0;
-      /* Remove neighbor from list */
+      /* Remove neighbor from list and hash table */
       list_remove(nbr_table_keys, least_used_key);
+      hash_remove(index_from_key(least_used_key));
       /* Return associated key */
       return least_used_key;
     }
@@ -298,6 +366,7 @@ nbr_table_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
 
     /* Set link-layer address */
     rimeaddr_copy(&key->lladdr, lladdr);
+    hash_insert(index);
   }
 
   /* Get item in the current table */
@@ -310,6 +379,64 @@ nbr_table_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
   return item;
 }
 /*---------------------------------------------------------------------------*/
+/* Change the link-layer address of a neighbor. If no neighbor has the
+ * new address yet, the key of the neighbor changes in all tables.
+ * Otherwise, the item moves to the existing key, and the other tables
+ * keep their items at the old address. Returns the item, at its new
+ * place if it moved, or NULL if the table already has an item with
+ * the new address */
+nbr_table_item_t *
+nbr_table_update_lladdr(nbr_table_t *table, nbr_table_item_t *item,
+                        const rimeaddr_t *lladdr)
+{
+  int index, new_index;
+  nbr_table_key_t *key;
+  nbr_table_item_t *new_item;
+
+  if(lladdr == NULL) {
+    lladdr = &rimeaddr_null;
+  }
+
+  index = index_from_item(table, item);
+  if(index == -1) {
+    return NULL;
+  }
+  key = key_from_index(index);
+  if(rimeaddr_cmp(&key->lladdr, lladdr)) {
+    return item;
+  }
+
+  new_index = index_from_lladdr(lladdr);
+  if(new_index == -1) {
+    /* The hash table is indexed by the address, so the key must be
+       removed before the address is changed, and inserted again after */
+    hash_remove(index);
+    rimeaddr_copy(&key->lladdr, lladdr);
+    hash_insert(index);
+    return item;
+  }
+
+  /* The address is the key of another neighbor, e.g. a neighbor that
+     is known to another table */
+  new_item = item_from_index(table, new_index);
+  if(nbr_get_bit(used_map, table, new_item)) {
+    return NULL;
+  }
+  memcpy(new_item, item, table->item_size);
+  nbr_set_bit(used_map, table, new_item, 1);
+  nbr_set_bit(locked_map, table, new_item, nbr_get_bit(locked_map, table, item));
+  nbr_set_bit(used_map, table, item, 0);
+  nbr_set_bit(locked_map, table, item, 0);
+
+  /* Free the old key if no table uses it anymore */
+  if(used_map[index] == 0 && locked_map[index] == 0) {
+    list_remove(nbr_table_keys, key);
+    hash_remove(index);
+    memb_free(&neighbor_addr_mem, key);
+  }
+  return new_item;
+}
+/*---------------------------------------------------------------------------*/
 /* Get an item from its link-layer address */
 void *
 nbr_table_get_from_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr)
@@ -46,6 +46,25 @@
 #define NBR_TABLE_MAX_NEIGHBORS 8
 #endif /* NBR_TABLE_CONF_MAX_NEIGHBORS */
 
+/* Size of the hash table indexing the neighbors by link-layer address.
+ * Must be a power of two, larger than NBR_TABLE_MAX_NEIGHBORS. By default,
+ * the table is kept at most half full. */
+#ifdef NBR_TABLE_CONF_HASH_SIZE
+#define NBR_TABLE_HASH_SIZE NBR_TABLE_CONF_HASH_SIZE
+#elif NBR_TABLE_MAX_NEIGHBORS <= 8
+#define NBR_TABLE_HASH_SIZE 16
+#elif NBR_TABLE_MAX_NEIGHBORS <= 16
+#define NBR_TABLE_HASH_SIZE 32
+#elif NBR_TABLE_MAX_NEIGHBORS <= 32
+#define NBR_TABLE_HASH_SIZE 64
+#elif NBR_TABLE_MAX_NEIGHBORS <= 64
+#define NBR_TABLE_HASH_SIZE 128
+#elif NBR_TABLE_MAX_NEIGHBORS <= 128
+#define NBR_TABLE_HASH_SIZE 256
+#else
+#define NBR_TABLE_HASH_SIZE 512
+#endif /* NBR_TABLE_CONF_HASH_SIZE */
+
 /* An item in a neighbor table */
 typedef void nbr_table_item_t;
 
@@ -86,6 +105,7 @@ nbr_table_item_t *nbr_table_next(nbr_table_t *table, nbr_table_item_t *item);
 /** @{ */
 nbr_table_item_t *nbr_table_add_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr);
 nbr_table_item_t *nbr_table_get_from_lladdr(nbr_table_t *table, const rimeaddr_t *lladdr);
+nbr_table_item_t *nbr_table_update_lladdr(nbr_table_t *table, nbr_table_item_t *item, const rimeaddr_t *lladdr);
 /** @} */
 
 /** \name Neighbor tables: set flags (unused, locked, unlocked) */
@@ -97,6 +117,8 @@ int nbr_table_unlock(nbr_table_t *table, nbr_table_item_t *item);
 
 /** \name Neighbor tables: address manipulation */
 /** @{ */
+/* The neighbors are indexed by their address: it must not be written
+   through the returned pointer, but changed with nbr_table_update_lladdr() */
 rimeaddr_t *nbr_table_get_lladdr(nbr_table_t *table, nbr_table_item_t *item);
 /** @} */
 
@@ -50,6 +50,7 @@
 
 struct packetbuf_attr packetbuf_attrs[PACKETBUF_NUM_ATTRS];
 struct packetbuf_addr packetbuf_addrs[PACKETBUF_NUM_ADDRS];
+packetbuf_attr_bitmap_t packetbuf_attrs_set;
 
 
 static uint16_t buflen, bufptr;
@@ -256,13 +257,22 @@ packetbuf_totlen(void)
 void
 packetbuf_attr_clear(void)
 {
-  int i;
-  for(i = 0; i < PACKETBUF_NUM_ATTRS; ++i) {
-    packetbuf_attrs[i].val = 0;
-  }
-  for(i = 0; i < PACKETBUF_NUM_ADDRS; ++i) {
-    rimeaddr_copy(&packetbuf_addrs[i].addr, &rimeaddr_null);
+  packetbuf_attr_bitmap_t set;
+  uint8_t type;
+
+  /* Only the attributes that are set can be non-zero. */
+  set = packetbuf_attrs_set;
+  for(type = 0; set != 0; ++type, set >>= 1) {
+    if(set & 1) {
+      if(PACKETBUF_IS_ADDR(type)) {
+        rimeaddr_copy(&packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr,
+                      &rimeaddr_null);
+      } else {
+        packetbuf_attrs[type].val = 0;
+      }
+    }
   }
+  packetbuf_attrs_set = 0;
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -277,8 +287,193 @@ void
 packetbuf_attr_copyfrom(struct packetbuf_attr *attrs,
 		      struct packetbuf_addr *addrs)
 {
+  int i;
+
   memcpy(packetbuf_attrs, attrs, sizeof(packetbuf_attrs));
   memcpy(packetbuf_addrs, addrs, sizeof(packetbuf_addrs));
+
+  packetbuf_attrs_set = 0;
+  for(i = 0; i < PACKETBUF_NUM_ATTRS; ++i) {
+    if(packetbuf_attrs[i].val != 0) {
+      packetbuf_attrs_set |= PACKETBUF_ATTR_BITMAP(i);
+    }
+  }
+  for(i = 0; i < PACKETBUF_NUM_ADDRS; ++i) {
+    if(!rimeaddr_cmp(&packetbuf_addrs[i].addr, &rimeaddr_null)) {
+      packetbuf_attrs_set |= PACKETBUF_ATTR_BITMAP(PACKETBUF_ADDR_FIRST + i);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_attr_pack(struct packetbuf_attrs_packed *p)
+{
+  packetbuf_attr_bitmap_t set;
+  uint8_t type, nattrs, naddrs;
+  int fits;
+
+  nattrs = naddrs = 0;
+  fits = 1;
+  p->set = 0;
+  set = packetbuf_attrs_set;
+  for(type = 0; set != 0; ++type, set >>= 1) {
+    if(set & 1) {
+      if(PACKETBUF_IS_ADDR(type)) {
+        if(naddrs == PACKETBUF_PACKED_NUM_ADDRS) {
+          fits = 0;
+          continue;
+        }
+        rimeaddr_copy(&p->addrs[naddrs++],
+                      &packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr);
+      } else {
+        if(nattrs == PACKETBUF_PACKED_NUM_ATTRS) {
+          fits = 0;
+          continue;
+        }
+        p->vals[nattrs++] = packetbuf_attrs[type].val;
+      }
+      p->set |= PACKETBUF_ATTR_BITMAP(type);
+    }
+  }
+  return fits;
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_attr_unpack(const struct packetbuf_attrs_packed *p)
+{
+  packetbuf_attr_bitmap_t set;
+  uint8_t type, nattrs, naddrs;
+
+  packetbuf_attr_clear();
+
+  nattrs = naddrs = 0;
+  set = p->set;
+  for(type = 0; set != 0; ++type, set >>= 1) {
+    if(set & 1) {
+      if(PACKETBUF_IS_ADDR(type)) {
+        rimeaddr_copy(&packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr,
+                      &p->addrs[naddrs++]);
+      } else {
+        packetbuf_attrs[type].val = p->vals[nattrs++];
+      }
+    }
+  }
+  packetbuf_attrs_set = p->set;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+bitcount(packetbuf_attr_bitmap_t map)
+{
+  uint8_t n;
+
+  for(n = 0; map != 0; ++n) {
+    map &= map - 1;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+packetbuf_attr_t
+packetbuf_attr_packed_attr(const struct packetbuf_attrs_packed *p,
+                           uint8_t type)
+{
+  packetbuf_attr_bitmap_t below;
+
+  if((p->set & PACKETBUF_ATTR_BITMAP(type)) == 0) {
+    return 0;
+  }
+  below = p->set & (PACKETBUF_ATTR_BITMAP(type) - 1) & ~PACKETBUF_ADDR_BITMAP;
+  return p->vals[bitcount(below)];
+}
+/*---------------------------------------------------------------------------*/
+const rimeaddr_t *
+packetbuf_attr_packed_addr(const struct packetbuf_attrs_packed *p,
+                           uint8_t type)
+{
+  packetbuf_attr_bitmap_t below;
+
+  if((p->set & PACKETBUF_ATTR_BITMAP(type)) == 0) {
+    return &rimeaddr_null;
+  }
+  below = p->set & (PACKETBUF_ATTR_BITMAP(type) - 1) & PACKETBUF_ADDR_BITMAP;
+  return &p->addrs[bitcount(below)];
+}
+/*---------------------------------------------------------------------------*/
+static void
+attr_copy_set(packetbuf_attr_bitmap_t set,
+              struct packetbuf_attr *to_attrs, struct packetbuf_addr *to_addrs,
+              const struct packetbuf_attr *from_attrs,
+              const struct packetbuf_addr *from_addrs)
+{
+  uint8_t type;
+
+  for(type = 0; set != 0; ++type, set >>= 1) {
+    if(set & 1) {
+      if(PACKETBUF_IS_ADDR(type)) {
+        rimeaddr_copy(&to_addrs[type - PACKETBUF_ADDR_FIRST].addr,
+                      &from_addrs[type - PACKETBUF_ADDR_FIRST].addr);
+      } else {
+        to_attrs[type].val = from_attrs[type].val;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_ctx_save(struct packetbuf_ctx *ctx)
+{
+  uint8_t *buf = (uint8_t *)ctx->buf_aligned;
+
+  ctx->buflen = buflen;
+  ctx->bufptr = bufptr;
+  ctx->hdrptr = hdrptr;
+
+  /* Copy only the parts of the buffer that are in use: the allocated
+     header, which ends at PACKETBUF_HDR_SIZE, and the data, which
+     starts bufptr bytes after it. */
+  memcpy(&buf[hdrptr], &packetbuf[hdrptr], PACKETBUF_HDR_SIZE - hdrptr);
+  if(packetbuf_is_reference()) {
+    ctx->refptr = packetbufptr;
+  } else {
+    ctx->refptr = NULL;
+    memcpy(&buf[PACKETBUF_HDR_SIZE + bufptr],
+           &packetbuf[PACKETBUF_HDR_SIZE + bufptr], buflen);
+  }
+  ctx->attrs_set = packetbuf_attrs_set;
+  attr_copy_set(packetbuf_attrs_set, ctx->attrs, ctx->addrs,
+                packetbuf_attrs, packetbuf_addrs);
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_ctx_restore(const struct packetbuf_ctx *ctx)
+{
+  const uint8_t *buf = (const uint8_t *)ctx->buf_aligned;
+
+  buflen = ctx->buflen;
+  bufptr = ctx->bufptr;
+  hdrptr = ctx->hdrptr;
+
+  memcpy(&packetbuf[hdrptr], &buf[hdrptr], PACKETBUF_HDR_SIZE - hdrptr);
+  if(ctx->refptr != NULL) {
+    packetbufptr = ctx->refptr;
+  } else {
+    packetbufptr = &packetbuf[PACKETBUF_HDR_SIZE];
+    memcpy(&packetbuf[PACKETBUF_HDR_SIZE + bufptr],
+           &buf[PACKETBUF_HDR_SIZE + bufptr], buflen);
+  }
+  packetbuf_attr_clear();
+  packetbuf_attrs_set = ctx->attrs_set;
+  attr_copy_set(ctx->attrs_set, packetbuf_attrs, packetbuf_addrs,
+                ctx->attrs, ctx->addrs);
+}
+/*---------------------------------------------------------------------------*/
+void
+packetbuf_ctx_swap(struct packetbuf_ctx *ctx)
+{
+  static struct packetbuf_ctx tmp;
+
+  packetbuf_ctx_save(&tmp);
+  packetbuf_ctx_restore(ctx);
+  memcpy(ctx, &tmp, sizeof(tmp));
 }
 /*---------------------------------------------------------------------------*/
 #if !PACKETBUF_CONF_ATTRS_INLINE
@@ -287,6 +482,11 @@ packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val)
 {
 /*   packetbuf_attrs[type].type = type; */
   packetbuf_attrs[type].val = val;
+  if(val != 0) {
+    packetbuf_attrs_set |= PACKETBUF_ATTR_BITMAP(type);
+  } else {
+    packetbuf_attrs_set &= ~PACKETBUF_ATTR_BITMAP(type);
+  }
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -301,6 +501,7 @@ packetbuf_set_addr(uint8_t type, const rimeaddr_t *addr)
 {
 /*   packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].type = type; */
   rimeaddr_copy(&packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr, addr);
+  packetbuf_attrs_set |= PACKETBUF_ATTR_BITMAP(type);
   return 1;
 }
 /*---------------------------------------------------------------------------*/
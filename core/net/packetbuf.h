@@ -326,12 +326,21 @@ struct packetbuf_addr {
   rimeaddr_t addr;
 };
 
+/* One bit per attribute and address type, telling if it is set. */
+typedef uint32_t packetbuf_attr_bitmap_t;
+
 #define PACKETBUF_ATTR_PACKET_TYPE_DATA      0
 #define PACKETBUF_ATTR_PACKET_TYPE_ACK       1
 #define PACKETBUF_ATTR_PACKET_TYPE_STREAM    2
 #define PACKETBUF_ATTR_PACKET_TYPE_STREAM_END 3
 #define PACKETBUF_ATTR_PACKET_TYPE_TIMESTAMP 4
 
+/* Traffic classes for the MAC layer to schedule by. A packet without
+   one gets a class chosen by the MAC layer. */
+#define PACKETBUF_ATTR_TRAFFIC_CLASS_DEFAULT 0
+#define PACKETBUF_ATTR_TRAFFIC_CLASS_CONTROL 1
+#define PACKETBUF_ATTR_TRAFFIC_CLASS_DATA    2
+
 enum {
   PACKETBUF_ATTR_NONE,
 
@@ -347,6 +356,7 @@ enum {
   PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
   PACKETBUF_ATTR_MAC_SEQNO,
   PACKETBUF_ATTR_MAC_ACK,
+  PACKETBUF_ATTR_TRAFFIC_CLASS,
 
   /* Scope 1 attributes: used between two neighbors only. */
   PACKETBUF_ATTR_RELIABLE,
@@ -364,7 +374,9 @@ enum {
   PACKETBUF_ATTR_EPACKET_TYPE,
   PACKETBUF_ATTR_ERELIABLE,
 
- /* These must be last */
+ /* These must be last. PACKETBUF_NUM_ADDRS must match the number
+    of address types, and the total number of types must fit in a
+    packetbuf_attr_bitmap_t. */
   PACKETBUF_ADDR_SENDER,
   PACKETBUF_ADDR_RECEIVER,
   PACKETBUF_ADDR_ESENDER,
@@ -376,9 +388,13 @@ enum {
   PACKETBUF_ATTR_MAX
 };
 
-#define PACKETBUF_NUM_ADDRS 4
+#define PACKETBUF_NUM_ADDRS 7
 #define PACKETBUF_NUM_ATTRS (PACKETBUF_ATTR_MAX - PACKETBUF_NUM_ADDRS)
-#define PACKETBUF_ADDR_FIRST PACKETBUF_ADDR_NOW
+#define PACKETBUF_ADDR_FIRST PACKETBUF_ADDR_SENDER
+
+#define PACKETBUF_ATTR_BITMAP(type) ((packetbuf_attr_bitmap_t)1 << (type))
+#define PACKETBUF_ADDR_BITMAP \
+  ((PACKETBUF_ATTR_BITMAP(PACKETBUF_NUM_ADDRS) - 1) << PACKETBUF_ADDR_FIRST)
 
 #define PACKETBUF_IS_ADDR(type) ((type) >= PACKETBUF_ADDR_FIRST)
 
@@ -386,6 +402,7 @@ enum {
 
 extern struct packetbuf_attr packetbuf_attrs[];
 extern struct packetbuf_addr packetbuf_addrs[];
+extern packetbuf_attr_bitmap_t packetbuf_attrs_set;
 
 static int               packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val);
 static packetbuf_attr_t    packetbuf_attr(uint8_t type);
@@ -397,6 +414,11 @@ packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val)
 {
 /*   packetbuf_attrs[type].type = type; */
   packetbuf_attrs[type].val = val;
+  if(val != 0) {
+    packetbuf_attrs_set |= PACKETBUF_ATTR_BITMAP(type);
+  } else {
+    packetbuf_attrs_set &= ~PACKETBUF_ATTR_BITMAP(type);
+  }
   return 1;
 }
 static inline packetbuf_attr_t
@@ -410,6 +432,7 @@ packetbuf_set_addr(uint8_t type, const rimeaddr_t *addr)
 {
 /*   packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].type = type; */
   rimeaddr_copy(&packetbuf_addrs[type - PACKETBUF_ADDR_FIRST].addr, addr);
+  packetbuf_attrs_set |= PACKETBUF_ATTR_BITMAP(type);
   return 1;
 }
 
@@ -432,6 +455,143 @@ void              packetbuf_attr_copyto(struct packetbuf_attr *attrs,
 void              packetbuf_attr_copyfrom(struct packetbuf_attr *attrs,
 					struct packetbuf_addr *addrs);
 
+/**
+ * \brief      The maximum number of attributes in a packed attribute set
+ *
+ *             By default a packed attribute set can hold every
+ *             attribute. Platforms that know how many attributes
+ *             their stack sets on a frame may lower this to save RAM
+ *             in every queuebuf.
+ */
+#ifdef PACKETBUF_CONF_PACKED_NUM_ATTRS
+#define PACKETBUF_PACKED_NUM_ATTRS PACKETBUF_CONF_PACKED_NUM_ATTRS
+#else
+#define PACKETBUF_PACKED_NUM_ATTRS PACKETBUF_NUM_ATTRS
+#endif
+
+/**
+ * \brief      The maximum number of addresses in a packed attribute set
+ */
+#ifdef PACKETBUF_CONF_PACKED_NUM_ADDRS
+#define PACKETBUF_PACKED_NUM_ADDRS PACKETBUF_CONF_PACKED_NUM_ADDRS
+#else
+#define PACKETBUF_PACKED_NUM_ADDRS PACKETBUF_NUM_ADDRS
+#endif
+
+/**
+ * \brief      A packed copy of the packetbuf attributes
+ *
+ *             A packed attribute set stores only the attributes and
+ *             addresses that are set, in increasing type order,
+ *             together with a bitmap of the set types. Copying
+ *             attributes to and from a packed set only touches the
+ *             set attributes.
+ */
+struct packetbuf_attrs_packed {
+  packetbuf_attr_bitmap_t set;
+  packetbuf_attr_t vals[PACKETBUF_PACKED_NUM_ATTRS];
+  rimeaddr_t addrs[PACKETBUF_PACKED_NUM_ADDRS];
+};
+
+/**
+ * \brief      Pack the packetbuf attributes
+ * \param p    A pointer to the packed attribute set to fill in
+ * \retval     Non-zero if all set attributes fit, zero otherwise
+ *
+ *             If more attributes or addresses are set than the packed
+ *             set can hold, the ones that did not fit are left out of
+ *             the packed set and the function returns zero.
+ */
+int               packetbuf_attr_pack(struct packetbuf_attrs_packed *p);
+
+/**
+ * \brief      Replace the packetbuf attributes with a packed attribute set
+ * \param p    A pointer to the packed attribute set
+ */
+void              packetbuf_attr_unpack(const struct packetbuf_attrs_packed *p);
+
+/**
+ * \brief      Get an attribute from a packed attribute set
+ * \param p    A pointer to the packed attribute set
+ * \param type The attribute type
+ * \return     The value of the attribute, or zero if it is not set
+ */
+packetbuf_attr_t  packetbuf_attr_packed_attr(const struct packetbuf_attrs_packed *p,
+                                             uint8_t type);
+
+/**
+ * \brief      Get an address from a packed attribute set
+ * \param p    A pointer to the packed attribute set
+ * \param type The address type
+ * \return     The address, or rimeaddr_null if it is not set
+ */
+const rimeaddr_t *packetbuf_attr_packed_addr(const struct packetbuf_attrs_packed *p,
+                                             uint8_t type);
+
+/* Packet buffer context stuff below: */
+
+/**
+ * \brief      A saved packetbuf context
+ *
+ *             A packetbuf context holds a complete copy of the
+ *             packetbuf state: the header and data portions, the
+ *             internal pointers and the packet attributes. It lets a
+ *             MAC or RDC driver stage an outbound frame, use the
+ *             packetbuf for something else (e.g., receiving a frame
+ *             or building a strobe or an ACK), and later switch back
+ *             to the staged frame.
+ *
+ *             The contents of the structure are private to the
+ *             packetbuf module and should not be accessed directly.
+ */
+struct packetbuf_ctx {
+  uint16_t buflen, bufptr;
+  uint8_t hdrptr;
+  uint8_t *refptr;
+  packetbuf_attr_bitmap_t attrs_set;
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  uint16_t buf_aligned[(PACKETBUF_SIZE + PACKETBUF_HDR_SIZE) / 2 + 1];
+};
+
+/**
+ * \brief      Save the packetbuf into a context
+ * \param ctx  A pointer to the context that receives the packetbuf state
+ *
+ *             This function copies the current packetbuf state into
+ *             a context. Only the parts of the buffer that are in use
+ *             (the allocated header and the data) are copied. If the
+ *             packetbuf references external data, only the reference
+ *             is saved. The packetbuf itself is left unchanged.
+ *
+ */
+void packetbuf_ctx_save(struct packetbuf_ctx *ctx);
+
+/**
+ * \brief      Restore the packetbuf from a context
+ * \param ctx  A pointer to a context previously filled by packetbuf_ctx_save()
+ *
+ *             This function replaces the current packetbuf state with
+ *             the state stored in a context. The context itself is
+ *             left unchanged, so it may be restored again later.
+ *
+ */
+void packetbuf_ctx_restore(const struct packetbuf_ctx *ctx);
+
+/**
+ * \brief      Exchange the packetbuf with a context
+ * \param ctx  A pointer to a context previously filled by packetbuf_ctx_save()
+ *
+ *             This function swaps the current packetbuf state with
+ *             the state stored in a context: afterwards the packetbuf
+ *             holds the packet from the context, and the context holds
+ *             the packet that was in the packetbuf. It is typically
+ *             used to temporarily switch from a received frame to a
+ *             staged outbound frame and back again.
+ *
+ */
+void packetbuf_ctx_swap(struct packetbuf_ctx *ctx);
+
 #define PACKETBUF_ATTRIBUTES(...) { __VA_ARGS__ PACKETBUF_ATTR_LAST }
 #define PACKETBUF_ATTR_LAST { PACKETBUF_ATTR_NONE, 0 }
 
@@ -79,8 +79,7 @@ struct queuebuf {
 struct queuebuf_data {
   uint16_t len;
   uint8_t data[PACKETBUF_SIZE];
-  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
-  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  struct packetbuf_attrs_packed attrs;
 };
 
 struct queuebuf_ref {
@@ -362,7 +361,23 @@ queuebuf_new_from_packetbuf(void)
 #endif
 
       buframptr->len = packetbuf_copyto(buframptr->data);
-      packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+      if(!packetbuf_attr_pack(&buframptr->attrs)) {
+        PRINTF("queuebuf_new_from_packetbuf: too many packet attributes\n");
+#if WITH_SWAP
+        if(buf->location == IN_RAM) {
+          memb_free(&buframmem, buf->ram_ptr);
+        } else {
+          tmpdata_qbuf = NULL;
+        }
+#else
+        memb_free(&buframmem, buf->ram_ptr);
+#endif
+#if QUEUEBUF_DEBUG
+        list_remove(queuebuf_list, buf);
+#endif /* QUEUEBUF_DEBUG */
+        memb_free(&bufmem, buf);
+        return NULL;
+      }
 
 #if WITH_SWAP
       if(buf->location == IN_CFS) {
@@ -396,7 +411,9 @@ void
 queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
-  packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+  if(!packetbuf_attr_pack(&buframptr->attrs)) {
+    PRINTF("queuebuf_update_attr_from_packetbuf: too many packet attributes\n");
+  }
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
     queuebuf_flush_tmpdata();
@@ -440,7 +457,7 @@ queuebuf_to_packetbuf(struct queuebuf *b)
   if(memb_inmemb(&bufmem, b)) {
     struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
     packetbuf_copyfrom(buframptr->data, buframptr->len);
-    packetbuf_attr_copyfrom(buframptr->attrs, buframptr->addrs);
+    packetbuf_attr_unpack(&buframptr->attrs);
   } else if(memb_inmemb(&refbufmem, b)) {
     r = (struct queuebuf_ref *)b;
     packetbuf_clear();
@@ -472,18 +489,18 @@ queuebuf_datalen(struct queuebuf *b)
   return buframptr->len;
 }
 /*---------------------------------------------------------------------------*/
-rimeaddr_t *
+const rimeaddr_t *
 queuebuf_addr(struct queuebuf *b, uint8_t type)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
-  return &buframptr->addrs[type - PACKETBUF_ADDR_FIRST].addr;
+  return packetbuf_attr_packed_addr(&buframptr->attrs, type);
 }
 /*---------------------------------------------------------------------------*/
 packetbuf_attr_t
 queuebuf_attr(struct queuebuf *b, uint8_t type)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
-  return buframptr->attrs[type].val;
+  return packetbuf_attr_packed_attr(&buframptr->attrs, type);
 }
 /*---------------------------------------------------------------------------*/
 void
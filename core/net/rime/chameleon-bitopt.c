@@ -53,10 +53,51 @@
 #define CHAMELEON_WITH_MAC_LINK_ADDRESSES 0
 #endif /* !CHAMELEON_CONF_WITH_MAC_LINK_ADDRESSES */
 
+/* The number of attribute lists whose layout is compiled into a
+   template when a channel sets its attributes, and the maximum number
+   of attributes in a template. A template holds the bit position of
+   each attribute, so that the headers are packed and unpacked without
+   walking the attribute list, and the byte aligned attributes are
+   copied as bytes. Attribute lists that do not fit in the templates
+   are packed as before. */
+#ifdef CHAMELEON_CONF_TEMPLATES
+#define CHAMELEON_TEMPLATES CHAMELEON_CONF_TEMPLATES
+#else /* CHAMELEON_CONF_TEMPLATES */
+#define CHAMELEON_TEMPLATES 0
+#endif /* CHAMELEON_CONF_TEMPLATES */
+
+#ifdef CHAMELEON_CONF_TEMPLATE_ATTRS
+#define CHAMELEON_TEMPLATE_ATTRS CHAMELEON_CONF_TEMPLATE_ATTRS
+#else /* CHAMELEON_CONF_TEMPLATE_ATTRS */
+#define CHAMELEON_TEMPLATE_ATTRS 12
+#endif /* CHAMELEON_CONF_TEMPLATE_ATTRS */
+
 struct bitopt_hdr {
   uint8_t channel[2];
 };
 
+#if CHAMELEON_TEMPLATES
+struct template_attr {
+  uint8_t type;
+  uint8_t len;
+  uint8_t bitptr;
+};
+
+struct template {
+  const struct packetbuf_attrlist *attrlist;
+  uint8_t num_attrs;
+  /* Non-zero if all attributes are byte aligned, so that every byte
+     of the header is written and need not be cleared first. */
+  uint8_t aligned;
+  struct template_attr attrs[CHAMELEON_TEMPLATE_ATTRS];
+};
+
+static struct template templates[CHAMELEON_TEMPLATES];
+static uint8_t num_templates;
+
+#define IS_BYTE_ALIGNED(bitptr, len) ((((bitptr) | (len)) & 7) == 0)
+#endif /* CHAMELEON_TEMPLATES */
+
 static const uint8_t bitmask[9] = { 0x00, 0x80, 0xc0, 0xe0, 0xf0,
 				 0xf8, 0xfc, 0xfe, 0xff };
 
@@ -118,10 +159,70 @@ get_bits(uint8_t *to, uint8_t *from, int bitpos, int vallen)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if CHAMELEON_TEMPLATES
+static const struct template *
+lookup_template(const struct packetbuf_attrlist *attrlist)
+{
+  int i;
+
+  for(i = 0; i < num_templates; ++i) {
+    if(templates[i].attrlist == attrlist) {
+      return &templates[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+compile_template(const struct packetbuf_attrlist *attrlist)
+{
+  const struct packetbuf_attrlist *a;
+  struct template *t;
+  struct template_attr *ta;
+  int bitptr;
+
+  if(num_templates == CHAMELEON_TEMPLATES || lookup_template(attrlist)) {
+    return;
+  }
+  t = &templates[num_templates];
+  t->num_attrs = 0;
+  t->aligned = 1;
+  bitptr = 0;
+  for(a = attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
+#if CHAMELEON_WITH_MAC_LINK_ADDRESSES
+    if(a->type == PACKETBUF_ADDR_SENDER ||
+       a->type == PACKETBUF_ADDR_RECEIVER) {
+      /* Let the link layer handle sender and receiver */
+      continue;
+    }
+#endif /* CHAMELEON_WITH_MAC_LINK_ADDRESSES */
+    if(t->num_attrs == CHAMELEON_TEMPLATE_ATTRS || bitptr > 0xff) {
+      PRINTF("chameleon-bitopt: attribute list too long for a template\n");
+      return;
+    }
+    ta = &t->attrs[t->num_attrs++];
+    ta->type = a->type;
+    ta->len = a->len;
+    ta->bitptr = bitptr;
+    if(!IS_BYTE_ALIGNED(bitptr, a->len)) {
+      t->aligned = 0;
+    }
+    bitptr += a->len;
+  }
+  t->attrlist = attrlist;
+  num_templates++;
+}
+#endif /* CHAMELEON_TEMPLATES */
+/*---------------------------------------------------------------------------*/
 static int
 header_size(const struct packetbuf_attrlist *a)
 {
   int size, len;
+
+#if CHAMELEON_TEMPLATES
+  /* The channel sets its attributes: compile their layout. */
+  compile_template(a);
+#endif /* CHAMELEON_TEMPLATES */
   
   /* Compute the total size of the final header by summing the size of
      all attributes that are used on this channel. */
@@ -238,6 +339,12 @@ pack_header(struct channel *c)
   int byteptr, bitptr, len;
   uint8_t *hdrptr;
   struct bitopt_hdr *hdr;
+#if CHAMELEON_TEMPLATES
+  const struct template *t;
+  const struct template_attr *ta;
+  packetbuf_attr_t val;
+  uint8_t *src;
+#endif /* CHAMELEON_TEMPLATES */
   
   /* Compute the total size of the final header by summing the size of
      all attributes that are used on this channel. */
@@ -252,6 +359,30 @@ pack_header(struct channel *c)
   hdr->channel[1] = (c->channelno >> 8) & 0xff;
 
   hdrptr = ((uint8_t *)packetbuf_hdrptr()) + sizeof(struct bitopt_hdr);
+
+#if CHAMELEON_TEMPLATES
+  t = lookup_template(c->attrlist);
+  if(t != NULL) {
+    if(!t->aligned) {
+      memset(hdrptr, 0, hdrbytesize);
+    }
+    for(ta = t->attrs; ta < &t->attrs[t->num_attrs]; ++ta) {
+      if(PACKETBUF_IS_ADDR(ta->type)) {
+        src = (uint8_t *)packetbuf_addr(ta->type);
+      } else {
+        val = packetbuf_attr(ta->type);
+        src = (uint8_t *)&val;
+      }
+      if(IS_BYTE_ALIGNED(ta->bitptr, ta->len)) {
+        memcpy(&hdrptr[ta->bitptr / 8], src, ta->len / 8);
+      } else {
+        set_bits(&hdrptr[ta->bitptr / 8], ta->bitptr & 7, src, ta->len);
+      }
+    }
+    return 1; /* Send out packet */
+  }
+#endif /* CHAMELEON_TEMPLATES */
+
   memset(hdrptr, 0, hdrbytesize);
   
   byteptr = bitptr = 0;
@@ -304,6 +435,12 @@ unpack_header(void)
   uint8_t *hdrptr;
   struct bitopt_hdr *hdr;
   struct channel *c;
+#if CHAMELEON_TEMPLATES
+  const struct template *t;
+  const struct template_attr *ta;
+  rimeaddr_t addr;
+  packetbuf_attr_t val;
+#endif /* CHAMELEON_TEMPLATES */
   
 
   /* The packet has a header that tells us what channel the packet is
@@ -326,6 +463,34 @@ unpack_header(void)
     PRINTF("chameleon-bitopt: too short packet\n");
     return NULL;
   }
+
+#if CHAMELEON_TEMPLATES
+  t = lookup_template(c->attrlist);
+  if(t != NULL) {
+    for(ta = t->attrs; ta < &t->attrs[t->num_attrs]; ++ta) {
+      if(PACKETBUF_IS_ADDR(ta->type)) {
+        if(IS_BYTE_ALIGNED(ta->bitptr, ta->len)) {
+          memcpy(&addr, &hdrptr[ta->bitptr / 8], ta->len / 8);
+        } else {
+          get_bits((uint8_t *)&addr, &hdrptr[ta->bitptr / 8],
+                   ta->bitptr & 7, ta->len);
+        }
+        packetbuf_set_addr(ta->type, &addr);
+      } else {
+        val = 0;
+        if(IS_BYTE_ALIGNED(ta->bitptr, ta->len)) {
+          memcpy(&val, &hdrptr[ta->bitptr / 8], ta->len / 8);
+        } else {
+          get_bits((uint8_t *)&val, &hdrptr[ta->bitptr / 8],
+                   ta->bitptr & 7, ta->len);
+        }
+        packetbuf_set_attr(ta->type, val);
+      }
+    }
+    return c;
+  }
+#endif /* CHAMELEON_TEMPLATES */
+
   byteptr = bitptr = 0;
   for(a = c->attrlist; a->type != PACKETBUF_ATTR_NONE; ++a) {
 #if CHAMELEON_WITH_MAC_LINK_ADDRESSES
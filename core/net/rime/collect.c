@@ -193,6 +193,7 @@ struct {
   uint32_t ttldrop;
   uint32_t ackdrop;
   uint32_t timedout;
+  uint32_t aggregated;
 } stats;
 
 /* Debug definition: draw routing tree in Cooja. */
@@ -569,6 +570,16 @@ send_queued_packet(struct collect_conn *c)
     return;
   }
 
+#if COLLECT_AGGREGATION
+  /* The first packet is held for a while, so that other packets may
+     be merged into it. The packet is sent when the timer expires. */
+  if(c->aggregator != NULL && !ctimer_expired(&c->aggregation_timer)) {
+    PRINTF("%d.%d: queue, holding packet for aggregation\n",
+           rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1]);
+    return;
+  }
+#endif /* COLLECT_AGGREGATION */
+
 
   /* Grab the first packet on the send queue. */
   i = packetqueue_first(&c->send_queue);
@@ -890,6 +901,171 @@ send_ack(struct collect_conn *tc, const rimeaddr_t *to, int flags)
   stats.acksent++;
 }
 /*---------------------------------------------------------------------------*/
+#if COLLECT_AGGREGATION
+/**
+ * This function tries to merge the data of the packet in the packet
+ * buffer into the last packet of the send queue, with the merge
+ * function of the aggregator of the connection. The packet we are
+ * currently sending cannot be changed, but the first packet of the
+ * queue can while it is held before its first transmission.
+ *
+ * The function returns 1 if the packet was merged, 0 if it was not
+ * and should be enqueued as usual, and -1 if it should be dropped.
+ * The packet buffer is only left untouched in the second case.
+ */
+static int
+aggregate_packetbuf(struct collect_conn *c, const uint8_t *data, int len)
+{
+  struct packetqueue_item *i, *last;
+  struct queuebuf *q;
+  uint8_t merged[COLLECT_AGGREGATION_MAX_DATALEN];
+  int qlen, mlen;
+
+  if(c->aggregator == NULL || len <= 0) {
+    return 0;
+  }
+
+  last = NULL;
+  for(i = list_head(*c->send_queue.list); i != NULL; i = list_item_next(i)) {
+    last = i;
+  }
+  if(last == NULL || last->buf == NULL ||
+     (last == packetqueue_first(&c->send_queue) &&
+      (c->sending || c->transmissions > 0))) {
+    return 0;
+  }
+
+  /* Dummy packets, without data, are never merged. */
+  qlen = queuebuf_datalen(last->buf) - sizeof(struct data_msg_hdr);
+  if(qlen <= 0 || qlen > COLLECT_AGGREGATION_MAX_DATALEN) {
+    return 0;
+  }
+  memcpy(merged, (uint8_t *)queuebuf_dataptr(last->buf) +
+         sizeof(struct data_msg_hdr), qlen);
+  mlen = c->aggregator->merge(merged, qlen, data, len,
+                              COLLECT_AGGREGATION_MAX_DATALEN);
+  if(mlen <= 0 || mlen > COLLECT_AGGREGATION_MAX_DATALEN) {
+    return 0;
+  }
+
+  /* Replace the queued packet with the merged one, which keeps its
+     attributes. */
+  queuebuf_to_packetbuf(last->buf);
+  memcpy((uint8_t *)packetbuf_dataptr() + sizeof(struct data_msg_hdr),
+         merged, mlen);
+  packetbuf_set_datalen(sizeof(struct data_msg_hdr) + mlen);
+  q = queuebuf_new_from_packetbuf();
+  if(q == NULL) {
+    PRINTF("%d.%d: could not merge packet: no queuebuf\n",
+           rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1]);
+    return -1;
+  }
+  queuebuf_free(last->buf);
+  last->buf = q;
+
+  PRINTF("%d.%d: merged %d bytes into queued packet, now %d bytes\n",
+         rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1], len, mlen);
+  stats.aggregated++;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+aggregation_timer_callback(void *ptr)
+{
+  send_queued_packet(ptr);
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * This function is called when a packet has been added to the send
+ * queue. If the queue was empty, the packet is held for the hold time
+ * of the connection before it is sent, to give other packets a chance
+ * to be merged into it. Packets queued behind another one are merged
+ * while they wait anyway.
+ */
+static void
+hold_for_aggregation(struct collect_conn *c)
+{
+  if(c->aggregator != NULL && c->aggregation_hold_time > 0 &&
+     !c->sending && packetqueue_len(&c->send_queue) == 1) {
+    ctimer_set(&c->aggregation_timer, c->aggregation_hold_time,
+               aggregation_timer_callback, c);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+merge_concat(uint8_t *data, int len,
+             const uint8_t *newdata, int newlen, int maxlen)
+{
+  if(len + newlen > maxlen) {
+    return 0;
+  }
+  memcpy(data + len, newdata, newlen);
+  return len + newlen;
+}
+/*---------------------------------------------------------------------------*/
+#define MERGE16_SUM 0
+#define MERGE16_MAX 1
+#define MERGE16_MIN 2
+static int
+merge16(uint8_t *data, int len, const uint8_t *newdata, int newlen, int op)
+{
+  uint16_t a, b;
+  int i;
+
+  if(len != newlen || (len & 1) != 0) {
+    return 0;
+  }
+  for(i = 0; i < len; i += 2) {
+    /* The data may not be aligned. */
+    memcpy(&a, data + i, sizeof(a));
+    memcpy(&b, newdata + i, sizeof(b));
+    if(op == MERGE16_SUM) {
+      a += b;
+    } else if((op == MERGE16_MAX && b > a) || (op == MERGE16_MIN && b < a)) {
+      a = b;
+    }
+    memcpy(data + i, &a, sizeof(a));
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static int
+merge_sum16(uint8_t *data, int len,
+            const uint8_t *newdata, int newlen, int maxlen)
+{
+  return merge16(data, len, newdata, newlen, MERGE16_SUM);
+}
+/*---------------------------------------------------------------------------*/
+static int
+merge_max16(uint8_t *data, int len,
+            const uint8_t *newdata, int newlen, int maxlen)
+{
+  return merge16(data, len, newdata, newlen, MERGE16_MAX);
+}
+/*---------------------------------------------------------------------------*/
+static int
+merge_min16(uint8_t *data, int len,
+            const uint8_t *newdata, int newlen, int maxlen)
+{
+  return merge16(data, len, newdata, newlen, MERGE16_MIN);
+}
+/*---------------------------------------------------------------------------*/
+const struct collect_aggregator collect_aggregator_concat = { merge_concat };
+const struct collect_aggregator collect_aggregator_sum16 = { merge_sum16 };
+const struct collect_aggregator collect_aggregator_max16 = { merge_max16 };
+const struct collect_aggregator collect_aggregator_min16 = { merge_min16 };
+#endif /* COLLECT_AGGREGATION */
+/*---------------------------------------------------------------------------*/
+static void
+add_recent_packet(struct collect_conn *tc, const rimeaddr_t *originator,
+                  uint8_t eseqno)
+{
+  recent_packets[recent_packet_ptr].eseqno = eseqno;
+  rimeaddr_copy(&recent_packets[recent_packet_ptr].originator, originator);
+  recent_packets[recent_packet_ptr].conn = tc;
+  recent_packet_ptr = (recent_packet_ptr + 1) % NUM_RECENT_PACKETS;
+}
+/*---------------------------------------------------------------------------*/
 static void
 add_packet_to_recent_packets(struct collect_conn *tc)
 {
@@ -898,12 +1074,8 @@ add_packet_to_recent_packets(struct collect_conn *tc)
      zero are keepalive or proactive link estimate probes, so we do
      not record them in our history. */
   if(packetbuf_datalen() > sizeof(struct data_msg_hdr)) {
-    recent_packets[recent_packet_ptr].eseqno =
-      packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID);
-    rimeaddr_copy(&recent_packets[recent_packet_ptr].originator,
-                  packetbuf_addr(PACKETBUF_ADDR_ESENDER));
-    recent_packets[recent_packet_ptr].conn = tc;
-    recent_packet_ptr = (recent_packet_ptr + 1) % NUM_RECENT_PACKETS;
+    add_recent_packet(tc, packetbuf_addr(PACKETBUF_ADDR_ESENDER),
+                      packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID));
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -1046,6 +1218,36 @@ node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
          memory problems. We first check the size of our sending queue
          to ensure that we always have entries for packets that
          are originated by this node. */
+#if COLLECT_AGGREGATION
+      /* Before that, we try to merge the packet into a queued one,
+         which does not take any queue entry. Merging overwrites the
+         packet buffer, so we first copy what we need to remember the
+         packet. */
+      if(tc->aggregator != NULL) {
+        rimeaddr_t originator;
+        uint8_t eseqno;
+        int merged;
+
+        rimeaddr_copy(&originator, packetbuf_addr(PACKETBUF_ADDR_ESENDER));
+        eseqno = packetbuf_attr(PACKETBUF_ATTR_EPACKET_ID);
+        merged = aggregate_packetbuf(tc,
+                                     (uint8_t *)packetbuf_dataptr() +
+                                     sizeof(struct data_msg_hdr),
+                                     packetbuf_datalen() -
+                                     sizeof(struct data_msg_hdr));
+        if(merged != 0) {
+          if(merged > 0) {
+            add_recent_packet(tc, &originator, eseqno);
+            send_ack(tc, &ack_to, ackflags);
+          } else {
+            send_ack(tc, &ack_to,
+                     ackflags | ACK_FLAGS_DROPPED | ACK_FLAGS_CONGESTED);
+            stats.qdrop++;
+          }
+          return;
+        }
+      }
+#endif /* COLLECT_AGGREGATION */
       if(packetqueue_len(&tc->send_queue) <= MAX_SENDING_QUEUE - MIN_AVAILABLE_QUEUE_ENTRIES &&
          packetqueue_enqueue_packetbuf(&tc->send_queue,
                                        FORWARD_PACKET_LIFETIME_BASE *
@@ -1053,6 +1255,9 @@ node_packet_received(struct unicast_conn *c, const rimeaddr_t *from)
                                        tc)) {
         add_packet_to_recent_packets(tc);
         send_ack(tc, &ack_to, ackflags);
+#if COLLECT_AGGREGATION
+        hold_for_aggregation(tc);
+#endif /* COLLECT_AGGREGATION */
         send_queued_packet(tc);
       } else {
         send_ack(tc, &ack_to,
@@ -1289,6 +1494,11 @@ collect_open(struct collect_conn *tc, uint16_t channels,
   tc->is_router = is_router;
   tc->seqno = 10;
   tc->eseqno = 0;
+#if COLLECT_AGGREGATION
+  tc->aggregator = NULL;
+  tc->aggregation_hold_time = 0;
+  ctimer_stop(&tc->aggregation_timer);
+#endif /* COLLECT_AGGREGATION */
   LIST_STRUCT_INIT(tc, send_queue_list);
   collect_neighbor_list_new(&tc->neighbor_list);
   tc->send_queue.list = &(tc->send_queue_list);
@@ -1357,6 +1567,21 @@ collect_set_keepalive(struct collect_conn *c, clock_time_t period)
   set_keepalive_timer(c);
 }
 /*---------------------------------------------------------------------------*/
+#if COLLECT_AGGREGATION
+void
+collect_set_aggregation(struct collect_conn *c,
+                        const struct collect_aggregator *aggregator,
+                        clock_time_t hold_time)
+{
+  c->aggregator = aggregator;
+  c->aggregation_hold_time = hold_time;
+  if(!ctimer_expired(&c->aggregation_timer)) {
+    ctimer_stop(&c->aggregation_timer);
+    send_queued_packet(c);
+  }
+}
+#endif /* COLLECT_AGGREGATION */
+/*---------------------------------------------------------------------------*/
 void
 collect_close(struct collect_conn *tc)
 {
@@ -1369,6 +1594,9 @@ collect_close(struct collect_conn *tc)
   while(packetqueue_first(&tc->send_queue) != NULL) {
     packetqueue_dequeue(&tc->send_queue);
   }
+#if COLLECT_AGGREGATION
+  ctimer_stop(&tc->aggregation_timer);
+#endif /* COLLECT_AGGREGATION */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -1447,6 +1675,13 @@ collect_send(struct collect_conn *tc, int rexmits)
     return 1;
   } else {
 
+#if COLLECT_AGGREGATION
+    ret = aggregate_packetbuf(tc, packetbuf_dataptr(), packetbuf_datalen());
+    if(ret != 0) {
+      return ret > 0;
+    }
+#endif /* COLLECT_AGGREGATION */
+
     /* Allocate space for the header. */
     packetbuf_hdralloc(sizeof(struct data_msg_hdr));
 
@@ -1454,6 +1689,9 @@ collect_send(struct collect_conn *tc, int rexmits)
                                      FORWARD_PACKET_LIFETIME_BASE *
                                      packetbuf_attr(PACKETBUF_ATTR_MAX_REXMIT),
                                      tc)) {
+#if COLLECT_AGGREGATION
+      hold_for_aggregation(tc);
+#endif /* COLLECT_AGGREGATION */
       send_queued_packet(tc);
       ret = 1;
     } else {
@@ -1530,12 +1768,12 @@ collect_purge(struct collect_conn *tc)
 void
 collect_print_stats(void)
 {
-  PRINTF("collect stats foundroute %lu newparent %lu routelost %lu acksent %lu datasent %lu datarecv %lu ackrecv %lu badack %lu duprecv %lu qdrop %lu rtdrop %lu ttldrop %lu ackdrop %lu timedout %lu\n",
+  PRINTF("collect stats foundroute %lu newparent %lu routelost %lu acksent %lu datasent %lu datarecv %lu ackrecv %lu badack %lu duprecv %lu qdrop %lu rtdrop %lu ttldrop %lu ackdrop %lu timedout %lu aggregated %lu\n",
          stats.foundroute, stats.newparent, stats.routelost,
          stats.acksent, stats.datasent, stats.datarecv,
          stats.ackrecv, stats.badack, stats.duprecv,
          stats.qdrop, stats.rtdrop, stats.ttldrop, stats.ackdrop,
-         stats.timedout);
+         stats.timedout, stats.aggregated);
 }
 /*---------------------------------------------------------------------------*/
 /** @} */
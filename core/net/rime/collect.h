@@ -83,6 +83,44 @@ struct collect_callbacks {
 		uint8_t hops);
 };
 
+/* COLLECT_CONF_AGGREGATION defines if forwarders may merge the
+   packets waiting in their send queue into a single packet, with the
+   merge function set by collect_set_aggregation(). */
+#ifdef COLLECT_CONF_AGGREGATION
+#define COLLECT_AGGREGATION COLLECT_CONF_AGGREGATION
+#else
+#define COLLECT_AGGREGATION 0
+#endif /* COLLECT_CONF_AGGREGATION */
+
+/* COLLECT_CONF_AGGREGATION_MAX_DATALEN is the maximum length of the
+   data of a merged packet. With the Rime and MAC headers, the packet
+   must fit into a single radio frame. */
+#ifdef COLLECT_CONF_AGGREGATION_MAX_DATALEN
+#define COLLECT_AGGREGATION_MAX_DATALEN COLLECT_CONF_AGGREGATION_MAX_DATALEN
+#else
+#define COLLECT_AGGREGATION_MAX_DATALEN 64
+#endif /* COLLECT_CONF_AGGREGATION_MAX_DATALEN */
+
+/* An aggregator merges the data of a new packet (newdata, newlen)
+   into the data of a packet queued for the sink (data, len), in
+   place. The merge function returns the length of the merged data,
+   at most maxlen, or 0 if the two packets cannot be merged. The
+   merged packet keeps the originator and sequence number of the
+   queued packet. */
+struct collect_aggregator {
+  int (* merge)(uint8_t *data, int len,
+                const uint8_t *newdata, int newlen, int maxlen);
+};
+
+/* Built-in aggregators: collect_aggregator_concat appends the data
+   of the packets; the others require data of the same length, seen
+   as an array of 16-bit values, which they add, or of which they keep
+   the maximum or minimum. */
+extern const struct collect_aggregator collect_aggregator_concat;
+extern const struct collect_aggregator collect_aggregator_sum16;
+extern const struct collect_aggregator collect_aggregator_max16;
+extern const struct collect_aggregator collect_aggregator_min16;
+
 /* COLLECT_CONF_ANNOUNCEMENTS defines if the Collect implementation
    should use Contiki's announcement primitive to announce its routes
    or if it should use periodic broadcasts. */
@@ -111,6 +149,12 @@ struct collect_conn {
 
   struct ctimer proactive_probing_timer;
 
+#if COLLECT_AGGREGATION
+  const struct collect_aggregator *aggregator;
+  struct ctimer aggregation_timer;
+  clock_time_t aggregation_hold_time;
+#endif /* COLLECT_AGGREGATION */
+
   rimeaddr_t parent, current_parent;
   uint16_t rtmetric;
   uint8_t seqno;
@@ -140,6 +184,12 @@ const rimeaddr_t *collect_parent(struct collect_conn *c);
 
 void collect_set_keepalive(struct collect_conn *c, clock_time_t period);
 
+#if COLLECT_AGGREGATION
+void collect_set_aggregation(struct collect_conn *c,
+                             const struct collect_aggregator *aggregator,
+                             clock_time_t hold_time);
+#endif /* COLLECT_AGGREGATION */
+
 void collect_print_stats(void);
 
 #define COLLECT_MAX_DEPTH (COLLECT_LINK_ESTIMATE_UNIT * 64 - 1)
@@ -51,6 +51,15 @@
 
 #define PACKET_TIMEOUT (CLOCK_SECOND * 10)
 
+/* Learn and refresh the route back to the originator of the packets
+   that we receive or forward, so that the replies find a route
+   without a route discovery. */
+#ifdef MESH_CONF_LEARN_ROUTES
+#define LEARN_ROUTES MESH_CONF_LEARN_ROUTES
+#else
+#define LEARN_ROUTES 0
+#endif
+
 #define DEBUG 0
 #if DEBUG
 #include <stdio.h>
@@ -68,6 +77,9 @@ data_packet_received(struct multihop_conn *multihop,
   struct mesh_conn *c = (struct mesh_conn *)
     ((char *)multihop - offsetof(struct mesh_conn, multihop));
 
+#if LEARN_ROUTES
+  route_refresh_from(from, prevhop, hops);
+#else /* LEARN_ROUTES */
   struct route_entry *rt;
 
   /* Refresh the route when we hear a packet from a neighbor. */
@@ -75,6 +87,7 @@ data_packet_received(struct multihop_conn *multihop,
   if(rt != NULL) {
     route_refresh(rt);
   }
+#endif /* LEARN_ROUTES */
   
   if(c->cb->recv) {
     c->cb->recv(c, from, hops);
@@ -91,8 +104,20 @@ data_packet_forward(struct multihop_conn *multihop,
   struct mesh_conn *c = (struct mesh_conn *)
     ((char *)multihop - offsetof(struct mesh_conn, multihop));
 
+#if LEARN_ROUTES
+  if(prevhop != NULL) {
+    route_refresh_from(originator, prevhop, hops);
+  }
+#endif /* LEARN_ROUTES */
+
   rt = route_lookup(dest);
   if(rt == NULL) {
+    if(route_is_unreachable(dest)) {
+      /* Route discovery failed recently: drop the packet rather than
+         flooding the network with a new request. */
+      PRINTF("data_packet_forward: destination unreachable\n");
+      return NULL;
+    }
     if(c->queued_data != NULL) {
       queuebuf_free(c->queued_data);
     }
@@ -146,6 +171,7 @@ route_timed_out(struct route_discovery_conn *rdc)
     ((char *)rdc - offsetof(struct mesh_conn, route_discovery_conn));
 
   if(c->queued_data != NULL) {
+    route_set_unreachable(&c->queued_data_dest);
     queuebuf_free(c->queued_data);
     c->queued_data = NULL;
   }
@@ -43,6 +43,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "lib/list.h"
 #include "lib/memb.h"
@@ -68,12 +69,40 @@
 #define DEFAULT_LIFETIME 60
 #endif /* ROUTE_CONF_DEFAULT_LIFETIME */
 
+#if ROUTE_HASH_SIZE & (ROUTE_HASH_SIZE - 1)
+#error ROUTE_CONF_HASH_SIZE must be a power of two
+#endif
+
+#ifdef ROUTE_CONF_UNREACHABLE_ENTRIES
+#define NUM_UNREACHABLE_ENTRIES ROUTE_CONF_UNREACHABLE_ENTRIES
+#else /* ROUTE_CONF_UNREACHABLE_ENTRIES */
+#define NUM_UNREACHABLE_ENTRIES 0
+#endif /* ROUTE_CONF_UNREACHABLE_ENTRIES */
+
+#ifdef ROUTE_CONF_UNREACHABLE_LIFETIME
+#define UNREACHABLE_LIFETIME ROUTE_CONF_UNREACHABLE_LIFETIME
+#else /* ROUTE_CONF_UNREACHABLE_LIFETIME */
+#define UNREACHABLE_LIFETIME 10
+#endif /* ROUTE_CONF_UNREACHABLE_LIFETIME */
+
 /*
  * List of route entries.
  */
 LIST(route_table);
 MEMB(route_mem, struct route_entry, NUM_RT_ENTRIES);
 
+#if ROUTE_HASH_SIZE
+static struct route_entry *route_hash[ROUTE_HASH_SIZE];
+#endif /* ROUTE_HASH_SIZE */
+
+#if NUM_UNREACHABLE_ENTRIES
+struct unreachable_entry {
+  rimeaddr_t dest;
+  uint8_t time;
+};
+static struct unreachable_entry unreachable[NUM_UNREACHABLE_ENTRIES];
+#endif /* NUM_UNREACHABLE_ENTRIES */
+
 static struct ctimer t;
 
 static int max_time = DEFAULT_LIFETIME;
@@ -87,20 +116,62 @@ static int max_time = DEFAULT_LIFETIME;
 #endif
 
 
+/*---------------------------------------------------------------------------*/
+#if ROUTE_HASH_SIZE
+static unsigned
+hash_index(const rimeaddr_t *addr)
+{
+  unsigned h;
+  int i;
+
+  h = 0;
+  for(i = 0; i < sizeof(rimeaddr_t); i++) {
+    h = h * 31 + addr->u8[i];
+  }
+  return h & (ROUTE_HASH_SIZE - 1);
+}
+#endif /* ROUTE_HASH_SIZE */
+/*---------------------------------------------------------------------------*/
+static void
+unlink_entry(struct route_entry *e)
+{
+#if ROUTE_HASH_SIZE
+  struct route_entry **ep;
+
+  for(ep = &route_hash[hash_index(&e->dest)];
+      *ep != NULL; ep = &(*ep)->hash_next) {
+    if(*ep == e) {
+      *ep = e->hash_next;
+      break;
+    }
+  }
+#endif /* ROUTE_HASH_SIZE */
+  list_remove(route_table, e);
+}
 /*---------------------------------------------------------------------------*/
 static void
 periodic(void *ptr)
 {
-  struct route_entry *e;
+  struct route_entry *e, *next;
+#if NUM_UNREACHABLE_ENTRIES
+  int i;
 
-  for(e = list_head(route_table); e != NULL; e = list_item_next(e)) {
+  for(i = 0; i < NUM_UNREACHABLE_ENTRIES; i++) {
+    if(unreachable[i].time > 0) {
+      unreachable[i].time--;
+    }
+  }
+#endif /* NUM_UNREACHABLE_ENTRIES */
+
+  for(e = list_head(route_table); e != NULL; e = next) {
+    next = list_item_next(e);
     e->time++;
     if(e->time >= max_time) {
       PRINTF("route periodic: removing entry to %d.%d with nexthop %d.%d and cost %d\n",
 	     e->dest.u8[0], e->dest.u8[1],
 	     e->nexthop.u8[0], e->nexthop.u8[1],
 	     e->cost);
-      list_remove(route_table, e);
+      unlink_entry(e);
       memb_free(&route_mem, e);
     }
   }
@@ -113,6 +184,12 @@ route_init(void)
 {
   list_init(route_table);
   memb_init(&route_mem);
+#if ROUTE_HASH_SIZE
+  memset(route_hash, 0, sizeof(route_hash));
+#endif /* ROUTE_HASH_SIZE */
+#if NUM_UNREACHABLE_ENTRIES
+  memset(unreachable, 0, sizeof(unreachable));
+#endif /* NUM_UNREACHABLE_ENTRIES */
 
   ctimer_set(&t, CLOCK_SECOND, periodic, NULL);
 }
@@ -126,17 +203,32 @@ route_add(const rimeaddr_t *dest, const rimeaddr_t *nexthop,
   /* Avoid inserting duplicate entries. */
   e = route_lookup(dest);
   if(e != NULL && rimeaddr_cmp(&e->nexthop, nexthop)) {
-    list_remove(route_table, e);
+    unlink_entry(e);
   } else {
     /* Allocate a new entry or reuse the oldest entry with highest cost. */
     e = memb_alloc(&route_mem);
     if(e == NULL) {
+#if ROUTE_HASH_SIZE
+      struct route_entry *old;
+
+      /* Evict the least recently used entry, the one that has gone
+         the longest without a refresh. */
+      e = list_head(route_table);
+      for(old = e; old != NULL; old = list_item_next(old)) {
+        if(old->time > e->time ||
+           (old->time == e->time && old->cost > e->cost)) {
+          e = old;
+        }
+      }
+#else /* ROUTE_HASH_SIZE */
       /* Remove oldest entry.  XXX */
-      e = list_chop(route_table);
+      e = list_tail(route_table);
+#endif /* ROUTE_HASH_SIZE */
       PRINTF("route_add: removing entry to %d.%d with nexthop %d.%d and cost %d\n",
 	     e->dest.u8[0], e->dest.u8[1],
 	     e->nexthop.u8[0], e->nexthop.u8[1],
 	     e->cost);
+      unlink_entry(e);
     }
   }
 
@@ -149,6 +241,21 @@ route_add(const rimeaddr_t *dest, const rimeaddr_t *nexthop,
 
   /* New entry goes first. */
   list_push(route_table, e);
+#if ROUTE_HASH_SIZE
+  e->hash_next = route_hash[hash_index(dest)];
+  route_hash[hash_index(dest)] = e;
+#endif /* ROUTE_HASH_SIZE */
+
+#if NUM_UNREACHABLE_ENTRIES
+  {
+    int i;
+    for(i = 0; i < NUM_UNREACHABLE_ENTRIES; i++) {
+      if(rimeaddr_cmp(&unreachable[i].dest, dest)) {
+        unreachable[i].time = 0;
+      }
+    }
+  }
+#endif /* NUM_UNREACHABLE_ENTRIES */
 
   PRINTF("route_add: new entry to %d.%d with nexthop %d.%d and cost %d\n",
 	 e->dest.u8[0], e->dest.u8[1],
@@ -169,7 +276,11 @@ route_lookup(const rimeaddr_t *dest)
   best_entry = NULL;
   
   /* Find the route with the lowest cost. */
+#if ROUTE_HASH_SIZE
+  for(e = route_hash[hash_index(dest)]; e != NULL; e = e->hash_next) {
+#else /* ROUTE_HASH_SIZE */
   for(e = list_head(route_table); e != NULL; e = list_item_next(e)) {
+#endif /* ROUTE_HASH_SIZE */
     /*    printf("route_lookup: comparing %d.%d.%d.%d with %d.%d.%d.%d\n",
 	   uip_ipaddr_to_quad(dest), uip_ipaddr_to_quad(&e->dest));*/
 
@@ -231,7 +342,7 @@ route_decay(struct route_entry *e)
 void
 route_remove(struct route_entry *e)
 {
-  list_remove(route_table, e);
+  unlink_entry(e);
   memb_free(&route_mem, e);
 }
 /*---------------------------------------------------------------------------*/
@@ -248,6 +359,9 @@ route_flush_all(void)
       break;
     }
   }
+#if ROUTE_HASH_SIZE
+  memset(route_hash, 0, sizeof(route_hash));
+#endif /* ROUTE_HASH_SIZE */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -256,6 +370,57 @@ route_set_lifetime(int seconds)
   max_time = seconds;
 }
 /*---------------------------------------------------------------------------*/
+void
+route_refresh_from(const rimeaddr_t *dest, const rimeaddr_t *nexthop,
+                   uint8_t cost)
+{
+  struct route_entry *e;
+
+  e = route_lookup(dest);
+  if(e == NULL) {
+    route_add(dest, nexthop, cost, 0);
+  } else if(rimeaddr_cmp(&e->nexthop, nexthop)) {
+    route_refresh(e);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+route_set_unreachable(const rimeaddr_t *dest)
+{
+#if NUM_UNREACHABLE_ENTRIES
+  int i, oldest;
+
+  oldest = 0;
+  for(i = 0; i < NUM_UNREACHABLE_ENTRIES; i++) {
+    if(rimeaddr_cmp(&unreachable[i].dest, dest)) {
+      oldest = i;
+      break;
+    }
+    if(unreachable[i].time < unreachable[oldest].time) {
+      oldest = i;
+    }
+  }
+  rimeaddr_copy(&unreachable[oldest].dest, dest);
+  unreachable[oldest].time = UNREACHABLE_LIFETIME;
+#endif /* NUM_UNREACHABLE_ENTRIES */
+}
+/*---------------------------------------------------------------------------*/
+int
+route_is_unreachable(const rimeaddr_t *dest)
+{
+#if NUM_UNREACHABLE_ENTRIES
+  int i;
+
+  for(i = 0; i < NUM_UNREACHABLE_ENTRIES; i++) {
+    if(unreachable[i].time > 0 &&
+       rimeaddr_cmp(&unreachable[i].dest, dest)) {
+      return 1;
+    }
+  }
+#endif /* NUM_UNREACHABLE_ENTRIES */
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
 int
 route_num(void)
 {
@@ -53,8 +53,20 @@
 
 #include "net/rime/rimeaddr.h"
 
+/* With a hash size, route_lookup() finds the entries through a hash
+   table instead of scanning the route table. The size must be a power
+   of two. */
+#ifdef ROUTE_CONF_HASH_SIZE
+#define ROUTE_HASH_SIZE ROUTE_CONF_HASH_SIZE
+#else /* ROUTE_CONF_HASH_SIZE */
+#define ROUTE_HASH_SIZE 0
+#endif /* ROUTE_CONF_HASH_SIZE */
+
 struct route_entry {
   struct route_entry *next;
+#if ROUTE_HASH_SIZE
+  struct route_entry *hash_next;
+#endif /* ROUTE_HASH_SIZE */
   rimeaddr_t dest;
   rimeaddr_t nexthop;
   uint8_t seqno;
@@ -75,6 +87,16 @@ void route_remove(struct route_entry *e);
 void route_flush_all(void);
 void route_set_lifetime(int seconds);
 
+/* Refresh the route to dest through nexthop, or add it if there is no
+   route to dest. Used to keep routes alive from forwarded traffic. */
+void route_refresh_from(const rimeaddr_t *dest, const rimeaddr_t *nexthop,
+                        uint8_t cost);
+
+/* Negative cache of the destinations that route discovery failed to
+   find, so that they are not discovered again for a while. */
+void route_set_unreachable(const rimeaddr_t *dest);
+int route_is_unreachable(const rimeaddr_t *dest);
+
 int route_num(void);
 struct route_entry *route_get(int num);
 
@@ -43,6 +43,10 @@
 
 #define MAX_TRANSMISSIONS 8
 
+/* The time after which a chunk that could not be queued is sent
+   again, at most MAX_TRANSMISSIONS times. */
+#define RETRY_TIME CLOCK_SECOND
+
 #define DEBUG 0
 #if DEBUG
 #include <stdio.h>
@@ -66,6 +70,60 @@ read_data(struct rucb_conn *c)
   return len;
 }
 /*---------------------------------------------------------------------------*/
+#if RUCB_WINDOW > 1
+static void
+abort_transfer(struct rucb_conn *c)
+{
+  if(c->last_size < 0) {
+    /* The transfer has already been aborted. */
+    return;
+  }
+  c->last_size = -1;
+  ctimer_stop(&c->retry_timer);
+  if(c->u->timedout) {
+    c->u->timedout(c);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Send chunks until the window is full. The transfer ends with the
+   first chunk that is shorter than RUCB_DATASIZE; last_size tells
+   whether it has been sent. runicast skips the chunks that time out,
+   so the chunks carry their number for the receiver to write them at
+   the right offset. */
+static void
+fill_window(void *ptr)
+{
+  struct rucb_conn *c = ptr;
+  uint8_t *hdr;
+  int len;
+
+  while(c->last_size == RUCB_DATASIZE && !runicast_is_transmitting(&c->c)) {
+    len = read_data(c);
+    if(len < 0) {
+      abort_transfer(c);
+      return;
+    }
+    packetbuf_hdralloc(2);
+    hdr = packetbuf_hdrptr();
+    hdr[0] = c->chunk >> 8;
+    hdr[1] = c->chunk & 0xff;
+    if(!runicast_send(&c->c, &c->receiver, MAX_TRANSMISSIONS)) {
+      /* Out of buffers: read the chunk again when a chunk is acked,
+         or after a while if no chunk is in flight. */
+      if(++c->retries > MAX_TRANSMISSIONS) {
+        abort_transfer(c);
+      } else {
+        ctimer_set(&c->retry_timer, RETRY_TIME, fill_window, c);
+      }
+      return;
+    }
+    c->retries = 0;
+    c->last_size = len;
+    c->chunk++;
+  }
+}
+#endif /* RUCB_WINDOW > 1 */
+/*---------------------------------------------------------------------------*/
 static void
 acked(struct runicast_conn *ruc, const rimeaddr_t *to, uint8_t retransmissions)
 {
@@ -73,6 +131,10 @@ acked(struct runicast_conn *ruc, const rimeaddr_t *to, uint8_t retransmissions)
   int len;
   PRINTF("%d.%d: rucb acked\n",
 	 rimeaddr_node_addr.u8[0],rimeaddr_node_addr.u8[1]);
+#if RUCB_WINDOW > 1
+  fill_window(c);
+  return;
+#endif /* RUCB_WINDOW > 1 */
   c->chunk++;
   len = read_data(c);
   if(len == 0 && c->last_size == 0) {
@@ -97,6 +159,10 @@ timedout(struct runicast_conn *ruc, const rimeaddr_t *to, uint8_t retransmission
   struct rucb_conn *c = (struct rucb_conn *)ruc;
   PRINTF("%d.%d: rucb timedout\n",
 	 rimeaddr_node_addr.u8[0],rimeaddr_node_addr.u8[1]);
+#if RUCB_WINDOW > 1
+  abort_transfer(c);
+  return;
+#endif /* RUCB_WINDOW > 1 */
   if(c->u->timedout) {
     c->u->timedout(c);
   }
@@ -111,6 +177,43 @@ recv(struct runicast_conn *ruc, const rimeaddr_t *from, uint8_t seqno)
 	 rimeaddr_node_addr.u8[0],rimeaddr_node_addr.u8[1],
 	 from->u8[0], from->u8[1], packetbuf_totlen());
 
+#if RUCB_WINDOW > 1
+  {
+    uint8_t *hdr;
+    uint16_t chunk;
+    int datalen;
+
+    if(packetbuf_datalen() < 2) {
+      return;
+    }
+    hdr = packetbuf_dataptr();
+    chunk = (hdr[0] << 8) | hdr[1];
+    packetbuf_hdrreduce(2);
+    datalen = packetbuf_datalen();
+
+    if(chunk == 0 && (rimeaddr_cmp(&c->sender, &rimeaddr_null) ||
+                      rimeaddr_cmp(&c->sender, from))) {
+      rimeaddr_copy(&c->sender, from);
+      c->u->write_chunk(c, 0, RUCB_FLAG_NEWFILE, packetbuf_dataptr(), 0);
+    }
+    if(!rimeaddr_cmp(&c->sender, from)) {
+      return;
+    }
+    if(datalen < RUCB_DATASIZE) {
+      PRINTF("%d.%d: get %d bytes, file complete\n",
+	     rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+	     datalen);
+      c->u->write_chunk(c, chunk * RUCB_DATASIZE,
+			 RUCB_FLAG_LASTCHUNK, packetbuf_dataptr(), datalen);
+      rimeaddr_copy(&c->sender, &rimeaddr_null);
+    } else {
+      c->u->write_chunk(c, chunk * RUCB_DATASIZE,
+			RUCB_FLAG_NONE, packetbuf_dataptr(), datalen);
+    }
+    return;
+  }
+#endif /* RUCB_WINDOW > 1 */
+
   if(seqno == c->last_seqno) {
     return;
   }
@@ -155,17 +258,32 @@ rucb_open(struct rucb_conn *c, uint16_t channel,
   c->u = u;
   c->last_seqno = -1;
   c->last_size = -1;
+#if RUCB_WINDOW > 1
+  runicast_set_window(&c->c, RUCB_WINDOW);
+#endif /* RUCB_WINDOW > 1 */
 }
 /*---------------------------------------------------------------------------*/
 void
 rucb_close(struct rucb_conn *c)
 {
+#if RUCB_WINDOW > 1
+  ctimer_stop(&c->retry_timer);
+#endif /* RUCB_WINDOW > 1 */
   runicast_close(&c->c);
 }
 /*---------------------------------------------------------------------------*/
 int
 rucb_send(struct rucb_conn *c, const rimeaddr_t *receiver)
 {
+#if RUCB_WINDOW > 1
+  c->chunk = 0;
+  c->last_size = RUCB_DATASIZE;
+  c->retries = 0;
+  rimeaddr_copy(&c->receiver, receiver);
+  rimeaddr_copy(&c->sender, &rimeaddr_node_addr);
+  fill_window(c);
+  return 0;
+#endif /* RUCB_WINDOW > 1 */
   c->chunk = 0;
   read_data(c);
   rimeaddr_copy(&c->receiver, receiver);
@@ -60,6 +60,14 @@ struct rucb_callbacks {
 
 #define RUCB_DATASIZE 64
 
+/* The number of chunks that a bulk transfer keeps in flight. Larger
+   than 1 requires the windowed mode of runicast. */
+#ifdef RUCB_CONF_WINDOW
+#define RUCB_WINDOW RUCB_CONF_WINDOW
+#else /* RUCB_CONF_WINDOW */
+#define RUCB_WINDOW RUNICAST_MAX_WINDOW
+#endif /* RUCB_CONF_WINDOW */
+
 struct rucb_conn {
   struct runicast_conn c;
   const struct rucb_callbacks *u;
@@ -67,6 +75,10 @@ struct rucb_conn {
   uint16_t chunk;
   uint8_t last_seqno;
   int last_size;
+#if RUCB_WINDOW > 1
+  struct ctimer retry_timer;
+  uint8_t retries;
+#endif /* RUCB_WINDOW > 1 */
 };
 
 void rucb_open(struct rucb_conn *c, uint16_t channel,
@@ -54,6 +54,10 @@
 #define REXMIT_TIME CLOCK_SECOND
 #endif /* RUNICAST_CONF_REXMIT_TIME */
 
+/* The time after which the receive state of a silent sender may be
+   reused for another sender, even if it still buffers packets. */
+#define RCV_LIFETIME (REXMIT_TIME * 16)
+
 static const struct packetbuf_attrlist attributes[] =
   {
     RUNICAST_ATTRIBUTES
@@ -68,12 +72,330 @@ static const struct packetbuf_attrlist attributes[] =
 #define PRINTF(...)
 #endif
 
+#if RUNICAST_MAX_WINDOW > 1
+#define SEQNO_MASK ((1 << RUNICAST_PACKET_ID_BITS) - 1)
+/*---------------------------------------------------------------------------*/
+static int
+seqno_diff(uint8_t a, uint8_t b)
+{
+  int d;
+
+  d = (a - b) & SEQNO_MASK;
+  if(d > SEQNO_MASK / 2) {
+    d -= SEQNO_MASK + 1;
+  }
+  return d;
+}
+/*---------------------------------------------------------------------------*/
+static int
+num_in_flight(struct runicast_conn *c)
+{
+  return seqno_diff(c->sndnxt, c->snduna);
+}
+/*---------------------------------------------------------------------------*/
+static void
+transmit_slot(struct runicast_conn *c, int i)
+{
+  queuebuf_to_packetbuf(c->snd[i].buf);
+  /* Data packets carry the oldest sequence number that the sender
+     still waits for, so that the receiver can skip the packets that
+     have timed out. */
+  packetbuf_hdralloc(1);
+  *(uint8_t *)packetbuf_hdrptr() = c->snduna;
+  c->snd[i].tx++;
+  if(c->snd[i].tx > 1) {
+    RIMESTATS_ADD(rexmit);
+  }
+  stunicast_send(&c->c, stunicast_receiver(&c->c));
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush_rcv(struct runicast_rcv_state *r)
+{
+  int i;
+
+  for(i = 0; i < RUNICAST_MAX_WINDOW; i++) {
+    if(r->buf[i] != NULL) {
+      queuebuf_free(r->buf[i]);
+      r->buf[i] = NULL;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Get the receive state of a sender. A sender that has no state takes
+   over a free one, or the one of the sender that has been silent the
+   longest, provided that it buffers no packet or has been silent for
+   RCV_LIFETIME. */
+static struct runicast_rcv_state *
+rcv_state(struct runicast_conn *c, const rimeaddr_t *from, uint8_t edge)
+{
+  struct runicast_rcv_state *r, *oldest;
+  int i, j;
+
+  for(i = 0; i < RUNICAST_RCV_SENDERS; i++) {
+    if(rimeaddr_cmp(&c->rcv[i].from, from)) {
+      return &c->rcv[i];
+    }
+  }
+
+  oldest = NULL;
+  for(i = 0; i < RUNICAST_RCV_SENDERS; i++) {
+    r = &c->rcv[i];
+    if(rimeaddr_cmp(&r->from, &rimeaddr_null)) {
+      oldest = r;
+      break;
+    }
+    if(clock_time() - r->last_rx < RCV_LIFETIME) {
+      for(j = 0; j < RUNICAST_MAX_WINDOW && r->buf[j] == NULL; j++);
+      if(j < RUNICAST_MAX_WINDOW) {
+        /* The sender is in the middle of a window */
+        continue;
+      }
+    }
+    if(oldest == NULL ||
+       clock_time() - r->last_rx > clock_time() - oldest->last_rx) {
+      oldest = r;
+    }
+  }
+  if(oldest != NULL) {
+    flush_rcv(oldest);
+    rimeaddr_copy(&oldest->from, from);
+    oldest->rcvnxt = edge;
+  }
+  return oldest;
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush_snd(struct runicast_conn *c)
+{
+  int i;
+
+  ctimer_stop(&c->rexmit_timer);
+  for(i = 0; i < RUNICAST_MAX_WINDOW; i++) {
+    if(c->snd[i].buf != NULL) {
+      queuebuf_free(c->snd[i].buf);
+      c->snd[i].buf = NULL;
+    }
+  }
+  c->snduna = c->sndnxt;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove the n first packets of the send window, after they have
+   been acknowledged or have timed out. */
+static void
+shift_snd(struct runicast_conn *c, int n, uint8_t *tx)
+{
+  int i;
+
+  for(i = 0; i < n; i++) {
+    tx[i] = c->snd[i].tx;
+    if(c->snd[i].buf != NULL) {
+      queuebuf_free(c->snd[i].buf);
+    }
+  }
+  for(i = 0; i < RUNICAST_MAX_WINDOW; i++) {
+    if(i + n < RUNICAST_MAX_WINDOW) {
+      c->snd[i] = c->snd[i + n];
+    } else {
+      c->snd[i].buf = NULL;
+    }
+  }
+  c->snduna = (c->snduna + n) & SEQNO_MASK;
+}
+/*---------------------------------------------------------------------------*/
+static void
+rexmit(void *ptr)
+{
+  struct runicast_conn *c = ptr;
+  uint8_t tx[RUNICAST_MAX_WINDOW];
+  int i, n;
+
+  if(num_in_flight(c) == 0) {
+    return;
+  }
+
+  n = 0;
+  if(c->snd[0].tx >= c->snd[0].max_tx) {
+    /* Give up on the oldest packet. The packets after it that the
+       receiver has already acknowledged are done too: the receiver
+       delivers them when it learns that the sender moved on. */
+    n = 1;
+    while(n < num_in_flight(c) && c->snd[n].buf == NULL) {
+      n++;
+    }
+    RIMESTATS_ADD(timedout);
+    PRINTF("%d.%d: runicast: packet %d timed out\n",
+           rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+           c->snduna);
+    shift_snd(c, n, tx);
+  }
+
+  for(i = 0; i < num_in_flight(c); i++) {
+    if(c->snd[i].buf != NULL) {
+      transmit_slot(c, i);
+    }
+  }
+  if(num_in_flight(c) > 0) {
+    ctimer_set(&c->rexmit_timer, REXMIT_TIME, rexmit, c);
+  }
+  c->is_tx = num_in_flight(c) >= c->window;
+
+  if(n > 0) {
+    if(c->u->timedout) {
+      c->u->timedout(c, stunicast_receiver(&c->c), tx[0]);
+    }
+    for(i = 1; i < n; i++) {
+      if(c->u->sent != NULL) {
+        c->u->sent(c, stunicast_receiver(&c->c), tx[i]);
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+recv_window_ack(struct runicast_conn *c, const rimeaddr_t *from)
+{
+  uint8_t tx[RUNICAST_MAX_WINDOW];
+  uint8_t sack;
+  int i, n;
+
+  n = seqno_diff(packetbuf_attr(PACKETBUF_ATTR_PACKET_ID), c->snduna);
+  if(!rimeaddr_cmp(from, stunicast_receiver(&c->c)) ||
+     n < 0 || n > num_in_flight(c)) {
+    PRINTF("%d.%d: runicast: received bad ACK %d for %d\n",
+           rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+           packetbuf_attr(PACKETBUF_ATTR_PACKET_ID), c->snduna);
+    RIMESTATS_ADD(badackrx);
+    return;
+  }
+  RIMESTATS_ADD(ackrx);
+
+  /* Bit i of the selective acknowledgement is the packet that
+     follows the cumulatively acknowledged one by i + 1. */
+  sack = packetbuf_datalen() > 0 ? *(uint8_t *)packetbuf_dataptr() : 0;
+  for(i = n + 1; i < num_in_flight(c); i++) {
+    if((sack & (1 << (i - n - 1))) && c->snd[i].buf != NULL) {
+      queuebuf_free(c->snd[i].buf);
+      c->snd[i].buf = NULL;
+    }
+  }
+
+  if(n == 0) {
+    return;
+  }
+  shift_snd(c, n, tx);
+  if(num_in_flight(c) == 0) {
+    ctimer_stop(&c->rexmit_timer);
+  } else {
+    ctimer_set(&c->rexmit_timer, REXMIT_TIME, rexmit, c);
+  }
+  c->is_tx = num_in_flight(c) >= c->window;
+
+  /* The callbacks may send more packets. */
+  for(i = 0; i < n; i++) {
+    if(c->u->sent != NULL) {
+      c->u->sent(c, stunicast_receiver(&c->c), tx[i]);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+recv_window_data(struct runicast_conn *c, const rimeaddr_t *from)
+{
+  struct runicast_rcv_state *r;
+  struct queuebuf *deliver[RUNICAST_MAX_WINDOW];
+  uint8_t seqno, edge, sack;
+  int i, n, offset;
+
+  RIMESTATS_ADD(reliablerx);
+
+  if(packetbuf_datalen() < 1) {
+    return;
+  }
+  seqno = packetbuf_attr(PACKETBUF_ATTR_PACKET_ID);
+  edge = *(uint8_t *)packetbuf_dataptr() & SEQNO_MASK;
+  packetbuf_hdrreduce(1);
+
+  r = rcv_state(c, from, edge);
+  if(r == NULL) {
+    /* The receive states are taken by senders in the middle of a
+       window: let this sender retransmit later. */
+    PRINTF("%d.%d: runicast: no receive state for %d.%d\n",
+           rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+           from->u8[0], from->u8[1]);
+    return;
+  }
+  r->last_rx = clock_time();
+
+  n = seqno_diff(edge, r->rcvnxt);
+  if(n > RUNICAST_MAX_WINDOW || n < -RUNICAST_MAX_WINDOW) {
+    /* A sender that we lost track of. */
+    flush_rcv(r);
+    r->rcvnxt = edge;
+    n = 0;
+  }
+
+  /* Collect the packets that are ready for the application: the
+     buffered ones that the sender has given up waiting for, then the
+     ones that are in sequence. */
+  offset = seqno_diff(seqno, r->rcvnxt);
+  if(offset >= 0 && offset < RUNICAST_MAX_WINDOW && r->buf[offset] == NULL) {
+    r->buf[offset] = queuebuf_new_from_packetbuf();
+  }
+  i = 0;
+  while(i < RUNICAST_MAX_WINDOW && (i < n || r->buf[i] != NULL)) {
+    i++;
+  }
+  n = i;
+  for(i = 0; i < RUNICAST_MAX_WINDOW; i++) {
+    if(i < n) {
+      deliver[i] = r->buf[i];
+    }
+    r->buf[i] = i + n < RUNICAST_MAX_WINDOW ? r->buf[i + n] : NULL;
+  }
+  r->rcvnxt = (r->rcvnxt + n) & SEQNO_MASK;
+
+  sack = 0;
+  for(i = 1; i < RUNICAST_MAX_WINDOW; i++) {
+    if(r->buf[i] != NULL) {
+      sack |= 1 << (i - 1);
+    }
+  }
+
+  PRINTF("%d.%d: runicast: packet %d, ACK %d sack 0x%02x to %d.%d\n",
+         rimeaddr_node_addr.u8[0], rimeaddr_node_addr.u8[1],
+         seqno, r->rcvnxt, sack, from->u8[0], from->u8[1]);
+  packetbuf_clear();
+  packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE, PACKETBUF_ATTR_PACKET_TYPE_ACK);
+  packetbuf_set_attr(PACKETBUF_ATTR_PACKET_ID, r->rcvnxt);
+  *(uint8_t *)packetbuf_dataptr() = sack;
+  packetbuf_set_datalen(1);
+  stunicast_send(&c->c, from);
+  RIMESTATS_ADD(acktx);
+
+  for(i = 0; i < n; i++) {
+    if(deliver[i] != NULL) {
+      queuebuf_to_packetbuf(deliver[i]);
+      queuebuf_free(deliver[i]);
+      if(c->u->recv != NULL) {
+        c->u->recv(c, from, packetbuf_attr(PACKETBUF_ATTR_PACKET_ID));
+      }
+    }
+  }
+}
+#endif /* RUNICAST_MAX_WINDOW > 1 */
+
 /*---------------------------------------------------------------------------*/
 static void
 sent_by_stunicast(struct stunicast_conn *stunicast, int status, int num_tx)
 {
   struct runicast_conn *c = (struct runicast_conn *)stunicast;
 
+#if RUNICAST_MAX_WINDOW > 1
+  /* The retransmissions are driven by the window timer. */
+  return;
+#endif /* RUNICAST_MAX_WINDOW > 1 */
+
   PRINTF("runicast: sent_by_stunicast c->rxmit %d num_tx %d\n",
          c->rxmit, num_tx);
 
@@ -122,6 +444,17 @@ recv_from_stunicast(struct stunicast_conn *stunicast, const rimeaddr_t *from)
 	 packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE),
 	 packetbuf_attr(PACKETBUF_ATTR_PACKET_ID));
 
+#if RUNICAST_MAX_WINDOW > 1
+  if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
+     PACKETBUF_ATTR_PACKET_TYPE_ACK) {
+    recv_window_ack(c, from);
+  } else if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
+            PACKETBUF_ATTR_PACKET_TYPE_DATA) {
+    recv_window_data(c, from);
+  }
+  return;
+#endif /* RUNICAST_MAX_WINDOW > 1 */
+
   if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
      PACKETBUF_ATTR_PACKET_TYPE_ACK) {
       PRINTF("%d.%d: runicast: got ACK from %d.%d, seqno %d (%d)\n",
@@ -206,14 +539,43 @@ runicast_open(struct runicast_conn *c, uint16_t channel,
   c->is_tx = 0;
   c->rxmit = 0;
   c->sndnxt = 0;
+#if RUNICAST_MAX_WINDOW > 1
+  memset(c->snd, 0, sizeof(c->snd));
+  memset(c->rcv, 0, sizeof(c->rcv));
+  c->snduna = 0;
+  c->window = 1;
+#endif /* RUNICAST_MAX_WINDOW > 1 */
 }
 /*---------------------------------------------------------------------------*/
 void
 runicast_close(struct runicast_conn *c)
 {
+#if RUNICAST_MAX_WINDOW > 1
+  int i;
+
+  flush_snd(c);
+  for(i = 0; i < RUNICAST_RCV_SENDERS; i++) {
+    flush_rcv(&c->rcv[i]);
+  }
+  c->is_tx = 0;
+#endif /* RUNICAST_MAX_WINDOW > 1 */
   stunicast_close(&c->c);
 }
 /*---------------------------------------------------------------------------*/
+void
+runicast_set_window(struct runicast_conn *c, uint8_t window)
+{
+#if RUNICAST_MAX_WINDOW > 1
+  if(window < 1) {
+    window = 1;
+  } else if(window > RUNICAST_MAX_WINDOW) {
+    window = RUNICAST_MAX_WINDOW;
+  }
+  c->window = window;
+  c->is_tx = num_in_flight(c) >= c->window;
+#endif /* RUNICAST_MAX_WINDOW > 1 */
+}
+/*---------------------------------------------------------------------------*/
 uint8_t
 runicast_is_transmitting(struct runicast_conn *c)
 {
@@ -234,6 +596,32 @@ runicast_send(struct runicast_conn *c, const rimeaddr_t *receiver,
   packetbuf_set_attr(PACKETBUF_ATTR_PACKET_TYPE, PACKETBUF_ATTR_PACKET_TYPE_DATA);
   packetbuf_set_attr(PACKETBUF_ATTR_PACKET_ID, c->sndnxt);
   packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, 3);
+#if RUNICAST_MAX_WINDOW > 1
+  if(num_in_flight(c) > 0 &&
+     !rimeaddr_cmp(receiver, stunicast_receiver(&c->c))) {
+    /* The window only holds packets to one neighbor. */
+    return 0;
+  }
+  ret = num_in_flight(c);
+  c->snd[ret].buf = queuebuf_new_from_packetbuf();
+  if(c->snd[ret].buf == NULL) {
+    return 0;
+  }
+  c->snd[ret].tx = 0;
+  c->snd[ret].max_tx = max_retransmissions;
+  rimeaddr_copy(stunicast_receiver(&c->c), receiver);
+  c->sndnxt = (c->sndnxt + 1) & SEQNO_MASK;
+  c->is_tx = num_in_flight(c) >= c->window;
+  RIMESTATS_ADD(reliabletx);
+  PRINTF("%d.%d: runicast: sending packet %d, %d in flight\n",
+	 rimeaddr_node_addr.u8[0],rimeaddr_node_addr.u8[1],
+	 packetbuf_attr(PACKETBUF_ATTR_PACKET_ID), num_in_flight(c));
+  transmit_slot(c, ret);
+  if(ret == 0) {
+    ctimer_set(&c->rexmit_timer, REXMIT_TIME, rexmit, c);
+  }
+  return 1;
+#endif /* RUNICAST_MAX_WINDOW > 1 */
   c->max_rxmit = max_retransmissions;
   c->rxmit = 0;
   c->is_tx = 1;
@@ -29,6 +29,15 @@
  * the application or protocol that sent the packet is notified with a
  * callback.
  *
+ * When RUNICAST_CONF_MAX_WINDOW is larger than 1, a connection can
+ * have up to runicast_set_window() packets in flight to its
+ * neighbor. The receiver buffers the packets that arrive out of
+ * order, delivers them to the application in sequence and
+ * acknowledges them with a cumulative acknowledgement and a bitmap
+ * of the packets it buffers, so the sender only retransmits the
+ * packets that are missing. The windowed mode changes the format of
+ * the packets: it must be enabled in all nodes of the network.
+ *
  *
  * \section channels Channels
  *
@@ -82,8 +91,22 @@
 
 struct runicast_conn;
 
+#ifdef RUNICAST_CONF_MAX_WINDOW
+#define RUNICAST_MAX_WINDOW RUNICAST_CONF_MAX_WINDOW
+#else /* RUNICAST_CONF_MAX_WINDOW */
+#define RUNICAST_MAX_WINDOW 1
+#endif /* RUNICAST_CONF_MAX_WINDOW */
 
+#if RUNICAST_MAX_WINDOW > 1
+/* The sequence numbers of two windows, plus one to tell apart the
+   start of a new window, must fit in the packet ID. */
+#define RUNICAST_PACKET_ID_BITS 4
+#if RUNICAST_MAX_WINDOW > 7
+#error RUNICAST_CONF_MAX_WINDOW must not be larger than 7
+#endif
+#else /* RUNICAST_MAX_WINDOW > 1 */
 #define RUNICAST_PACKET_ID_BITS 2
+#endif /* RUNICAST_MAX_WINDOW > 1 */
 
 #define RUNICAST_ATTRIBUTES  { PACKETBUF_ATTR_PACKET_TYPE, PACKETBUF_ATTR_BIT }, \
                              { PACKETBUF_ATTR_PACKET_ID, PACKETBUF_ATTR_BIT * RUNICAST_PACKET_ID_BITS }, \
@@ -94,6 +117,31 @@ struct runicast_callbacks {
   void (* timedout)(struct runicast_conn *c, const rimeaddr_t *to, uint8_t retransmissions);
 };
 
+#if RUNICAST_MAX_WINDOW > 1
+/* The number of senders whose packets a connection receives in
+   sequence at the same time. The packets of other senders are not
+   acknowledged until the receive state of a sender is released. */
+#ifdef RUNICAST_CONF_RCV_SENDERS
+#define RUNICAST_RCV_SENDERS RUNICAST_CONF_RCV_SENDERS
+#else /* RUNICAST_CONF_RCV_SENDERS */
+#define RUNICAST_RCV_SENDERS 2
+#endif /* RUNICAST_CONF_RCV_SENDERS */
+
+struct runicast_window_slot {
+  struct queuebuf *buf;
+  uint8_t tx;
+  uint8_t max_tx;
+};
+
+struct runicast_rcv_state {
+  rimeaddr_t from;
+  clock_time_t last_rx;
+  /* The packets received out of order, the first one being rcvnxt. */
+  struct queuebuf *buf[RUNICAST_MAX_WINDOW];
+  uint8_t rcvnxt;
+};
+#endif /* RUNICAST_MAX_WINDOW > 1 */
+
 struct runicast_conn {
   struct stunicast_conn c;
   const struct runicast_callbacks *u;
@@ -101,6 +149,16 @@ struct runicast_conn {
   uint8_t is_tx;
   uint8_t rxmit;
   uint8_t max_rxmit;
+#if RUNICAST_MAX_WINDOW > 1
+  struct ctimer rexmit_timer;
+  /* The packets in flight, the first one being snduna. A slot with
+     no buffer is one that the receiver has acknowledged out of
+     order. */
+  struct runicast_window_slot snd[RUNICAST_MAX_WINDOW];
+  uint8_t snduna;
+  uint8_t window;
+  struct runicast_rcv_state rcv[RUNICAST_RCV_SENDERS];
+#endif /* RUNICAST_MAX_WINDOW > 1 */
 };
 
 void runicast_open(struct runicast_conn *c, uint16_t channel,
@@ -112,6 +170,23 @@ int runicast_send(struct runicast_conn *c, const rimeaddr_t *receiver,
 
 uint8_t runicast_is_transmitting(struct runicast_conn *c);
 
+/**
+ * \brief      Set the number of packets a connection may have in flight
+ * \param c    The runicast connection
+ * \param window The number of packets, at most RUNICAST_MAX_WINDOW
+ *
+ *             With a window larger than 1, runicast_send() can be
+ *             called again before the previous packets have been
+ *             acknowledged, and runicast_is_transmitting() only
+ *             returns non-zero when the window is full. The sent and
+ *             timedout callbacks are called once per packet, in the
+ *             order the packets were sent.
+ *
+ *             This function does nothing unless
+ *             RUNICAST_CONF_MAX_WINDOW is larger than 1.
+ */
+void runicast_set_window(struct runicast_conn *c, uint8_t window);
+
 #endif /* __RUNICAST_H__ */
 /** @} */
 /** @} */
@@ -43,8 +43,11 @@
  */
 
 #include "net/rime/trickle.h"
+#include "net/netstack.h"
 #include "lib/random.h"
 
+#include <string.h>
+
 #if CONTIKI_TARGET_NETSIM
 #include "ether.h"
 #endif
@@ -86,6 +89,105 @@ send(void *ptr)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if TRICKLE_FAST
+static void
+update_neighbor(struct trickle_conn *c, const rimeaddr_t *from, uint8_t seqno)
+{
+  struct trickle_neighbor *n;
+  int i;
+
+  for(i = 0; i < TRICKLE_NEIGHBORS; i++) {
+    n = &c->neighbors[i];
+    if(rimeaddr_cmp(&n->addr, from)) {
+      n->seqno = seqno;
+      n->age = 0;
+      return;
+    }
+  }
+  for(i = 0; i < TRICKLE_NEIGHBORS; i++) {
+    n = &c->neighbors[i];
+    if(rimeaddr_cmp(&n->addr, &rimeaddr_null)) {
+      break;
+    }
+  }
+  if(i == TRICKLE_NEIGHBORS) {
+    /* The table is full: replace the entries in turn. */
+    n = &c->neighbors[c->next_neighbor];
+    c->next_neighbor = (c->next_neighbor + 1) % TRICKLE_NEIGHBORS;
+  }
+  rimeaddr_copy(&n->addr, from);
+  n->seqno = seqno;
+  n->age = 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Called once per Trickle interval: forget the neighbors that have not
+   been heard for TRICKLE_NEIGHBOR_MAX_AGE intervals, so that a node
+   that has left cannot keep us from suppressing our transmissions. */
+static void
+age_neighbors(struct trickle_conn *c)
+{
+  struct trickle_neighbor *n;
+  int i;
+
+  for(i = 0; i < TRICKLE_NEIGHBORS; i++) {
+    n = &c->neighbors[i];
+    if(!rimeaddr_cmp(&n->addr, &rimeaddr_null) &&
+       ++n->age >= TRICKLE_NEIGHBOR_MAX_AGE) {
+      rimeaddr_copy(&n->addr, &rimeaddr_null);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns non-zero if all the neighbors that we have heard are known
+   to have our packet. */
+static int
+neighbors_covered(struct trickle_conn *c)
+{
+  int i;
+
+  for(i = 0; i < TRICKLE_NEIGHBORS; i++) {
+    if(!rimeaddr_cmp(&c->neighbors[i].addr, &rimeaddr_null) &&
+       c->neighbors[i].seqno != c->seqno) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+suppress(struct trickle_conn *c)
+{
+  return c->duplicates >= DUPLICATE_THRESHOLD && neighbors_covered(c);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_first(void *ptr)
+{
+  struct trickle_conn *c = ptr;
+
+  if(!suppress(c)) {
+    send(c);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The delay before the first transmission of a new packet. The
+   neighbors wake up within one channel check interval, so this is
+   enough to spread the transmissions of the nodes over it. */
+static clock_time_t
+first_transmission_window(struct trickle_conn *c)
+{
+  clock_time_t window;
+
+  window = NETSTACK_RDC.channel_check_interval();
+  if(window == 0 || window > c->interval) {
+    window = c->interval;
+  }
+  return window;
+}
+#else /* TRICKLE_FAST */
+#define suppress(c) ((c)->duplicates >= DUPLICATE_THRESHOLD)
+#endif /* TRICKLE_FAST */
+/*---------------------------------------------------------------------------*/
 static void
 timer_callback(void *ptr)
 {
@@ -119,10 +221,19 @@ run_trickle(struct trickle_conn *c)
 
     c->duplicates = 0;
     PT_YIELD(&c->pt); /* Wait until listen timeout */
-    if(c->duplicates < DUPLICATE_THRESHOLD) {
+    if(!suppress(c)) {
       send(c);
     }
+#if TRICKLE_FAST
+    else if(neighbors_covered(c)) {
+      /* All neighbors have the packet: slow down at once. */
+      c->interval_scaling = INTERVAL_MAX;
+    }
+#endif /* TRICKLE_FAST */
     PT_YIELD(&c->pt); /* Wait until interval timer expired. */
+#if TRICKLE_FAST
+    age_neighbors(c);
+#endif /* TRICKLE_FAST */
     if(c->interval_scaling < INTERVAL_MAX) {
       c->interval_scaling++;
     }
@@ -145,6 +256,10 @@ recv(struct broadcast_conn *bc, const rimeaddr_t *from)
 	 packetbuf_datalen(),
 	 packetbuf_attr(PACKETBUF_ATTR_CHANNEL));
 
+#if TRICKLE_FAST
+  update_neighbor(c, from, seqno);
+#endif /* TRICKLE_FAST */
+
   if(seqno == c->seqno) {
     /*    c->cb->recv(c);*/
     ++c->duplicates;
@@ -163,8 +278,14 @@ recv(struct broadcast_conn *bc, const rimeaddr_t *from)
     c->q = queuebuf_new_from_packetbuf();
     c->interval_scaling = 0;
     reset_interval(c);
+#if TRICKLE_FAST
+    ctimer_set(&c->first_transmission_timer,
+               random_rand() % first_transmission_window(c),
+               send_first, c);
+#else /* TRICKLE_FAST */
     ctimer_set(&c->first_transmission_timer, random_rand() % c->interval,
 	       send, c);
+#endif /* TRICKLE_FAST */
     c->cb->recv(c);
   }
 }
@@ -180,6 +301,10 @@ trickle_open(struct trickle_conn *c, clock_time_t interval,
   c->q = NULL;
   c->interval = interval;
   c->interval_scaling = 0;
+#if TRICKLE_FAST
+  memset(c->neighbors, 0, sizeof(c->neighbors));
+  c->next_neighbor = 0;
+#endif /* TRICKLE_FAST */
   channel_set_attributes(channel, attributes);
 }
 /*---------------------------------------------------------------------------*/
@@ -189,6 +314,7 @@ trickle_close(struct trickle_conn *c)
   broadcast_close(&c->c);
   ctimer_stop(&c->t);
   ctimer_stop(&c->interval_timer);
+  ctimer_stop(&c->first_transmission_timer);
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -9,6 +9,13 @@
  *
  * The trickle module sends a single packet to all nodes on the network.
  *
+ * With TRICKLE_CONF_FAST, a node rebroadcasts a new packet within one
+ * channel check interval of the RDC layer rather than within one
+ * Trickle interval, and suppresses its transmissions only when all
+ * the neighbors it has heard are known to have the packet. A neighbor
+ * that has not been heard for TRICKLE_NEIGHBOR_MAX_AGE intervals is
+ * forgotten.
+ *
  * \section channels Channels
  *
  * The trickle module uses 1 channel.
@@ -65,8 +72,36 @@
 #define TRICKLE_ATTRIBUTES  { PACKETBUF_ATTR_EPACKET_ID, PACKETBUF_ATTR_BIT * 8 },\
                             BROADCAST_ATTRIBUTES
 
+#ifdef TRICKLE_CONF_FAST
+#define TRICKLE_FAST TRICKLE_CONF_FAST
+#else
+#define TRICKLE_FAST 0
+#endif
+
+#ifdef TRICKLE_CONF_NEIGHBORS
+#define TRICKLE_NEIGHBORS TRICKLE_CONF_NEIGHBORS
+#else
+#define TRICKLE_NEIGHBORS 8
+#endif
+
+#ifdef TRICKLE_CONF_NEIGHBOR_MAX_AGE
+#define TRICKLE_NEIGHBOR_MAX_AGE TRICKLE_CONF_NEIGHBOR_MAX_AGE
+#else
+#define TRICKLE_NEIGHBOR_MAX_AGE 4
+#endif
+
 struct trickle_conn;
 
+#if TRICKLE_FAST
+/* A neighbor, the last sequence number heard from it, and the number
+   of Trickle intervals since it was last heard. */
+struct trickle_neighbor {
+  rimeaddr_t addr;
+  uint8_t seqno;
+  uint8_t age;
+};
+#endif /* TRICKLE_FAST */
+
 struct trickle_callbacks {
   void (* recv)(struct trickle_conn *c);
 };
@@ -81,6 +116,10 @@ struct trickle_conn {
   uint8_t seqno;
   uint8_t interval_scaling;
   uint8_t duplicates;
+#if TRICKLE_FAST
+  struct trickle_neighbor neighbors[TRICKLE_NEIGHBORS];
+  uint8_t next_neighbor;
+#endif /* TRICKLE_FAST */
 };
 
 void trickle_open(struct trickle_conn *c, clock_time_t interval,
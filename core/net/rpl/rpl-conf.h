@@ -186,4 +186,15 @@
 #define RPL_DEFAULT_LIFETIME            RPL_CONF_DEFAULT_LIFETIME
 #endif
 
+/*
+ * Maximum number of nodes the root of a non-storing mode DAG keeps
+ * track of, i.e., the maximum number of nodes it can route down to.
+ * Only used when RPL_CONF_MOP is RPL_MOP_NON_STORING.
+ */
+#ifdef RPL_CONF_NS_NODE_NUM
+#define RPL_NS_NODE_NUM                 RPL_CONF_NS_NODE_NUM
+#else
+#define RPL_NS_NODE_NUM                 32
+#endif
+
 #endif /* RPL_CONF_H */
@@ -522,6 +522,9 @@ rpl_free_dag(rpl_dag_t *dag)
 
     /* Remove routes installed by DAOs. */
     rpl_remove_routes(dag);
+#if RPL_WITH_NON_STORING
+    rpl_ns_free_dag(dag);
+#endif /* RPL_WITH_NON_STORING */
 
    /* Remove autoconfigured address */
     if((dag->prefix_info.flags & UIP_ND6_RA_FLAG_AUTONOMOUS)) {
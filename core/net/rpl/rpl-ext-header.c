@@ -61,6 +61,8 @@
 #define UIP_EXT_HDR_OPT_BUF       ((struct uip_ext_hdr_opt *)&uip_buf[uip_l2_l3_hdr_len + uip_ext_opt_offset])
 #define UIP_EXT_HDR_OPT_PADN_BUF  ((struct uip_ext_hdr_opt_padn *)&uip_buf[uip_l2_l3_hdr_len + uip_ext_opt_offset])
 #define UIP_EXT_HDR_OPT_RPL_BUF   ((struct uip_ext_hdr_opt_rpl *)&uip_buf[uip_l2_l3_hdr_len + uip_ext_opt_offset])
+#define UIP_RH_BUF                ((struct uip_routing_hdr *)&uip_buf[uip_l2_l3_hdr_len])
+#define UIP_IP_RH_BUF             ((struct uip_routing_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
 /*---------------------------------------------------------------------------*/
 #if UIP_CONF_IPV6
 int
@@ -194,6 +196,11 @@ rpl_update_header_empty(void)
       return;
     }
     break;
+  case UIP_PROTO_ROUTING:
+    /* A source routed packet follows its routing header, there is no
+       need for a hop-by-hop option. */
+    uip_ext_len = last_uip_ext_len;
+    return;
   default:
     PRINTF("RPL: No hop-by-hop option found, creating it\n");
     if(uip_len + RPL_HOP_BY_HOP_LEN > UIP_BUFSIZE) {
@@ -355,4 +362,200 @@ rpl_insert_header(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_NON_STORING
+static rpl_dag_t *
+get_ns_root_dag(void)
+{
+  rpl_dag_t *dag;
+
+  if(default_instance == NULL || !RPL_IS_NON_STORING(default_instance)) {
+    return NULL;
+  }
+  dag = default_instance->current_dag;
+  if(dag == NULL || !dag->joined || dag->rank != ROOT_RANK(default_instance)) {
+    return NULL;
+  }
+  return dag;
+}
+#endif /* RPL_WITH_NON_STORING */
+/*---------------------------------------------------------------------------*/
+int
+rpl_insert_srh(void)
+{
+#if RPL_WITH_NON_STORING
+  rpl_dag_t *dag;
+  rpl_ns_node_t *dest_node;
+  rpl_ns_node_t *node;
+  struct rpl_srh_hdr *srh;
+  uint8_t *addr_ptr;
+  int path_len;
+  int srh_len;
+  int i;
+
+  dag = get_ns_root_dag();
+  if(dag == NULL) {
+    return 1;
+  }
+
+  dest_node = rpl_ns_get_node(dag, &UIP_IP_BUF->destipaddr);
+  if(dest_node == NULL || rpl_ns_is_root_node(dest_node)) {
+    return 1;
+  }
+
+  /* Count the hops down to the destination. */
+  path_len = 0;
+  for(node = dest_node; node != NULL && !rpl_ns_is_root_node(node);
+      node = node->parent) {
+    if(++path_len > RPL_NS_NODE_NUM) {
+      PRINTF("RPL: Loop in the non-storing mode node table\n");
+      return 1;
+    }
+  }
+  if(node == NULL) {
+    PRINTF("RPL: No source route to ");
+    PRINT6ADDR(&UIP_IP_BUF->destipaddr);
+    PRINTF("\n");
+    return 1;
+  }
+
+  if(path_len == 1) {
+    /* The destination is a child of the root, and thus a neighbor. */
+    return 1;
+  }
+
+  /* The source routing header replaces the RPL hop-by-hop option,
+     as it must come right after the IPv6 header. */
+  if(UIP_IP_BUF->proto == UIP_PROTO_HBHO) {
+    if(((struct uip_hbho_hdr *)UIP_IP_RH_BUF)->len != RPL_HOP_BY_HOP_LEN - 8) {
+      PRINTF("RPL: Non RPL Hop-by-hop options support not implemented\n");
+      return 1;
+    }
+    rpl_remove_header();
+  }
+  if(UIP_IP_BUF->proto == UIP_PROTO_ROUTING) {
+    return 1;
+  }
+
+  /* All the addresses share the prefix of the DAG, so only their
+     interface identifiers are carried (CmprI = CmprE = 8). The first
+     hop goes into the IPv6 destination address. */
+  srh_len = RPL_SRH_HDR_LEN + (path_len - 1) * 8;
+  if(uip_len + srh_len > UIP_BUFSIZE - UIP_LLH_LEN) {
+    PRINTF("RPL: Packet too long: impossible to add source routing header\n");
+    return 0;
+  }
+
+  memmove((uint8_t *)UIP_IP_RH_BUF + srh_len, UIP_IP_RH_BUF,
+          uip_len - UIP_IPH_LEN);
+  UIP_IP_RH_BUF->next = UIP_IP_BUF->proto;
+  UIP_IP_BUF->proto = UIP_PROTO_ROUTING;
+  UIP_IP_RH_BUF->len = path_len - 1;
+  UIP_IP_RH_BUF->routing_type = RPL_RH_TYPE_SRH;
+  UIP_IP_RH_BUF->seg_left = path_len - 1;
+  srh = (struct rpl_srh_hdr *)(UIP_IP_RH_BUF + 1);
+  srh->cmpr = (8 << 4) | 8;
+  srh->pad = 0;
+  srh->reserved[0] = srh->reserved[1] = 0;
+
+  /* The last address is the one of the destination. */
+  addr_ptr = (uint8_t *)(srh + 1) + (path_len - 2) * 8;
+  node = dest_node;
+  for(i = 0; i < path_len - 1; i++) {
+    memcpy(addr_ptr, node->link_identifier, 8);
+    addr_ptr -= 8;
+    node = node->parent;
+  }
+  rpl_ns_get_node_global_addr(&UIP_IP_BUF->destipaddr, node);
+
+  uip_len += srh_len;
+  UIP_IP_BUF->len[0] = (uip_len - UIP_IPH_LEN) >> 8;
+  UIP_IP_BUF->len[1] = (uip_len - UIP_IPH_LEN) & 0xff;
+
+  PRINTF("RPL: Source routing %d hops through ", path_len);
+  PRINT6ADDR(&UIP_IP_BUF->destipaddr);
+  PRINTF("\n");
+#endif /* RPL_WITH_NON_STORING */
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_srh_get_next_hop(uip_ipaddr_t *ipaddr)
+{
+#if RPL_WITH_NON_STORING
+  rpl_dag_t *dag;
+  rpl_ns_node_t *dest_node;
+
+  if(UIP_IP_BUF->proto != UIP_PROTO_ROUTING ||
+     UIP_IP_RH_BUF->routing_type != RPL_RH_TYPE_SRH) {
+    /* Without a source routing header, only the root knows the
+       children it can reach directly. */
+    dag = get_ns_root_dag();
+    if(dag == NULL) {
+      return 0;
+    }
+    dest_node = rpl_ns_get_node(dag, &UIP_IP_BUF->destipaddr);
+    if(dest_node == NULL || dest_node->parent == NULL ||
+       !rpl_ns_is_root_node(dest_node->parent)) {
+      return 0;
+    }
+  }
+
+  /* The destination of a source routed packet is always a neighbor. */
+  uip_create_linklocal_prefix(ipaddr);
+  memcpy(&ipaddr->u8[8], &UIP_IP_BUF->destipaddr.u8[8], 8);
+  return 1;
+#else /* RPL_WITH_NON_STORING */
+  return 0;
+#endif /* RPL_WITH_NON_STORING */
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_process_srh_header(void)
+{
+#if RPL_WITH_NON_STORING
+  struct rpl_srh_hdr *srh;
+  uint8_t cmpri, cmpre, cmpr;
+  uint8_t *addr_ptr;
+  uint8_t tmp[16];
+  int n, i;
+
+  if(UIP_RH_BUF->routing_type != RPL_RH_TYPE_SRH) {
+    return 0;
+  }
+
+  srh = (struct rpl_srh_hdr *)(UIP_RH_BUF + 1);
+  cmpri = RPL_SRH_CMPRI(srh);
+  cmpre = RPL_SRH_CMPRE(srh);
+  n = ((UIP_RH_BUF->len * 8) - RPL_SRH_PAD(srh) - (16 - cmpre)) /
+    (16 - cmpri) + 1;
+  if(UIP_RH_BUF->seg_left > n) {
+    PRINTF("RPL: Bad source routing header\n");
+    return 0;
+  }
+
+  i = n - UIP_RH_BUF->seg_left;
+  UIP_RH_BUF->seg_left--;
+  cmpr = (i == n - 1) ? cmpre : cmpri;
+  addr_ptr = (uint8_t *)(srh + 1) + i * (16 - cmpri);
+
+  /* Swap the destination and Address[i] (RFC 6554, section 4.2). The
+     elided prefix is the one of the current destination, so it is the
+     same for both. */
+  memcpy(tmp, &UIP_IP_BUF->destipaddr.u8[cmpr], 16 - cmpr);
+  memcpy(&UIP_IP_BUF->destipaddr.u8[cmpr], addr_ptr, 16 - cmpr);
+  memcpy(addr_ptr, tmp, 16 - cmpr);
+  if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)) {
+    PRINTF("RPL: Multicast address in source routing header\n");
+    return 0;
+  }
+
+  PRINTF("RPL: Source routing to ");
+  PRINT6ADDR(&UIP_IP_BUF->destipaddr);
+  PRINTF(", %u segments left\n", UIP_RH_BUF->seg_left);
+  return 1;
+#else /* RPL_WITH_NON_STORING */
+  return 0;
+#endif /* RPL_WITH_NON_STORING */
+}
+/*---------------------------------------------------------------------------*/
 #endif /* UIP_CONF_IPV6 */
@@ -587,6 +587,12 @@ dao_input(void)
   int i;
   int learned_from;
   rpl_parent_t *p;
+#if RPL_WITH_NON_STORING
+  uip_ipaddr_t parent_addr;
+  int has_parent_addr;
+
+  has_parent_addr = 0;
+#endif /* RPL_WITH_NON_STORING */
 
   prefixlen = 0;
 
@@ -651,7 +657,13 @@ dao_input(void)
       /*      pathcontrol = buffer[i + 3];
               pathsequence = buffer[i + 4];*/
       lifetime = buffer[i + 5];
-      /* The parent address is also ignored. */
+#if RPL_WITH_NON_STORING
+      /* The parent address is only used in non-storing mode. */
+      if(len >= 6 + 16) {
+        memcpy(&parent_addr, buffer + i + 6, 16);
+        has_parent_addr = 1;
+      }
+#endif /* RPL_WITH_NON_STORING */
       break;
     }
   }
@@ -661,6 +673,36 @@ dao_input(void)
   PRINT6ADDR(&prefix);
   PRINTF("\n");
 
+#if RPL_WITH_NON_STORING
+  if(RPL_IS_NON_STORING(instance)) {
+    /* Only the root keeps track of the downward routes, as a table of
+       child-parent links. */
+    if(dag->rank != ROOT_RANK(instance)) {
+      PRINTF("RPL: Ignoring a non-storing mode DAO as a non-root node\n");
+      return;
+    }
+    if(!has_parent_addr || prefixlen != 128) {
+      PRINTF("RPL: Ignoring a non-storing mode DAO without a parent\n");
+      return;
+    }
+    if(lifetime == RPL_ZERO_LIFETIME) {
+      PRINTF("RPL: No-Path DAO received\n");
+      rpl_ns_expire_parent(dag, &prefix, &parent_addr);
+      return;
+    }
+    if(rpl_ns_update_node(dag, &prefix, &parent_addr,
+                          RPL_LIFETIME(instance, lifetime)) == NULL) {
+      RPL_STAT(rpl_stats.mem_overflows++);
+      PRINTF("RPL: Could not add a node after receiving a DAO\n");
+      return;
+    }
+    if(flags & RPL_DAO_K_FLAG) {
+      dao_ack_output(instance, &dao_sender_addr, sequence);
+    }
+    return;
+  }
+#endif /* RPL_WITH_NON_STORING */
+
   rep = uip_ds6_route_lookup(&prefix);
 
   if(lifetime == RPL_ZERO_LIFETIME) {
@@ -757,6 +799,10 @@ dao_output_target(rpl_parent_t *parent, uip_ipaddr_t *prefix, uint8_t lifetime)
   unsigned char *buffer;
   uint8_t prefixlen;
   int pos;
+  uip_ipaddr_t *dest;
+#if RPL_WITH_NON_STORING
+  uip_ipaddr_t *parent_ipaddr;
+#endif /* RPL_WITH_NON_STORING */
 
   /* Destination Advertisement Object */
 
@@ -817,20 +863,44 @@ dao_output_target(rpl_parent_t *parent, uip_ipaddr_t *prefix, uint8_t lifetime)
 
   /* Create a transit information sub-option. */
   buffer[pos++] = RPL_OPTION_TRANSIT;
-  buffer[pos++] = 4;
-  buffer[pos++] = 0; /* flags - ignored */
-  buffer[pos++] = 0; /* path control - ignored */
-  buffer[pos++] = 0; /* path seq - ignored */
-  buffer[pos++] = lifetime;
+#if RPL_WITH_NON_STORING
+  if(RPL_IS_NON_STORING(instance)) {
+    /* The DAO goes straight to the root, and carries the global
+       address of the parent: the DAG prefix followed by the interface
+       identifier of the link-local address of the parent. */
+    parent_ipaddr = rpl_get_parent_ipaddr(parent);
+    if(parent_ipaddr == NULL) {
+      PRINTF("RPL dao_output_target error parent address NULL\n");
+      return;
+    }
+    buffer[pos++] = 4 + 16;
+    buffer[pos++] = 0; /* flags - ignored */
+    buffer[pos++] = 0; /* path control - ignored */
+    buffer[pos++] = 0; /* path seq - ignored */
+    buffer[pos++] = lifetime;
+    memcpy(buffer + pos, &dag->prefix_info.prefix, 8);
+    memcpy(buffer + pos + 8, &parent_ipaddr->u8[8], 8);
+    pos += 16;
+    dest = &dag->dag_id;
+  } else
+#endif /* RPL_WITH_NON_STORING */
+  {
+    buffer[pos++] = 4;
+    buffer[pos++] = 0; /* flags - ignored */
+    buffer[pos++] = 0; /* path control - ignored */
+    buffer[pos++] = 0; /* path seq - ignored */
+    buffer[pos++] = lifetime;
+    dest = rpl_get_parent_ipaddr(parent);
+  }
 
   PRINTF("RPL: Sending DAO with prefix ");
   PRINT6ADDR(prefix);
   PRINTF(" to ");
-  PRINT6ADDR(rpl_get_parent_ipaddr(parent));
+  PRINT6ADDR(dest);
   PRINTF("\n");
 
-  if(rpl_get_parent_ipaddr(parent) != NULL) {
-    uip_icmp6_send(rpl_get_parent_ipaddr(parent), ICMP6_RPL, RPL_CODE_DAO, pos);
+  if(dest != NULL) {
+    uip_icmp6_send(dest, ICMP6_RPL, RPL_CODE_DAO, pos);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -0,0 +1,265 @@
+/**
+ * \addtogroup uip6
+ * @{
+ */
+/*
+ * Copyright (c) 2026, The Contiki-PLB contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ */
+/**
+ * \file
+ *         The node table of the root of a non-storing mode RPL DAG.
+ *
+ *         In non-storing mode, DAOs are sent to the DAG root and carry
+ *         the address of the parent of the node that sent them. The
+ *         root keeps the resulting tree of child-parent links, from
+ *         which it builds the source routes of downward packets.
+ */
+
+#include "net/uip.h"
+#include "net/uip-ds6.h"
+#include "net/rpl/rpl-private.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+
+#define DEBUG DEBUG_NONE
+#include "net/uip-debug.h"
+
+#include <string.h>
+
+#if UIP_CONF_IPV6 && RPL_WITH_NON_STORING
+
+/* The nodes are identified by the interface identifier of their
+   address, their prefix being the prefix of the DAG. */
+MEMB(nodememb, rpl_ns_node_t, RPL_NS_NODE_NUM);
+LIST(nodelist);
+
+static int num_nodes;
+/*---------------------------------------------------------------------------*/
+static int
+is_in_dag_prefix(const rpl_dag_t *dag, const uip_ipaddr_t *addr)
+{
+  return memcmp(addr, &dag->prefix_info.prefix, 8) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_ns_node_t *
+lookup_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr)
+{
+  rpl_ns_node_t *n;
+
+  for(n = list_head(nodelist); n != NULL; n = list_item_next(n)) {
+    if(n->dag == dag &&
+       memcmp(n->link_identifier, &addr->u8[8], 8) == 0) {
+      return n;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_ns_node_t *
+add_node(rpl_dag_t *dag, const uip_ipaddr_t *addr)
+{
+  rpl_ns_node_t *n;
+
+  n = lookup_node(dag, addr);
+  if(n == NULL) {
+    n = memb_alloc(&nodememb);
+    if(n == NULL) {
+      return NULL;
+    }
+    n->dag = dag;
+    memcpy(n->link_identifier, &addr->u8[8], 8);
+    n->parent = NULL;
+    n->lifetime = 0;
+    list_add(nodelist, n);
+    num_nodes++;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_node(rpl_ns_node_t *node)
+{
+  rpl_ns_node_t *n;
+
+  for(n = list_head(nodelist); n != NULL; n = list_item_next(n)) {
+    if(n->parent == node) {
+      n->parent = NULL;
+    }
+  }
+  list_remove(nodelist, node);
+  memb_free(&nodememb, node);
+  num_nodes--;
+}
+/*---------------------------------------------------------------------------*/
+static int
+has_child(const rpl_ns_node_t *node)
+{
+  rpl_ns_node_t *n;
+
+  for(n = list_head(nodelist); n != NULL; n = list_item_next(n)) {
+    if(n->parent == node) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_init(void)
+{
+  memb_init(&nodememb);
+  list_init(nodelist);
+  num_nodes = 0;
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_ns_num_nodes(void)
+{
+  return num_nodes;
+}
+/*---------------------------------------------------------------------------*/
+rpl_ns_node_t *
+rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr)
+{
+  if(dag == NULL || addr == NULL || !is_in_dag_prefix(dag, addr)) {
+    return NULL;
+  }
+  return lookup_node(dag, addr);
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_ns_is_root_node(const rpl_ns_node_t *node)
+{
+  return node != NULL &&
+    memcmp(node->link_identifier, &node->dag->dag_id.u8[8], 8) == 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_get_node_global_addr(uip_ipaddr_t *addr, const rpl_ns_node_t *node)
+{
+  memcpy(addr, &node->dag->prefix_info.prefix, 8);
+  memcpy(&addr->u8[8], node->link_identifier, 8);
+}
+/*---------------------------------------------------------------------------*/
+rpl_ns_node_t *
+rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child,
+                   const uip_ipaddr_t *parent, uint32_t lifetime)
+{
+  rpl_ns_node_t *child_node;
+  rpl_ns_node_t *parent_node;
+
+  if(!is_in_dag_prefix(dag, child) || !is_in_dag_prefix(dag, parent)) {
+    PRINTF("RPL: NS node update with addresses out of the DAG prefix\n");
+    return NULL;
+  }
+
+  child_node = add_node(dag, child);
+  if(child_node == NULL) {
+    return NULL;
+  }
+  parent_node = add_node(dag, parent);
+  if(parent_node == NULL) {
+    if(child_node->lifetime == 0 && !has_child(child_node)) {
+      remove_node(child_node);
+    }
+    return NULL;
+  }
+
+  child_node->parent = parent_node;
+  child_node->lifetime = lifetime;
+
+  PRINTF("RPL: NS node ");
+  PRINT6ADDR(child);
+  PRINTF(" has parent ");
+  PRINT6ADDR(parent);
+  PRINTF(", %d nodes\n", num_nodes);
+
+  return child_node;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_expire_parent(rpl_dag_t *dag, const uip_ipaddr_t *child,
+                     const uip_ipaddr_t *parent)
+{
+  rpl_ns_node_t *child_node;
+
+  child_node = rpl_ns_get_node(dag, child);
+  if(child_node != NULL && child_node->parent != NULL &&
+     child_node->parent == rpl_ns_get_node(dag, parent) &&
+     child_node->lifetime > DAO_EXPIRATION_TIMEOUT) {
+    /* A No-Path DAO: let the link expire, unless it is refreshed. */
+    child_node->lifetime = DAO_EXPIRATION_TIMEOUT;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_periodic(void)
+{
+  rpl_ns_node_t *n, *next;
+
+  for(n = list_head(nodelist); n != NULL; n = list_item_next(n)) {
+    if(n->lifetime > 0) {
+      n->lifetime--;
+      if(n->lifetime == 0) {
+        /* The node did not refresh its DAO: forget its link. */
+        n->parent = NULL;
+      }
+    }
+  }
+
+  /* Forget the nodes that are neither registered nor the parent of a
+     registered node. */
+  for(n = list_head(nodelist); n != NULL; n = next) {
+    next = list_item_next(n);
+    if(n->lifetime == 0 && !has_child(n)) {
+      remove_node(n);
+      /* The removal may have orphaned the previous nodes too, they
+         are removed on the next call. */
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_free_dag(rpl_dag_t *dag)
+{
+  rpl_ns_node_t *n, *next;
+
+  for(n = list_head(nodelist); n != NULL; n = next) {
+    next = list_item_next(n);
+    if(n->dag == dag) {
+      list_remove(nodelist, n);
+      memb_free(&nodememb, n);
+      num_nodes--;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif /* UIP_CONF_IPV6 && RPL_WITH_NON_STORING */
+/** @} */
@@ -99,6 +99,21 @@
 #define RPL_HDR_OPT_RANK_ERR_SHIFT   	6
 #define RPL_HDR_OPT_FWD_ERR		0x20
 #define RPL_HDR_OPT_FWD_ERR_SHIFT   	5
+
+/* RPL source routing header (RFC 6554). */
+#define RPL_RH_TYPE_SRH                 3
+#define RPL_SRH_HDR_LEN                 8
+#define RPL_SRH_CMPRI(srh)              ((srh)->cmpr >> 4)
+#define RPL_SRH_CMPRE(srh)              ((srh)->cmpr & 0x0f)
+#define RPL_SRH_PAD(srh)                ((srh)->pad >> 4)
+
+/* The fields that follow the generic routing header in a source
+   routing header. */
+struct rpl_srh_hdr {
+  uint8_t cmpr;
+  uint8_t pad;
+  uint8_t reserved[2];
+};
 /*---------------------------------------------------------------------------*/
 /* Default values for RPL constants and variables. */
 
@@ -181,6 +196,13 @@
 #define RPL_MOP_DEFAULT                 RPL_MOP_STORING_NO_MULTICAST
 #endif
 
+/* Downward routes are either stored by every router (storing modes)
+   or only by the DAG root, which source routes the downward packets
+   (non-storing mode). All the nodes of a network must agree on it. */
+#define RPL_WITH_NON_STORING   (RPL_MOP_DEFAULT == RPL_MOP_NON_STORING)
+#define RPL_IS_NON_STORING(instance) \
+  ((instance) != NULL && (instance)->mop == RPL_MOP_NON_STORING)
+
 /*
  * The ETX in the metric container is expressed as a fixed-point value 
  * whose integer part can be obtained by dividing the value by 
@@ -304,6 +326,30 @@ uip_ds6_route_t *rpl_add_route(rpl_dag_t *dag, uip_ipaddr_t *prefix,
                                int prefix_len, uip_ipaddr_t *next_hop);
 void rpl_purge_routes(void);
 
+/* Node table of a non-storing mode DAG root. */
+struct rpl_ns_node {
+  struct rpl_ns_node *next;
+  uint32_t lifetime;
+  rpl_dag_t *dag;
+  /* The interface identifier of the node; its prefix is the one of
+     the DAG. */
+  uint8_t link_identifier[8];
+  struct rpl_ns_node *parent;
+};
+typedef struct rpl_ns_node rpl_ns_node_t;
+
+void rpl_ns_init(void);
+int rpl_ns_num_nodes(void);
+rpl_ns_node_t *rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
+int rpl_ns_is_root_node(const rpl_ns_node_t *node);
+void rpl_ns_get_node_global_addr(uip_ipaddr_t *addr, const rpl_ns_node_t *node);
+rpl_ns_node_t *rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child,
+                                  const uip_ipaddr_t *parent, uint32_t lifetime);
+void rpl_ns_expire_parent(rpl_dag_t *dag, const uip_ipaddr_t *child,
+                          const uip_ipaddr_t *parent);
+void rpl_ns_periodic(void);
+void rpl_ns_free_dag(rpl_dag_t *dag);
+
 /* Objective function. */
 rpl_of_t *rpl_find_of(rpl_ocp_t);
 
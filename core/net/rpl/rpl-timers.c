@@ -66,6 +66,9 @@ static void
 handle_periodic_timer(void *ptr)
 {
   rpl_purge_routes();
+#if RPL_WITH_NON_STORING
+  rpl_ns_periodic();
+#endif /* RPL_WITH_NON_STORING */
   rpl_recalculate_ranks();
 
   /* handle DIS */
@@ -224,6 +224,9 @@ rpl_init(void)
   default_instance = NULL;
 
   rpl_dag_init();
+#if RPL_WITH_NON_STORING
+  rpl_ns_init();
+#endif /* RPL_WITH_NON_STORING */
   rpl_reset_periodic_timer();
 
   /* add rpl multicast address */
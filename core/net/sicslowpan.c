@@ -66,6 +66,12 @@
 #include "net/rime.h"
 #include "net/sicslowpan.h"
 #include "net/netstack.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+
+#if UIP_CONF_IPV6_RPL || SICSLOWPAN_6LORH
+#include "net/rpl/rpl-private.h"
+#endif /* UIP_CONF_IPV6_RPL || SICSLOWPAN_6LORH */
 
 #if UIP_CONF_IPV6
 
@@ -81,7 +87,7 @@ uint8_t p;
 #define PRINTFO(...) PRINTF(__VA_ARGS__)
 #define PRINTPACKETBUF() PRINTF("RIME buffer: "); for(p = 0; p < packetbuf_datalen(); p++){PRINTF("%.2X", *(rime_ptr + p));} PRINTF("\n")
 #define PRINTUIPBUF() PRINTF("UIP buffer: "); for(p = 0; p < uip_len; p++){PRINTF("%.2X", uip_buf[p]);}PRINTF("\n")
-#define PRINTSICSLOWPANBUF() PRINTF("SICSLOWPAN buffer: "); for(p = 0; p < sicslowpan_len; p++){PRINTF("%.2X", sicslowpan_buf[p]);}PRINTF("\n")
+#define PRINTSICSLOWPANBUF() PRINTF("SICSLOWPAN buffer: "); for(p = 0; p < uip_len; p++){PRINTF("%.2X", sicslowpan_buf[p]);}PRINTF("\n")
 #else
 #define PRINTFI(...)
 #define PRINTFO(...)
@@ -112,6 +118,10 @@ void uip_log(char *msg);
 #endif /* SICSLOWPAN_CONF_COMPRESSION */
 #endif /* SICSLOWPAN_COMPRESSION */
 
+#if SICSLOWPAN_6LORH && SICSLOWPAN_COMPRESSION != SICSLOWPAN_COMPRESSION_HC06
+#error SICSLOWPAN_CONF_6LORH requires SICSLOWPAN_COMPRESSION_HC06
+#endif
+
 #define GET16(ptr,index) (((uint16_t)((ptr)[index] << 8)) | ((ptr)[(index) + 1]))
 #define SET16(ptr,index,value) do {     \
   (ptr)[index] = ((value) >> 8) & 0xff; \
@@ -146,12 +156,14 @@ void uip_log(char *msg);
  *  @{
  */
 #define SICSLOWPAN_IP_BUF   ((struct uip_ip_hdr *)&sicslowpan_buf[UIP_LLH_LEN])
-#define SICSLOWPAN_UDP_BUF ((struct uip_udp_hdr *)&sicslowpan_buf[UIP_LLIPH_LEN])
+#define SICSLOWPAN_UDP_BUF ((struct uip_udp_hdr *)&sicslowpan_buf[UIP_LLIPH_LEN + EXT_HDR_LEN])
 
 #define UIP_IP_BUF          ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
-#define UIP_UDP_BUF          ((struct uip_udp_hdr *)&uip_buf[UIP_LLIPH_LEN])
+#define UIP_UDP_BUF          ((struct uip_udp_hdr *)&uip_buf[UIP_LLIPH_LEN + EXT_HDR_LEN])
 #define UIP_TCP_BUF          ((struct uip_tcp_hdr *)&uip_buf[UIP_LLIPH_LEN])
 #define UIP_ICMP_BUF          ((struct uip_icmp_hdr *)&uip_buf[UIP_LLIPH_LEN])
+#define UIP_HBHO_BUF          ((struct uip_hbho_hdr *)&uip_buf[UIP_LLIPH_LEN])
+#define UIP_EXT_HDR_OPT_RPL_BUF ((struct uip_ext_hdr_opt_rpl *)&uip_buf[UIP_LLIPH_LEN + 2])
 /** @} */
 
 
@@ -208,6 +220,21 @@ static uint8_t rime_payload_len;
  */
 static uint8_t uncomp_hdr_len;
 
+#if SICSLOWPAN_6LORH
+/**
+ * ext_hdr_len is the length of the IPv6 extension headers compressed
+ * as 6LoRH headers. They come between the IPv6 header and the UDP
+ * header in the uncompressed packet.
+ */
+static uint8_t ext_hdr_len;
+#define EXT_HDR_LEN ext_hdr_len
+
+/** Offset in the rime buffer of the 6LoRH headers of a received packet. */
+static uint8_t lorh_offset;
+#else /* SICSLOWPAN_6LORH */
+#define EXT_HDR_LEN 0
+#endif /* SICSLOWPAN_6LORH */
+
 /**
  * the result of the last transmitted fragment
  */
@@ -219,42 +246,181 @@ static int last_tx_status;
  *  @{
  */
 
-static uint16_t sicslowpan_len;
-
 /**
- * The buffer used for the 6lowpan reassembly.
- * This buffer contains only the IPv6 packet (no MAC header, 6lowpan, etc).
- * It has a fix size as we do not use dynamic memory allocation.
+ * A reassembly context. Fragments are merged into the context with
+ * the same sender, datagram tag and datagram size. The buffer contains
+ * only the IPv6 packet (no MAC header, 6lowpan, etc).
  */
-static uip_buf_t sicslowpan_aligned_buf;
-#define sicslowpan_buf (sicslowpan_aligned_buf.u8)
+struct sicslowpan_reass {
+  struct sicslowpan_reass *next;
+  /** The source address of the fragments being merged */
+  rimeaddr_t sender;
+  /** The tag in the fragments being merged */
+  uint16_t tag;
+  /** The total length of the IPv6 packet being reassembled */
+  uint16_t size;
+  /**
+   * length of the ip packet already received.
+   * It includes IP and transport headers.
+   */
+  uint16_t processed_ip_in_len;
+  /** Reassembly %process %timer. */
+  struct timer timer;
+  uip_buf_t buf;
+};
 
-/** The total length of the IPv6 packet in the sicslowpan_buf. */
+/**
+ * The reassembly contexts. They are allocated from a fixed pool, as
+ * we do not use dynamic memory allocation.
+ */
+MEMB(reass_memb, struct sicslowpan_reass, SICSLOWPAN_REASS_CONTEXTS);
+LIST(reass_list);
 
 /**
- * length of the ip packet already sent / received.
- * It includes IP and transport headers.
+ * The buffer in which the packet currently being received is put:
+ * the buffer of its reassembly context if it is a fragment, uip_buf
+ * otherwise.
  */
-static uint16_t processed_ip_in_len;
+static uint8_t *sicslowpan_buf = uip_buf;
 
 /** Datagram tag to be put in the fragments I send. */
 static uint16_t my_tag;
 
-/** When reassembling, the tag in the fragments being merged. */
-static uint16_t reass_tag;
-
-/** When reassembling, the source address of the fragments being merged */
-rimeaddr_t frag_sender;
+#if SICSLOWPAN_FRAG_FORWARDING
+/**
+ * A virtual reassembly entry: the fragments of a packet we relay
+ * without reassembling it. It is created when the first fragment is
+ * routed and maps the incoming datagram to the outgoing one.
+ */
+struct sicslowpan_vrb {
+  struct sicslowpan_vrb *next;
+  /** The source address of the incoming fragments */
+  rimeaddr_t sender;
+  /** The tag in the incoming fragments */
+  uint16_t tag;
+  /** The total length of the IPv6 packet being relayed */
+  uint16_t size;
+  /** The tag in the relayed fragments */
+  uint16_t out_tag;
+  /** length of the ip packet already relayed */
+  uint16_t processed_ip_in_len;
+  /** The link layer address of the next hop */
+  rimeaddr_t nexthop;
+  /** The entry is dropped when this timer expires */
+  struct timer timer;
+};
 
-/** Reassembly %process %timer. */
-static struct timer reass_timer;
+MEMB(vrb_memb, struct sicslowpan_vrb, SICSLOWPAN_FRAG_FORWARD_ENTRIES);
+LIST(vrb_list);
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 
 /** @} */
 #else /* SICSLOWPAN_CONF_FRAG */
 /** The buffer used for the 6lowpan processing is uip_buf.
     We do not use any additional buffer.*/
 #define sicslowpan_buf uip_buf
-#define sicslowpan_len uip_len
+#endif /* SICSLOWPAN_CONF_FRAG */
+
+#if SICSLOWPAN_CONF_FRAG
+/*--------------------------------------------------------------------*/
+/** \name Reassembly context management
+ *  @{
+ */
+static void
+reass_free(struct sicslowpan_reass *r)
+{
+  list_remove(reass_list, r);
+  memb_free(&reass_memb, r);
+}
+/*--------------------------------------------------------------------*/
+/** \brief Find the reassembly context of a fragment, dropping the ones
+ * that have timed out. */
+static struct sicslowpan_reass *
+reass_lookup(const rimeaddr_t *sender, uint16_t tag, uint16_t size)
+{
+  struct sicslowpan_reass *r, *next;
+
+  for(r = list_head(reass_list); r != NULL; r = next) {
+    next = list_item_next(r);
+    if(timer_expired(&r->timer)) {
+      PRINTFI("sicslowpan input: reassembly timed out (tag %d)\n", r->tag);
+      reass_free(r);
+    } else if(r->tag == tag && r->size == size &&
+              rimeaddr_cmp(&r->sender, sender)) {
+      return r;
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+/** \brief Allocate a reassembly context for a new fragmented packet.
+ *
+ * If all contexts are in use, the oldest reassembly is discarded: new
+ * packets are prioritized, which lessens the negative impacts of too
+ * high SICSLOWPAN_REASS_MAXAGE.
+ */
+static struct sicslowpan_reass *
+reass_new(const rimeaddr_t *sender, uint16_t tag, uint16_t size)
+{
+  struct sicslowpan_reass *r, *oldest;
+
+  r = memb_alloc(&reass_memb);
+  if(r == NULL) {
+    oldest = NULL;
+    for(r = list_head(reass_list); r != NULL; r = list_item_next(r)) {
+      if(oldest == NULL ||
+         timer_remaining(&r->timer) < timer_remaining(&oldest->timer)) {
+        oldest = r;
+      }
+    }
+    if(oldest == NULL) {
+      return NULL;
+    }
+    PRINTFI("sicslowpan input: discarding reassembly (tag %d)\n", oldest->tag);
+    list_remove(reass_list, oldest);
+    r = oldest;
+  }
+
+  rimeaddr_copy(&r->sender, sender);
+  r->tag = tag;
+  r->size = size;
+  r->processed_ip_in_len = 0;
+  timer_set(&r->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  list_add(reass_list, r);
+  PRINTFI("sicslowpan input: INIT FRAGMENTATION (len %d, tag %d)\n",
+          size, tag);
+  return r;
+}
+#if SICSLOWPAN_FRAG_FORWARDING
+/*--------------------------------------------------------------------*/
+static void
+vrb_free(struct sicslowpan_vrb *v)
+{
+  list_remove(vrb_list, v);
+  memb_free(&vrb_memb, v);
+}
+/*--------------------------------------------------------------------*/
+/** \brief Find the virtual reassembly entry of a fragment, dropping
+ * the ones that have timed out. */
+static struct sicslowpan_vrb *
+vrb_lookup(const rimeaddr_t *sender, uint16_t tag, uint16_t size)
+{
+  struct sicslowpan_vrb *v, *next;
+
+  for(v = list_head(vrb_list); v != NULL; v = next) {
+    next = list_item_next(v);
+    if(timer_expired(&v->timer)) {
+      PRINTFI("sicslowpan input: relay timed out (tag %d)\n", v->tag);
+      vrb_free(v);
+    } else if(v->tag == tag && v->size == size &&
+              rimeaddr_cmp(&v->sender, sender)) {
+      return v;
+    }
+  }
+  return NULL;
+}
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+/** @} */
 #endif /* SICSLOWPAN_CONF_FRAG */
 
 /*-------------------------------------------------------------------------*/
@@ -450,6 +616,241 @@ uncompress_addr(uip_ipaddr_t *ipaddr, uint8_t const prefix[],
   PRINTF("\n");
 }
 
+#if SICSLOWPAN_6LORH
+/*--------------------------------------------------------------------*/
+/** \name 6LoRH compression and uncompression functions
+ *  @{                                                                */
+/*--------------------------------------------------------------------*/
+/**
+ * The 6LoRH headers must leave room for IPHC and some payload in the
+ * first frame of a packet, as they cannot be fragmented.
+ */
+#define LORH_MAX_LEN 32
+
+/** The longest extension headers, such that uncomp_hdr_len fits a byte */
+#define EXT_HDR_MAX_LEN (255 - UIP_IPH_LEN - UIP_UDPH_LEN)
+
+/** Address size of each type of SRH-6LoRH */
+static const uint8_t lorh_srh_size[] = {1, 2, 4, 8, 16};
+
+/** Padding of a source routing header of n addresses of size bytes */
+#define SRH_PAD(n, size) ((8 - (((n) * (size)) & 7)) & 7)
+
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Compress the RPL extension headers of the packet in uip_buf
+ * into 6LoRH headers, after a page 1 dispatch at the start of the rime
+ * buffer
+ * \param nh The next header of the IPv6 header. Updated to the next
+ * header of the last compressed extension header.
+ * \return The length of the page 1 dispatch and 6LoRH headers, 0 if
+ * no header was compressed
+ *
+ * The RPL option is compressed into a RPI-6LoRH when it is alone in
+ * its hop-by-hop header, and the RPL source routing header into a
+ * SRH-6LoRH when none of its addresses has been visited yet and they
+ * all have the same size. The receiver rebuilds them byte for byte,
+ * so that the length of the IPv6 packet, on which fragmentation
+ * relies, does not change. We stop at the first header we cannot
+ * compress: it is carried inline, after the IPHC header.
+ */
+static uint8_t
+compress_6lorh(uint8_t *nh)
+{
+  uint8_t *hdr, *lorh;
+  uint16_t max_len, hlen;
+  uint8_t n, size, type;
+
+  max_len = GET16(UIP_IP_BUF->len, 0);
+  if(max_len > EXT_HDR_MAX_LEN) {
+    max_len = EXT_HDR_MAX_LEN;
+  }
+  lorh = rime_ptr + 1;
+  ext_hdr_len = 0;
+
+  for(;;) {
+    hdr = (uint8_t *)UIP_IP_BUF + UIP_IPH_LEN + ext_hdr_len;
+    if(*nh == UIP_PROTO_HBHO) {
+      /* RPI-6LoRH: flags, instance unless 0, rank on 1 or 2 bytes */
+      hlen = RPL_HOP_BY_HOP_LEN;
+      if(ext_hdr_len + hlen > max_len ||
+         lorh + 5 > rime_ptr + LORH_MAX_LEN ||
+         hdr[1] != 0 || hdr[2] != UIP_EXT_HDR_OPT_RPL ||
+         hdr[3] != RPL_HDR_OPT_LEN ||
+         (hdr[4] & ~(RPL_HDR_OPT_DOWN | RPL_HDR_OPT_RANK_ERR |
+                     RPL_HDR_OPT_FWD_ERR)) != 0) {
+        break;
+      }
+      lorh[0] = SICSLOWPAN_6LORH_CRITICAL | (hdr[4] >> 3);
+      lorh[1] = SICSLOWPAN_6LORH_TYPE_RPI;
+      n = 2;
+      if(hdr[5] == 0) {
+        lorh[0] |= SICSLOWPAN_6LORH_RPI_I;
+      } else {
+        lorh[n++] = hdr[5];
+      }
+      if(hdr[6] == 0) {
+        lorh[0] |= SICSLOWPAN_6LORH_RPI_K;
+      } else {
+        lorh[n++] = hdr[6];
+      }
+      lorh[n++] = hdr[7];
+      lorh += n;
+    } else if(*nh == UIP_PROTO_ROUTING) {
+      /* SRH-6LoRH: the addresses, all of the same size */
+      if(ext_hdr_len + RPL_SRH_HDR_LEN > max_len ||
+         hdr[2] != RPL_RH_TYPE_SRH ||
+         (hdr[4] >> 4) != (hdr[4] & 0x0f) ||
+         hdr[6] != 0 || hdr[7] != 0) {
+        break;
+      }
+      size = 16 - (hdr[4] & 0x0f);
+      for(type = SICSLOWPAN_6LORH_TYPE_SRH_1;
+          type <= SICSLOWPAN_6LORH_TYPE_SRH_16 && lorh_srh_size[type] != size;
+          type++);
+      n = hdr[3];
+      hlen = (hdr[1] + 1) * 8;
+      if(type > SICSLOWPAN_6LORH_TYPE_SRH_16 ||
+         n == 0 || n > SICSLOWPAN_6LORH_SIZE_MASK + 1 ||
+         hlen != RPL_SRH_HDR_LEN + n * size + SRH_PAD(n, size) ||
+         (hdr[5] >> 4) != SRH_PAD(n, size) ||
+         ext_hdr_len + hlen > max_len ||
+         lorh + 2 + n * size > rime_ptr + LORH_MAX_LEN) {
+        break;
+      }
+      lorh[0] = SICSLOWPAN_6LORH_CRITICAL | (n - 1);
+      lorh[1] = type;
+      memcpy(lorh + 2, hdr + RPL_SRH_HDR_LEN, n * size);
+      lorh += 2 + n * size;
+    } else {
+      break;
+    }
+    PRINTF("6LoRH: compressed extension header %u (%u bytes)\n", *nh, hlen);
+    *nh = hdr[0];
+    ext_hdr_len += hlen;
+  }
+
+  if(ext_hdr_len == 0) {
+    return 0;
+  }
+  rime_ptr[0] = SICSLOWPAN_DISPATCH_PAGE_1;
+  return lorh - rime_ptr;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Parse the 6LoRH headers that follow a page 1 dispatch in the
+ * rime buffer
+ * \return 1 if they can be uncompressed, 0 if the packet must be
+ * dropped
+ *
+ * Only the length of the extension headers they stand for is computed
+ * here, and rime_hdr_len is moved to the IPHC header. The headers are
+ * written by uncompress_6lorh(), once IPHC has been uncompressed.
+ * Unknown elective 6LoRH headers are skipped, unknown critical ones
+ * cause the packet to be dropped.
+ */
+static int
+parse_6lorh(void)
+{
+  uint8_t *lorh;
+  uint16_t offset, len;
+  uint8_t n, size;
+
+  offset = rime_hdr_len + 1;
+  lorh_offset = offset;
+  len = 0;
+  while(offset + 2 <= packetbuf_datalen()) {
+    lorh = rime_ptr + offset;
+    if((lorh[0] & 0xc0) != 0x80) {
+      /* Not a 6LoRH header (10xxxxxx): IPHC */
+      break;
+    }
+    if((lorh[0] & SICSLOWPAN_6LORH_MASK) == SICSLOWPAN_6LORH_ELECTIVE) {
+      /* The size of elective headers is the length of their value */
+      offset += 2 + (lorh[0] & SICSLOWPAN_6LORH_SIZE_MASK);
+      continue;
+    }
+    n = (lorh[0] & SICSLOWPAN_6LORH_SIZE_MASK) + 1;
+    if(lorh[1] == SICSLOWPAN_6LORH_TYPE_RPI) {
+      offset += 2 + ((lorh[0] & SICSLOWPAN_6LORH_RPI_I) ? 0 : 1) +
+        ((lorh[0] & SICSLOWPAN_6LORH_RPI_K) ? 1 : 2);
+      len += RPL_HOP_BY_HOP_LEN;
+    } else if(lorh[1] <= SICSLOWPAN_6LORH_TYPE_SRH_16) {
+      size = lorh_srh_size[lorh[1]];
+      offset += 2 + n * size;
+      len += RPL_SRH_HDR_LEN + n * size + SRH_PAD(n, size);
+    } else {
+      PRINTF("6LoRH: unsupported critical header type %u\n", lorh[1]);
+      return 0;
+    }
+  }
+
+  if(offset >= packetbuf_datalen() || len > EXT_HDR_MAX_LEN) {
+    return 0;
+  }
+  rime_hdr_len = offset;
+  ext_hdr_len = len;
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Uncompress 6LoRH headers into IPv6 extension headers, right
+ * after the IPv6 header in sicslowpan_buf
+ * \param lorh The first 6LoRH header in the rime buffer
+ * \param end The end of the 6LoRH headers in the rime buffer
+ *
+ * The next header of the IPv6 header, already uncompressed, becomes
+ * the one of the last extension header.
+ */
+static void
+uncompress_6lorh(uint8_t *lorh, uint8_t *end)
+{
+  uint8_t *hdr, *next;
+  uint8_t nh, n, size;
+
+  nh = SICSLOWPAN_IP_BUF->proto;
+  next = &SICSLOWPAN_IP_BUF->proto;
+  hdr = (uint8_t *)SICSLOWPAN_IP_BUF + UIP_IPH_LEN;
+
+  while(lorh < end) {
+    n = (lorh[0] & SICSLOWPAN_6LORH_SIZE_MASK) + 1;
+    if((lorh[0] & SICSLOWPAN_6LORH_MASK) == SICSLOWPAN_6LORH_ELECTIVE) {
+      lorh += 2 + (lorh[0] & SICSLOWPAN_6LORH_SIZE_MASK);
+    } else if(lorh[1] == SICSLOWPAN_6LORH_TYPE_RPI) {
+      *next = UIP_PROTO_HBHO;
+      next = hdr;
+      hdr[1] = 0;
+      hdr[2] = UIP_EXT_HDR_OPT_RPL;
+      hdr[3] = RPL_HDR_OPT_LEN;
+      hdr[4] = (lorh[0] & (SICSLOWPAN_6LORH_RPI_O | SICSLOWPAN_6LORH_RPI_R |
+                           SICSLOWPAN_6LORH_RPI_F)) << 3;
+      n = 2;
+      hdr[5] = (lorh[0] & SICSLOWPAN_6LORH_RPI_I) ? 0 : lorh[n++];
+      hdr[6] = (lorh[0] & SICSLOWPAN_6LORH_RPI_K) ? 0 : lorh[n++];
+      hdr[7] = lorh[n++];
+      lorh += n;
+      hdr += RPL_HOP_BY_HOP_LEN;
+    } else {
+      size = lorh_srh_size[lorh[1]];
+      *next = UIP_PROTO_ROUTING;
+      next = hdr;
+      hdr[1] = (n * size + SRH_PAD(n, size)) / 8;
+      hdr[2] = RPL_RH_TYPE_SRH;
+      hdr[3] = n;
+      hdr[4] = ((16 - size) << 4) | (16 - size);
+      hdr[5] = SRH_PAD(n, size) << 4;
+      hdr[6] = hdr[7] = 0;
+      memcpy(hdr + RPL_SRH_HDR_LEN, lorh + 2, n * size);
+      memset(hdr + RPL_SRH_HDR_LEN + n * size, 0, SRH_PAD(n, size));
+      lorh += 2 + n * size;
+      hdr += RPL_SRH_HDR_LEN + n * size + SRH_PAD(n, size);
+    }
+  }
+  *next = nh;
+}
+/** @} */
+#endif /* SICSLOWPAN_6LORH */
+
 /*--------------------------------------------------------------------*/
 /**
  * \brief Compress IP/UDP header
@@ -488,7 +889,7 @@ uncompress_addr(uip_ipaddr_t *ipaddr, uint8_t const prefix[],
 static void
 compress_hdr_hc06(rimeaddr_t *rime_destaddr)
 {
-  uint8_t tmp, iphc0, iphc1;
+  uint8_t tmp, iphc0, iphc1, nh;
 #if DEBUG
   { uint16_t ndx;
     PRINTF("before compression (%d): ", UIP_IP_BUF->len[1]);
@@ -500,7 +901,13 @@ compress_hdr_hc06(rimeaddr_t *rime_destaddr)
   }
 #endif
 
-  hc06_ptr = rime_ptr + 2;
+  /* The next header after the extension headers we compress */
+  nh = UIP_IP_BUF->proto;
+#if SICSLOWPAN_6LORH
+  rime_hdr_len = compress_6lorh(&nh);
+#endif /* SICSLOWPAN_6LORH */
+
+  hc06_ptr = rime_ptr + rime_hdr_len + 2;
   /*
    * As we copy some bit-length fields, in the IPHC encoding bytes,
    * we sometimes use |=
@@ -577,17 +984,17 @@ compress_hdr_hc06(rimeaddr_t *rime_destaddr)
 
   /* Next header. We compress it if UDP */
 #if UIP_CONF_UDP || UIP_CONF_ROUTER
-  if(UIP_IP_BUF->proto == UIP_PROTO_UDP) {
+  if(nh == UIP_PROTO_UDP) {
     iphc0 |= SICSLOWPAN_IPHC_NH_C;
   }
 #endif /*UIP_CONF_UDP*/
 #ifdef SICSLOWPAN_NH_COMPRESSOR 
-  if(SICSLOWPAN_NH_COMPRESSOR.is_compressable(UIP_IP_BUF->proto)) {
+  if(EXT_HDR_LEN == 0 && SICSLOWPAN_NH_COMPRESSOR.is_compressable(nh)) {
     iphc0 |= SICSLOWPAN_IPHC_NH_C;
   }
 #endif
   if ((iphc0 & SICSLOWPAN_IPHC_NH_C) == 0) {
-    *hc06_ptr = UIP_IP_BUF->proto;
+    *hc06_ptr = nh;
     hc06_ptr += 1;
   }
 
@@ -696,11 +1103,11 @@ compress_hdr_hc06(rimeaddr_t *rime_destaddr)
     }
   }
 
-  uncomp_hdr_len = UIP_IPH_LEN;
+  uncomp_hdr_len = UIP_IPH_LEN + EXT_HDR_LEN;
 
 #if UIP_CONF_UDP || UIP_CONF_ROUTER
   /* UDP header compression */
-  if(UIP_IP_BUF->proto == UIP_PROTO_UDP) {
+  if(nh == UIP_PROTO_UDP) {
     PRINTF("IPHC: Uncompressed UDP ports on send side: %x, %x\n",
 	   UIP_HTONS(UIP_UDP_BUF->srcport), UIP_HTONS(UIP_UDP_BUF->destport));
     /* Mask out the last 4 bits can be used as a mask */
@@ -751,7 +1158,9 @@ compress_hdr_hc06(rimeaddr_t *rime_destaddr)
 
 #ifdef SICSLOWPAN_NH_COMPRESSOR
   /* if nothing to compress just return zero  */
-  hc06_ptr += SICSLOWPAN_NH_COMPRESSOR.compress(hc06_ptr, &uncomp_hdr_len);
+  if(EXT_HDR_LEN == 0) {
+    hc06_ptr += SICSLOWPAN_NH_COMPRESSOR.compress(hc06_ptr, &uncomp_hdr_len);
+  }
 #endif
 
   /* before the rime_hdr_len operation */
@@ -782,6 +1191,10 @@ static void
 uncompress_hdr_hc06(uint16_t ip_len)
 {
   uint8_t tmp, iphc0, iphc1;
+#if SICSLOWPAN_6LORH
+  /* the 6LoRH headers, if any, end where IPHC starts */
+  uint8_t lorh_end = rime_hdr_len;
+#endif /* SICSLOWPAN_6LORH */
   /* at least two byte will be used for the encoding */
   hc06_ptr = rime_ptr + rime_hdr_len + 2;
 
@@ -994,6 +1407,7 @@ uncompress_hdr_hc06(uint16_t ip_len)
     }
 #endif
   }
+  uncomp_hdr_len += EXT_HDR_LEN;
 
   rime_hdr_len = hc06_ptr - rime_ptr;
   
@@ -1010,9 +1424,20 @@ uncompress_hdr_hc06(uint16_t ip_len)
   
   /* length field in UDP header */
   if(SICSLOWPAN_IP_BUF->proto == UIP_PROTO_UDP) {
+#if SICSLOWPAN_6LORH
+    SET16((uint8_t *)&SICSLOWPAN_UDP_BUF->udplen, 0,
+          GET16(SICSLOWPAN_IP_BUF->len, 0) - ext_hdr_len);
+#else /* SICSLOWPAN_6LORH */
     memcpy(&SICSLOWPAN_UDP_BUF->udplen, &SICSLOWPAN_IP_BUF->len[0], 2);
+#endif /* SICSLOWPAN_6LORH */
   }
 
+#if SICSLOWPAN_6LORH
+  if(ext_hdr_len > 0) {
+    uncompress_6lorh(rime_ptr + lorh_offset, rime_ptr + lorh_end);
+  }
+#endif /* SICSLOWPAN_6LORH */
+
   return;
 }
 /** @} */
@@ -1344,6 +1769,41 @@ send_packet(rimeaddr_t *dest)
   watchdog_periodic();
 }
 /*--------------------------------------------------------------------*/
+/**
+ * \brief Calculate NETSTACK_FRAMER's header length, that will be
+ * added in the NETSTACK_RDC.
+ * \param dest the link layer destination address of the packet
+ *
+ * We calculate it here only to make a better decision of whether
+ * the outgoing packet needs to be fragmented or not. The packetbuf is
+ * cleared, but the data that was put in it is not erased.
+ */
+static int
+get_framer_hdrlen(const rimeaddr_t *dest)
+{
+#define USE_FRAMER_HDRLEN 1
+#if USE_FRAMER_HDRLEN
+  int framer_hdrlen;
+
+  packetbuf_clear();
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, dest);
+  framer_hdrlen = NETSTACK_FRAMER.create();
+  if(framer_hdrlen < 0) {
+    /* Framing failed, we assume the maximum header length */
+    framer_hdrlen = 21;
+  }
+  packetbuf_clear();
+
+  /* We must set the max transmissions attribute again after clearing
+     the buffer. */
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
+                     SICSLOWPAN_MAX_MAC_TRANSMISSIONS);
+  return framer_hdrlen;
+#else /* USE_FRAMER_HDRLEN */
+  return 21;
+#endif /* USE_FRAMER_HDRLEN */
+}
+/*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
  *  network using 6lowpan.
  *  \param localdest The MAC address of the destination
@@ -1367,6 +1827,9 @@ output(uip_lladdr_t *localdest)
   /* init */
   uncomp_hdr_len = 0;
   rime_hdr_len = 0;
+#if SICSLOWPAN_6LORH
+  ext_hdr_len = 0;
+#endif /* SICSLOWPAN_6LORH */
 
   /* reset rime buffer */
   packetbuf_clear();
@@ -1425,27 +1888,7 @@ output(uip_lladdr_t *localdest)
   }
   PRINTFO("sicslowpan output: header of len %d\n", rime_hdr_len);
 
-  /* Calculate NETSTACK_FRAMER's header length, that will be added in the NETSTACK_RDC.
-   * We calculate it here only to make a better decision of whether the outgoing packet
-   * needs to be fragmented or not. */
-#define USE_FRAMER_HDRLEN 1
-#if USE_FRAMER_HDRLEN
-  packetbuf_clear();
-  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
-  framer_hdrlen = NETSTACK_FRAMER.create();
-  if(framer_hdrlen < 0) {
-    /* Framing failed, we assume the maximum header length */
-    framer_hdrlen = 21;
-  }
-  packetbuf_clear();
-
-  /* We must set the max transmissions attribute again after clearing
-     the buffer. */
-  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
-                     SICSLOWPAN_MAX_MAC_TRANSMISSIONS);
-#else /* USE_FRAMER_HDRLEN */
-  framer_hdrlen = 21;
-#endif /* USE_FRAMER_HDRLEN */
+  framer_hdrlen = get_framer_hdrlen(&dest);
 
   if((int)uip_len - (int)uncomp_hdr_len > (int)MAC_MAX_PAYLOAD - framer_hdrlen - (int)rime_hdr_len) {
 #if SICSLOWPAN_CONF_FRAG
@@ -1568,6 +2011,227 @@ output(uip_lladdr_t *localdest)
   return 1;
 }
 
+#if SICSLOWPAN_FRAG_FORWARDING
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Route the first fragment of a packet and relay it to the
+ * next hop, without reassembling the packet.
+ * \param tag the datagram tag of the fragment
+ * \param size the datagram size of the fragment
+ * \param len the number of bytes of the IP packet in the fragment
+ * \return 1 if the fragment was relayed or dropped, 0 if the packet
+ * must be reassembled and handed to the IP layer
+ *
+ * The uncompressed headers and the payload of the fragment are in
+ * uip_buf. Only packets that the IP layer would forward unchanged,
+ * except for the hop limit and the RPL option, to a known neighbor
+ * are relayed. A virtual reassembly entry is then created so that
+ * the following fragments are relayed as they arrive.
+ *
+ * The compressed headers often grow on the way, for instance when
+ * the source IID could be elided by the previous hop only. The bytes
+ * that no longer fit in the first fragment are then sent in an extra
+ * FRAGN, so the offsets of the following fragments stay valid.
+ */
+static uint8_t
+forward_first_fragment(uint16_t tag, uint16_t size, uint16_t len)
+{
+  struct sicslowpan_vrb *v;
+  uip_ipaddr_t *nexthop;
+  uip_ds6_route_t *route;
+  uip_ds6_nbr_t *nbr;
+  rimeaddr_t sender, dest;
+  struct queuebuf *q;
+  int framer_hdrlen, max_payload;
+  uint16_t extra_offset, extra_len;
+
+  /* Leave to the IP layer the packets it must deliver, drop or
+     answer with an ICMP error. */
+  if(len >= size || size > UIP_LINK_MTU ||
+     uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_mcast(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_link_local(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_link_local(&UIP_IP_BUF->srcipaddr) ||
+     uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr) ||
+     uip_is_addr_loopback(&UIP_IP_BUF->destipaddr) ||
+     UIP_IP_BUF->ttl <= 1) {
+    return 0;
+  }
+
+#if UIP_CONF_IPV6_RPL
+  /* RPL inserts its hop-by-hop option in the packets it forwards. We
+     can only relay the packets in which it is already present, as it
+     is then updated in place. */
+  if(len < UIP_IPH_LEN + sizeof(struct uip_hbho_hdr) +
+     sizeof(struct uip_ext_hdr_opt_rpl) ||
+     UIP_IP_BUF->proto != UIP_PROTO_HBHO ||
+     UIP_HBHO_BUF->len != 0 ||
+     UIP_EXT_HDR_OPT_RPL_BUF->opt_type != UIP_EXT_HDR_OPT_RPL ||
+     (UIP_EXT_HDR_OPT_RPL_BUF->flags & RPL_HDR_OPT_FWD_ERR)) {
+    return 0;
+  }
+#else /* UIP_CONF_IPV6_RPL */
+  if(UIP_IP_BUF->proto == UIP_PROTO_HBHO) {
+    return 0;
+  }
+#endif /* UIP_CONF_IPV6_RPL */
+
+  /* Next hop determination, as in tcpip_ipv6_output(). */
+  if(uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)) {
+    nexthop = &UIP_IP_BUF->destipaddr;
+  } else {
+    route = uip_ds6_route_lookup(&UIP_IP_BUF->destipaddr);
+    if(route == NULL) {
+      nexthop = uip_ds6_defrt_choose();
+    } else {
+      nexthop = uip_ds6_route_nexthop(route);
+    }
+  }
+  if(nexthop == NULL) {
+    return 0;
+  }
+  nbr = uip_ds6_nbr_lookup(nexthop);
+  if(nbr == NULL || nbr->state == NBR_INCOMPLETE) {
+    return 0;
+  }
+
+  v = memb_alloc(&vrb_memb);
+  if(v == NULL) {
+    PRINTFI("sicslowpan input: no free relay entry\n");
+    return 0;
+  }
+
+#if UIP_CONF_IPV6_RPL
+  uip_ext_len = 0;
+  if(rpl_verify_header(2)) {
+    PRINTFI("sicslowpan input: RPL option error, dropping fragment\n");
+    memb_free(&vrb_memb, v);
+    return 1;
+  }
+  rpl_update_header_empty();
+  if(rpl_update_header_final(nexthop)) {
+    memb_free(&vrb_memb, v);
+    return 1;
+  }
+#endif /* UIP_CONF_IPV6_RPL */
+  UIP_IP_BUF->ttl = UIP_IP_BUF->ttl - 1;
+
+  rimeaddr_copy(&sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  rimeaddr_copy(&dest, (const rimeaddr_t *)uip_ds6_nbr_get_ll(nbr));
+
+  /* Compress the updated headers in a new first fragment. */
+  uncomp_hdr_len = 0;
+  rime_hdr_len = 0;
+  framer_hdrlen = get_framer_hdrlen(&dest);
+  rime_ptr = packetbuf_dataptr();
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC1
+  compress_hdr_hc1(&dest);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC1 */
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6
+  compress_hdr_ipv6(&dest);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6 */
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  compress_hdr_hc06(&dest);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+
+  max_payload = (int)MAC_MAX_PAYLOAD - framer_hdrlen -
+    rime_hdr_len - SICSLOWPAN_FRAG1_HDR_LEN;
+  extra_offset = len;
+  if((int)len - uncomp_hdr_len > max_payload) {
+    /* The first fragment must end on a multiple of 8 bytes of the
+       packet, where the extra FRAGN starts. */
+    extra_offset = (uncomp_hdr_len + max_payload) & 0xfff8;
+  }
+  extra_len = len - extra_offset;
+  if(uncomp_hdr_len > extra_offset || max_payload < 0 ||
+     SICSLOWPAN_FRAGN_HDR_LEN + extra_len >
+     (int)MAC_MAX_PAYLOAD - framer_hdrlen) {
+    PRINTFI("sicslowpan input: relayed headers too large, dropping\n");
+    memb_free(&vrb_memb, v);
+    return 1;
+  }
+  rime_payload_len = extra_offset - uncomp_hdr_len;
+
+  memmove(rime_ptr + SICSLOWPAN_FRAG1_HDR_LEN, rime_ptr, rime_hdr_len);
+  SET16(RIME_FRAG_PTR, RIME_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | size));
+  SET16(RIME_FRAG_PTR, RIME_FRAG_TAG, my_tag);
+  rime_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
+  memcpy(rime_ptr + rime_hdr_len,
+         (uint8_t *)UIP_IP_BUF + uncomp_hdr_len, rime_payload_len);
+  packetbuf_set_datalen(rime_hdr_len + rime_payload_len);
+
+  rimeaddr_copy(&v->sender, &sender);
+  v->tag = tag;
+  v->size = size;
+  v->out_tag = my_tag++;
+  v->processed_ip_in_len = len;
+  rimeaddr_copy(&v->nexthop, &dest);
+  timer_set(&v->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  list_add(vrb_list, v);
+
+  PRINTFI("sicslowpan input: relaying packet (len %d, tag %d -> %d)\n",
+          size, tag, v->out_tag);
+  UIP_STAT(++uip_stat.ip.forwarded);
+  if(extra_len == 0) {
+    send_packet(&dest);
+    return 1;
+  }
+
+  q = queuebuf_new_from_packetbuf();
+  if(q == NULL) {
+    PRINTFI("sicslowpan input: could not allocate queuebuf, dropping fragment\n");
+    vrb_free(v);
+    return 1;
+  }
+  send_packet(&dest);
+  queuebuf_to_packetbuf(q);
+  queuebuf_free(q);
+
+  PRINTFI("sicslowpan input: extra fragment (offset %d, len %d)\n",
+          extra_offset >> 3, extra_len);
+  SET16(RIME_FRAG_PTR, RIME_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAGN << 8) | size));
+  RIME_FRAG_PTR[RIME_FRAG_OFFSET] = extra_offset >> 3;
+  memcpy(rime_ptr + SICSLOWPAN_FRAGN_HDR_LEN,
+         (uint8_t *)UIP_IP_BUF + extra_offset, extra_len);
+  packetbuf_set_datalen(SICSLOWPAN_FRAGN_HDR_LEN + extra_len);
+  send_packet(&dest);
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Relay a subsequent fragment of a packet to the next hop of
+ * its virtual reassembly entry.
+ *
+ * The fragment is sent unchanged, except for its datagram tag.
+ */
+static void
+relay_fragment(struct sicslowpan_vrb *v)
+{
+  uint16_t len;
+  rimeaddr_t dest;
+
+  len = packetbuf_datalen();
+  v->processed_ip_in_len += len - SICSLOWPAN_FRAGN_HDR_LEN;
+
+  /* uip_buf is not in use while a frame is being received */
+  memcpy(uip_buf, packetbuf_dataptr(), len);
+  packetbuf_copyfrom(uip_buf, len);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
+                     SICSLOWPAN_MAX_MAC_TRANSMISSIONS);
+  rime_ptr = packetbuf_dataptr();
+  SET16(RIME_FRAG_PTR, RIME_FRAG_TAG, v->out_tag);
+
+  PRINTFI("sicslowpan input: relaying fragment (tag %d -> %d)\n",
+          v->tag, v->out_tag);
+  rimeaddr_copy(&dest, &v->nexthop);
+  if(v->processed_ip_in_len >= v->size) {
+    vrb_free(v);
+  }
+  send_packet(&dest);
+}
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 /*--------------------------------------------------------------------*/
 /** \brief Process a received 6lowpan packet.
  *  \param r The MAC layer
@@ -1593,21 +2257,24 @@ input(void)
   /* tag of the fragment */
   uint16_t frag_tag = 0;
   uint8_t first_fragment = 0, last_fragment = 0;
+  /* reassembly context of the fragment */
+  struct sicslowpan_reass *reass = NULL;
+#if SICSLOWPAN_FRAG_FORWARDING
+  struct sicslowpan_vrb *vrb;
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 #endif /*SICSLOWPAN_CONF_FRAG*/
 
   /* init */
   uncomp_hdr_len = 0;
   rime_hdr_len = 0;
+#if SICSLOWPAN_6LORH
+  ext_hdr_len = 0;
+#endif /* SICSLOWPAN_6LORH */
 
   /* The MAC puts the 15.4 payload inside the RIME data buffer */
   rime_ptr = packetbuf_dataptr();
 
 #if SICSLOWPAN_CONF_FRAG
-  /* if reassembly timed out, cancel it */
-  if(timer_expired(&reass_timer)) {
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
-  }
   /*
    * Since we don't support the mesh and broadcast header, the first header
    * we look for is the fragmentation header
@@ -1623,7 +2290,6 @@ input(void)
       PRINTFI("size %d, tag %d, offset %d)\n",
              frag_size, frag_tag, frag_offset);
       rime_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
-      /*      printf("frag1 %d %d\n", reass_tag, frag_tag);*/
       first_fragment = 1;
       is_fragment = 1;
       break;
@@ -1639,72 +2305,67 @@ input(void)
       PRINTFI("size %d, tag %d, offset %d)\n",
              frag_size, frag_tag, frag_offset);
       rime_hdr_len += SICSLOWPAN_FRAGN_HDR_LEN;
-
-      /* If this is the last fragment, we may shave off any extrenous
-         bytes at the end. We must be liberal in what we accept. */
-      PRINTFI("last_fragment?: processed_ip_in_len %d rime_payload_len %d frag_size %d\n",
-              processed_ip_in_len, packetbuf_datalen() - rime_hdr_len, frag_size);
-
-      if(processed_ip_in_len + packetbuf_datalen() - rime_hdr_len >= frag_size) {
-        last_fragment = 1;
-      }
       is_fragment = 1;
       break;
     default:
       break;
   }
 
-  /* We are currently reassembling a packet, but have just received the first
-   * fragment of another packet. We can either ignore it and hope to receive
-   * the rest of the under-reassembly packet fragments, or we can discard the
-   * previous packet altogether, and start reassembling the new packet.
-   *
-   * We discard the previous packet, and start reassembling the new packet.
-   * This lessens the negative impacts of too high SICSLOWPAN_REASS_MAXAGE.
-   */
-#define PRIORITIZE_NEW_PACKETS 1
-#if PRIORITIZE_NEW_PACKETS
-  if(processed_ip_in_len > 0 && first_fragment
-      && !rimeaddr_cmp(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
-  }
-#endif /* PRIORITIZE_NEW_PACKETS */
-
-  if(processed_ip_in_len > 0) {
-    /* reassembly is ongoing */
-    /*    printf("frag %d %d\n", reass_tag, frag_tag);*/
-    if((frag_size > 0 &&
-        (frag_size != sicslowpan_len ||
-         reass_tag  != frag_tag ||
-         !rimeaddr_cmp(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))))  ||
-       frag_size == 0) {
-      /*
-       * the packet is a fragment that does not belong to the packet
-       * being reassembled or the packet is not a fragment.
-       */
-      PRINTFI("sicslowpan input: Dropping 6lowpan packet that is not a fragment of the packet currently being reassembled\n");
+  if(is_fragment) {
+    if(frag_size == 0 || frag_size > UIP_BUFSIZE - UIP_LLH_LEN) {
+      PRINTFI("sicslowpan input: Dropping fragment of a too large packet\n");
       return;
     }
-  } else {
+
+#if SICSLOWPAN_FRAG_FORWARDING
+    /* Fragments of a packet we are relaying are sent on at once. */
+    vrb = vrb_lookup(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                     frag_tag, frag_size);
+    if(vrb != NULL) {
+      if(!first_fragment) {
+        relay_fragment(vrb);
+      }
+      return;
+    }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
     /*
-     * reassembly is off
-     * start it if we received a fragment
+     * Look for the reassembly context of the fragment. The first
+     * fragment of a packet starts a new reassembly. Other fragments
+     * that do not belong to any packet being reassembled are dropped.
      */
-    if((frag_size > 0) && (frag_size <= UIP_BUFSIZE)) {
-      /* We are currently not reassembling a packet, but have received a packet fragment
-       * that is not the first one. */
-      if(is_fragment && !first_fragment) {
+    reass = reass_lookup(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                         frag_tag, frag_size);
+    if(reass == NULL) {
+      if(!first_fragment) {
+        PRINTFI("sicslowpan input: Dropping 6lowpan fragment that does not belong to a packet being reassembled\n");
+        return;
+      }
+#if !SICSLOWPAN_FRAG_FORWARDING
+      reass = reass_new(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                        frag_tag, frag_size);
+      if(reass == NULL) {
         return;
       }
+#endif /* !SICSLOWPAN_FRAG_FORWARDING */
+    }
+    /* Without a reassembly context yet, the first fragment is
+       uncompressed in uip_buf, from where it may be relayed. */
+    sicslowpan_buf = reass != NULL ? reass->buf.u8 : uip_buf;
 
-      sicslowpan_len = frag_size;
-      reass_tag = frag_tag;
-      timer_set(&reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
-      PRINTFI("sicslowpan input: INIT FRAGMENTATION (len %d, tag %d)\n",
-             sicslowpan_len, reass_tag);
-      rimeaddr_copy(&frag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+    /* If this is the last fragment, we may shave off any extrenous
+       bytes at the end. We must be liberal in what we accept. */
+    if(!first_fragment) {
+      PRINTFI("last_fragment?: processed_ip_in_len %d rime_payload_len %d frag_size %d\n",
+              reass->processed_ip_in_len, packetbuf_datalen() - rime_hdr_len,
+              frag_size);
+      if(reass->processed_ip_in_len + packetbuf_datalen() - rime_hdr_len >= frag_size) {
+        last_fragment = 1;
+      }
     }
+  } else {
+    /* Not fragmented: uncompress the packet directly in uip_buf. */
+    sicslowpan_buf = uip_buf;
   }
 
   if(rime_hdr_len == SICSLOWPAN_FRAGN_HDR_LEN) {
@@ -1714,6 +2375,16 @@ input(void)
 #endif /* SICSLOWPAN_CONF_FRAG */
 
   /* Process next dispatch and headers */
+#if SICSLOWPAN_6LORH
+  if(RIME_HC1_PTR[RIME_HC1_DISPATCH] == SICSLOWPAN_DISPATCH_PAGE_1) {
+    /* The 6LoRH headers are always followed by IPHC. */
+    if(!parse_6lorh() ||
+       (RIME_HC1_PTR[RIME_HC1_DISPATCH] & 0xe0) != SICSLOWPAN_DISPATCH_IPHC) {
+      PRINTFI("sicslowpan input: bad 6LoRH headers, dropping packet\n");
+      return;
+    }
+  }
+#endif /* SICSLOWPAN_6LORH */
 #if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
   if((RIME_HC1_PTR[RIME_HC1_DISPATCH] & 0xe0) == SICSLOWPAN_DISPATCH_IPHC) {
     PRINTFI("sicslowpan input: IPHC\n");
@@ -1766,54 +2437,73 @@ input(void)
   {
     int req_size = UIP_LLH_LEN + uncomp_hdr_len + (uint16_t)(frag_offset << 3)
         + rime_payload_len;
-    if(req_size > sizeof(sicslowpan_buf)) {
+    if(req_size > UIP_BUFSIZE) {
       PRINTF(
           "SICSLOWPAN: packet dropped, minimum required SICSLOWPAN_IP_BUF size: %d+%d+%d+%d=%d (current size: %d)\n",
           UIP_LLH_LEN, uncomp_hdr_len, (uint16_t)(frag_offset << 3),
-          rime_payload_len, req_size, sizeof(sicslowpan_buf));
+          rime_payload_len, req_size, UIP_BUFSIZE);
       return;
     }
   }
 
   memcpy((uint8_t *)SICSLOWPAN_IP_BUF + uncomp_hdr_len + (uint16_t)(frag_offset << 3), rime_ptr + rime_hdr_len, rime_payload_len);
-  
-  /* update processed_ip_in_len if fragment, sicslowpan_len otherwise */
+
+#if SICSLOWPAN_FRAG_FORWARDING
+  if(first_fragment && reass == NULL) {
+    /* Relay the packet if it is not for us, reassemble it otherwise. */
+    if(forward_first_fragment(frag_tag, frag_size,
+                              uncomp_hdr_len + rime_payload_len)) {
+      return;
+    }
+    reass = reass_new(packetbuf_addr(PACKETBUF_ADDR_SENDER),
+                      frag_tag, frag_size);
+    if(reass == NULL) {
+      return;
+    }
+    memcpy(reass->buf.u8 + UIP_LLH_LEN, UIP_IP_BUF,
+           uncomp_hdr_len + rime_payload_len);
+    sicslowpan_buf = reass->buf.u8;
+  }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
+  /* update processed_ip_in_len if fragment, uip_len otherwise */
 
 #if SICSLOWPAN_CONF_FRAG
-  if(frag_size > 0) {
+  if(reass != NULL) {
     /* Add the size of the header only for the first fragment. */
     if(first_fragment != 0) {
-      processed_ip_in_len += uncomp_hdr_len;
+      reass->processed_ip_in_len += uncomp_hdr_len;
     }
     /* For the last fragment, we are OK if there is extrenous bytes at
        the end of the packet. */
     if(last_fragment != 0) {
-      processed_ip_in_len = frag_size;
+      reass->processed_ip_in_len = frag_size;
     } else {
-      processed_ip_in_len += rime_payload_len;
+      reass->processed_ip_in_len += rime_payload_len;
     }
-    PRINTF("processed_ip_in_len %d, rime_payload_len %d\n", processed_ip_in_len, rime_payload_len);
+    PRINTF("processed_ip_in_len %d, rime_payload_len %d\n",
+           reass->processed_ip_in_len, rime_payload_len);
 
-  } else {
-#endif /* SICSLOWPAN_CONF_FRAG */
-    sicslowpan_len = rime_payload_len + uncomp_hdr_len;
-#if SICSLOWPAN_CONF_FRAG
-  }
+    if(reass->processed_ip_in_len != reass->size) {
+      /* Wait for more fragments. */
+      return;
+    }
 
-  /*
-   * If we have a full IP packet in sicslowpan_buf, deliver it to
-   * the IP stack
-   */
-  PRINTF("sicslowpan_init processed_ip_in_len %d, sicslowpan_len %d\n",
-         processed_ip_in_len, sicslowpan_len);
-  if(processed_ip_in_len == 0 || (processed_ip_in_len == sicslowpan_len)) {
+    /*
+     * We have a full IP packet in the reassembly buffer, deliver it
+     * to the IP stack
+     */
     PRINTFI("sicslowpan input: IP packet ready (length %d)\n",
-           sicslowpan_len);
-    memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)SICSLOWPAN_IP_BUF, sicslowpan_len);
-    uip_len = sicslowpan_len;
-    sicslowpan_len = 0;
-    processed_ip_in_len = 0;
+            reass->size);
+    memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)SICSLOWPAN_IP_BUF, reass->size);
+    uip_len = reass->size;
+    reass_free(reass);
+    sicslowpan_buf = uip_buf;
+  } else
 #endif /* SICSLOWPAN_CONF_FRAG */
+  {
+    uip_len = rime_payload_len + uncomp_hdr_len;
+  }
 
 #if DEBUG
     {
@@ -1834,9 +2524,6 @@ input(void)
     }
 
     tcpip_input();
-#if SICSLOWPAN_CONF_FRAG
-  }
-#endif /* SICSLOWPAN_CONF_FRAG */
 }
 /** @} */
 
@@ -80,6 +80,28 @@
 #define SICSLOWPAN_DISPATCH_IPHC                    0x60 /* 011xxxxx = ... */
 #define SICSLOWPAN_DISPATCH_FRAG1                   0xc0 /* 11000xxx */
 #define SICSLOWPAN_DISPATCH_FRAGN                   0xe0 /* 11100xxx */
+#define SICSLOWPAN_DISPATCH_PAGE_1                  0xf1 /* 11110001 */
+/** @} */
+
+/**
+ * \name 6LoRH encoding (draft-ietf-roll-routing-dispatch), in page 1
+ * @{
+ */
+#define SICSLOWPAN_6LORH_MASK                       0xe0
+#define SICSLOWPAN_6LORH_CRITICAL                   0x80 /* 100xxxxx */
+#define SICSLOWPAN_6LORH_ELECTIVE                   0xa0 /* 101xxxxx */
+#define SICSLOWPAN_6LORH_SIZE_MASK                  0x1f
+
+#define SICSLOWPAN_6LORH_TYPE_SRH_1                 0 /* up to 4: 16 bytes */
+#define SICSLOWPAN_6LORH_TYPE_SRH_16                4
+#define SICSLOWPAN_6LORH_TYPE_RPI                   5
+#define SICSLOWPAN_6LORH_TYPE_IPINIP                6
+
+#define SICSLOWPAN_6LORH_RPI_O                      0x10
+#define SICSLOWPAN_6LORH_RPI_R                      0x08
+#define SICSLOWPAN_6LORH_RPI_F                      0x04
+#define SICSLOWPAN_6LORH_RPI_I                      0x02
+#define SICSLOWPAN_6LORH_RPI_K                      0x01
 /** @} */
 
 /** \name HC1 encoding
@@ -45,8 +45,12 @@
 #if UIP_CONF_IPV6
 #include "net/uip-nd6.h"
 #include "net/uip-ds6.h"
+#include "net/packetbuf.h"
 #endif
 
+#include "lib/list.h"
+#include "lib/memb.h"
+
 #include <string.h>
 
 #define DEBUG DEBUG_NONE
@@ -106,6 +110,38 @@ enum {
   PACKET_INPUT
 };
 
+/* The number of received packets that are queued while tcpip_process
+   is busy, instead of being dropped. */
+#ifdef UIP_CONF_INPUT_QUEUE_LEN
+#define INPUT_QUEUE_LEN UIP_CONF_INPUT_QUEUE_LEN
+#else
+#define INPUT_QUEUE_LEN 0
+#endif
+
+#if INPUT_QUEUE_LEN > 0
+struct input_packet {
+  struct input_packet *next;
+  uint16_t len;
+#if UIP_CONF_IPV6
+  rimeaddr_t sender;
+#endif /* UIP_CONF_IPV6 */
+  uint8_t buf[UIP_BUFSIZE];
+};
+MEMB(input_packet_memb, struct input_packet, INPUT_QUEUE_LEN);
+LIST(input_queue);
+
+/* Set while tcpip_process handles an event, during which it can not
+   be called for a packet input. */
+static uint8_t busy;
+
+/* The number of bytes of uip_buf that a received packet fills. */
+#if UIP_CONF_IPV6
+#define INPUT_BUF_LEN(len) (UIP_LLH_LEN + (len))
+#else /* UIP_CONF_IPV6 */
+#define INPUT_BUF_LEN(len) (len)
+#endif /* UIP_CONF_IPV6 */
+#endif /* INPUT_QUEUE_LEN > 0 */
+
 /* Called on IP packet output. */
 #if UIP_CONF_IPV6
 
@@ -180,6 +216,20 @@ check_for_tcp_syn(void)
 #endif /* UIP_TCP || UIP_CONF_IP_FORWARD */
 }
 /*---------------------------------------------------------------------------*/
+#if UIP_TCP && UIP_TCP_SEND_WINDOW
+/* Call the application of a connection again if it has just sent a
+   segment and there is room for another one in its send buffer. */
+static void
+check_send_window(struct uip_conn *conn)
+{
+  if(conn != NULL && uip_tcp_sndbuf_ready(conn)) {
+    tcpip_poll_tcp(conn);
+  }
+}
+#else /* UIP_TCP && UIP_TCP_SEND_WINDOW */
+#define check_send_window(conn)
+#endif /* UIP_TCP && UIP_TCP_SEND_WINDOW */
+/*---------------------------------------------------------------------------*/
 static void
 packet_input(void)
 {
@@ -202,6 +252,7 @@ packet_input(void)
 #endif
 #endif /* UIP_CONF_TCP_SPLIT */
       }
+      check_send_window(uip_conn);
     }
     tcpip_is_forwarding = 0;
   }
@@ -221,6 +272,7 @@ packet_input(void)
 #endif
 #endif /* UIP_CONF_TCP_SPLIT */
     }
+    check_send_window(uip_conn);
   }
 #endif /* UIP_CONF_IP_FORWARD */
 }
@@ -443,6 +495,7 @@ eventhandler(process_event_t ev, process_data_t data)
 		PRINTF("tcpip_output after periodic len %d\n", uip_len);
               }
 #endif /* UIP_CONF_IPV6 */
+              check_send_window(uip_conn);
             }
           }
 #endif /* UIP_TCP */
@@ -499,6 +552,7 @@ eventhandler(process_event_t ev, process_data_t data)
           tcpip_output();
         }
 #endif /* UIP_CONF_IPV6 */
+        check_send_window(data);
         /* Start the periodic polling, if it isn't already active. */
         start_periodic_tcp_timer();
       }
@@ -525,10 +579,61 @@ eventhandler(process_event_t ev, process_data_t data)
   };
 }
 /*---------------------------------------------------------------------------*/
+#if INPUT_QUEUE_LEN > 0
+static void
+input_enqueue(void)
+{
+  struct input_packet *p;
+
+  p = memb_alloc(&input_packet_memb);
+  if(p == NULL) {
+    PRINTF("tcpip: input queue full, dropping packet\n");
+    UIP_STAT(++uip_stat.ip.drop);
+    UIP_STAT(++uip_stat.ip.qdrop);
+    return;
+  }
+  memcpy(p->buf, uip_buf, INPUT_BUF_LEN(uip_len));
+  p->len = uip_len;
+#if UIP_CONF_IPV6
+  /* Some of the IPv6 input processing learns the link-layer address
+     of the sender from the packetbuf, which will be reused meanwhile. */
+  rimeaddr_copy(&p->sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+#endif /* UIP_CONF_IPV6 */
+  list_add(input_queue, p);
+  process_poll(&tcpip_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+input_dequeue(void)
+{
+  struct input_packet *p;
+
+  while((p = list_pop(input_queue)) != NULL) {
+    uip_len = p->len;
+    memcpy(uip_buf, p->buf, INPUT_BUF_LEN(uip_len));
+#if UIP_CONF_IPV6
+    uip_ext_len = 0;
+    packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &p->sender);
+#endif /* UIP_CONF_IPV6 */
+    memb_free(&input_packet_memb, p);
+    packet_input();
+  }
+}
+#endif /* INPUT_QUEUE_LEN > 0 */
+/*---------------------------------------------------------------------------*/
 void
 tcpip_input(void)
 {
-  process_post_synch(&tcpip_process, PACKET_INPUT, NULL);
+#if INPUT_QUEUE_LEN > 0
+  /* Queue the packet if tcpip_process can not handle it right away, or
+     if earlier packets are waiting. */
+  if(busy || list_head(input_queue) != NULL) {
+    input_enqueue();
+  } else
+#endif /* INPUT_QUEUE_LEN > 0 */
+  {
+    process_post_synch(&tcpip_process, PACKET_INPUT, NULL);
+  }
   uip_len = 0;
 #if UIP_CONF_IPV6
   uip_ext_len = 0;
@@ -541,6 +646,9 @@ tcpip_ipv6_output(void)
 {
   uip_ds6_nbr_t *nbr = NULL;
   uip_ipaddr_t *nexthop;
+#if UIP_CONF_IPV6_RPL
+  uip_ipaddr_t srh_nexthop;
+#endif /* UIP_CONF_IPV6_RPL */
 
   if(uip_len == 0) {
     return;
@@ -559,6 +667,15 @@ tcpip_ipv6_output(void)
   }
 
   if(!uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)) {
+#if UIP_CONF_IPV6_RPL
+    /* The root of a non-storing mode RPL DAG source routes the
+       packets it sends down the DAG. */
+    if(!rpl_insert_srh()) {
+      uip_len = 0;
+      return;
+    }
+#endif /* UIP_CONF_IPV6_RPL */
+
     /* Next hop determination */
     nbr = NULL;
 
@@ -567,6 +684,10 @@ tcpip_ipv6_output(void)
        nexthop address. */
     if(uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)){
       nexthop = &UIP_IP_BUF->destipaddr;
+#if UIP_CONF_IPV6_RPL
+    } else if(rpl_srh_get_next_hop(&srh_nexthop)) {
+      nexthop = &srh_nexthop;
+#endif /* UIP_CONF_IPV6_RPL */
     } else {
       uip_ds6_route_t *route;
       /* Check if we have a route to the destination address. */
@@ -822,9 +943,23 @@ PROCESS_THREAD(tcpip_process, ev, data)
   rpl_init();
 #endif /* UIP_CONF_IPV6_RPL */
 
+#if INPUT_QUEUE_LEN > 0
+  memb_init(&input_packet_memb);
+  list_init(input_queue);
+#endif /* INPUT_QUEUE_LEN > 0 */
+
   while(1) {
     PROCESS_YIELD();
+#if INPUT_QUEUE_LEN > 0
+    busy = 1;
+    if(ev == PROCESS_EVENT_POLL) {
+      input_dequeue();
+    }
+#endif /* INPUT_QUEUE_LEN > 0 */
     eventhandler(ev, data);
+#if INPUT_QUEUE_LEN > 0
+    busy = 0;
+#endif /* INPUT_QUEUE_LEN > 0 */
   }
   
   PROCESS_END();
@@ -138,6 +138,28 @@ uip_ds6_nbr_get_ll(uip_ds6_nbr_t *nbr)
   return (uip_lladdr_t *)nbr_table_get_lladdr(ds6_neighbors, nbr);
 }
 /*---------------------------------------------------------------------------*/
+uip_ds6_nbr_t *
+uip_ds6_nbr_update_ll(uip_ds6_nbr_t *nbr, uip_lladdr_t *lladdr)
+{
+  uip_ds6_nbr_t *new_nbr;
+
+  new_nbr = nbr_table_update_lladdr(ds6_neighbors, nbr, (rimeaddr_t *)lladdr);
+  if(new_nbr == NULL) {
+    PRINTF("uip_ds6_nbr_update_ll: link addr ");
+    PRINTLLADDR(lladdr);
+    PRINTF(" already used by another neighbor\n");
+    return NULL;
+  }
+#if UIP_CONF_IPV6_QUEUE_PKT
+  if(new_nbr != nbr && new_nbr->packethandle.packet != NULL) {
+    /* The neighbor moved: the lifetime timer of its queued packet
+       refers to the old packet handle */
+    new_nbr->packethandle.packet->lifetimer.ptr = &new_nbr->packethandle;
+  }
+#endif /* UIP_CONF_IPV6_QUEUE_PKT */
+  return new_nbr;
+}
+/*---------------------------------------------------------------------------*/
 int
 uip_ds6_nbr_num(void)
 {
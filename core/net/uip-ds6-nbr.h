@@ -87,6 +87,7 @@ uip_ds6_nbr_t *uip_ds6_nbr_add(uip_ipaddr_t *ipaddr, uip_lladdr_t *lladdr,
                                uint8_t isrouter, uint8_t state);
 void uip_ds6_nbr_rm(uip_ds6_nbr_t *nbr);
 uip_lladdr_t *uip_ds6_nbr_get_ll(uip_ds6_nbr_t *nbr);
+uip_ds6_nbr_t *uip_ds6_nbr_update_ll(uip_ds6_nbr_t *nbr, uip_lladdr_t *lladdr);
 uip_ipaddr_t *uip_ds6_nbr_get_ipaddr(uip_ds6_nbr_t *nbr);
 uip_ds6_nbr_t *uip_ds6_nbr_lookup(uip_ipaddr_t *ipaddr);
 uip_ds6_nbr_t *uip_ds6_nbr_ll_lookup(uip_lladdr_t *lladdr);
@@ -65,12 +65,93 @@ LIST(notificationlist);
 
 static int num_routes = 0;
 
+/* The routes are also indexed by prefix, so that the longest prefix
+   matching an address is found without scanning the whole routing
+   table. Each route is put in the route_hash bucket given by its
+   prefix, and the prefix lengths in use are recorded in the
+   prefix_lengths bitmap. A lookup probes the hash table once for
+   each prefix length in use, starting with the longest one: in an
+   RPL network, host routes are found with a single probe. */
+#if (UIP_DS6_ROUTE_HASH_SIZE & (UIP_DS6_ROUTE_HASH_SIZE - 1)) != 0
+#error UIP_DS6_ROUTE_HASH_SIZE must be a power of two
+#endif
+static uip_ds6_route_t *route_hash[UIP_DS6_ROUTE_HASH_SIZE];
+static uint8_t prefix_lengths[128 / 8 + 1];
+
 #undef DEBUG
 #define DEBUG DEBUG_NONE
 #include "net/uip-debug.h"
 
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 /*---------------------------------------------------------------------------*/
+static uint16_t
+prefix_hash(const uip_ipaddr_t *addr, uint8_t length)
+{
+  uint16_t h;
+  uint8_t i;
+
+  /* uip_ipaddr_prefixcmp() only compares whole bytes, so we only hash
+     whole bytes. */
+  h = length;
+  for(i = 0; i < (length >> 3); i++) {
+    h = ((h << 5) | (h >> 11)) ^ addr->u8[i];
+  }
+  return h & (UIP_DS6_ROUTE_HASH_SIZE - 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_add(uip_ds6_route_t *route)
+{
+  uint16_t h;
+
+  h = prefix_hash(&route->ipaddr, route->length);
+  route->hash_next = route_hash[h];
+  route_hash[h] = route;
+  prefix_lengths[route->length >> 3] |= 1 << (route->length & 7);
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_rm(uip_ds6_route_t *route)
+{
+  uip_ds6_route_t **p;
+  uip_ds6_route_t *r;
+
+  for(p = &route_hash[prefix_hash(&route->ipaddr, route->length)];
+      *p != NULL;
+      p = &(*p)->hash_next) {
+    if(*p == route) {
+      *p = route->hash_next;
+      break;
+    }
+  }
+
+  /* Forget the prefix length if no other route uses it. */
+  for(r = uip_ds6_route_head();
+      r != NULL;
+      r = uip_ds6_route_next(r)) {
+    if(r != route && r->length == route->length) {
+      return;
+    }
+  }
+  prefix_lengths[route->length >> 3] &= ~(1 << (route->length & 7));
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+index_lookup(uip_ipaddr_t *addr, uint8_t length)
+{
+  uip_ds6_route_t *r;
+
+  for(r = route_hash[prefix_hash(addr, length)];
+      r != NULL;
+      r = r->hash_next) {
+    if(r->length == length &&
+       uip_ipaddr_prefixcmp(addr, &r->ipaddr, length)) {
+      return r;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
 #if DEBUG != DEBUG_NONE
 static void
 assert_nbr_routes_list_sane(void)
@@ -140,6 +221,8 @@ void
 uip_ds6_route_init(void)
 {
   memb_init(&routememb);
+  memset(route_hash, 0, sizeof(route_hash));
+  memset(prefix_lengths, 0, sizeof(prefix_lengths));
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 
@@ -216,24 +299,23 @@ uip_ds6_route_num_routes(void)
 uip_ds6_route_t *
 uip_ds6_route_lookup(uip_ipaddr_t *addr)
 {
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
-  uint8_t longestmatch;
+  uint8_t i, bit, lengths;
 
   PRINTF("uip-ds6-route: Looking up route for ");
   PRINT6ADDR(addr);
   PRINTF("\n");
 
 
+  /* Try the prefix lengths in use, from the longest to the shortest,
+     until one matches. */
   found_route = NULL;
-  longestmatch = 0;
-  for(r = uip_ds6_route_head();
-      r != NULL;
-      r = uip_ds6_route_next(r)) {
-    if(r->length >= longestmatch &&
-       uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
-      longestmatch = r->length;
-      found_route = r;
+  for(i = sizeof(prefix_lengths); found_route == NULL && i > 0; i--) {
+    lengths = prefix_lengths[i - 1];
+    for(bit = 8; found_route == NULL && lengths != 0 && bit > 0; bit--) {
+      if(lengths & (1 << (bit - 1))) {
+        found_route = index_lookup(addr, ((i - 1) << 3) + bit - 1);
+      }
     }
   }
 
@@ -260,6 +342,11 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
   assert_nbr_routes_list_sane();
 #endif /* DEBUG != DEBUG_NONE */
 
+  if(length > 128) {
+    PRINTF("uip_ds6_route_add: invalid prefix length %u\n", length);
+    return NULL;
+  }
+
   /* Get link-layer address of next hop, make sure it is in neighbor table */
   uip_lladdr_t *nexthop_lladdr = uip_ds6_nbr_lladdr_from_ipaddr(nexthop);
   if(nexthop_lladdr == NULL) {
@@ -277,6 +364,7 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
     PRINTF("uip_ds6_route_add: old route already found, updating this one instead: ");
     PRINT6ADDR(ipaddr);
     PRINTF("\n");
+    index_rm(r);
   } else {
     struct uip_ds6_route_neighbor_routes *routes;
     /* If there is no routing entry, create one */
@@ -330,6 +418,7 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+  index_add(r);
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -365,6 +454,7 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
     PRINT6ADDR(&route->ipaddr);
     PRINTF("\n");
 
+    index_rm(route);
     list_remove(route->routes->route_list, route);
     if(list_head(route->routes->route_list) == NULL) {
       /* If this was the only route using this neighbor, remove the
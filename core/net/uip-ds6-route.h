@@ -80,6 +80,34 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB UIP_CONF_MAX_ROUTES
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/** \brief Number of buckets of the hash table indexing the routes by
+    prefix. Must be a power of two. By default, the smallest power of
+    two that is not below UIP_DS6_ROUTE_NB, so that the chains stay
+    short without wasting RAM on small tables. */
+#ifdef UIP_CONF_DS6_ROUTE_HASH_SIZE
+#define UIP_DS6_ROUTE_HASH_SIZE UIP_CONF_DS6_ROUTE_HASH_SIZE
+#elif UIP_DS6_ROUTE_NB <= 1
+#define UIP_DS6_ROUTE_HASH_SIZE 1
+#elif UIP_DS6_ROUTE_NB <= 2
+#define UIP_DS6_ROUTE_HASH_SIZE 2
+#elif UIP_DS6_ROUTE_NB <= 4
+#define UIP_DS6_ROUTE_HASH_SIZE 4
+#elif UIP_DS6_ROUTE_NB <= 8
+#define UIP_DS6_ROUTE_HASH_SIZE 8
+#elif UIP_DS6_ROUTE_NB <= 16
+#define UIP_DS6_ROUTE_HASH_SIZE 16
+#elif UIP_DS6_ROUTE_NB <= 32
+#define UIP_DS6_ROUTE_HASH_SIZE 32
+#elif UIP_DS6_ROUTE_NB <= 64
+#define UIP_DS6_ROUTE_HASH_SIZE 64
+#elif UIP_DS6_ROUTE_NB <= 128
+#define UIP_DS6_ROUTE_HASH_SIZE 128
+#elif UIP_DS6_ROUTE_NB <= 256
+#define UIP_DS6_ROUTE_HASH_SIZE 256
+#else
+#define UIP_DS6_ROUTE_HASH_SIZE 512
+#endif /* UIP_CONF_DS6_ROUTE_HASH_SIZE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -108,6 +136,8 @@ typedef struct uip_ds6_route {
      belong to the neighbor table entry that this routing table entry
      uses. */
   struct uip_ds6_route_neighbor_routes *routes;
+  /* Next route in the same bucket of the prefix hash table. */
+  struct uip_ds6_route *hash_next;
   uip_ipaddr_t ipaddr;
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   UIP_DS6_ROUTE_STATE_TYPE state;
@@ -79,6 +79,7 @@ uip_icmp6_echo_request_input(void)
 #if UIP_CONF_IPV6_RPL
   uint8_t temp_ext_len;
 #endif /* UIP_CONF_IPV6_RPL */
+  uint8_t same_pseudo_hdr;
   /*
    * we send an echo reply. It is trivial if there was no extension
    * headers in the request otherwise we need to remove the extension
@@ -93,7 +94,12 @@ uip_icmp6_echo_request_input(void)
   /* IP header */
   UIP_IP_BUF->ttl = uip_ds6_if.cur_hop_limit;
 
+  /* Unless the source address or the length change, the checksum only
+     needs an update for the new message type. */
+  same_pseudo_hdr = uip_ext_len == 0;
+
   if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)){
+    same_pseudo_hdr = 0;
     uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &UIP_IP_BUF->srcipaddr);
     uip_ds6_select_src(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
   } else {
@@ -146,10 +152,20 @@ uip_icmp6_echo_request_input(void)
    */
 
   /* Note: now UIP_ICMP_BUF points to the beginning of the echo reply */
-  UIP_ICMP_BUF->type = ICMP6_ECHO_REPLY;
-  UIP_ICMP_BUF->icode = 0;
-  UIP_ICMP_BUF->icmpchksum = 0;
-  UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+  if(same_pseudo_hdr) {
+    UIP_ICMP_BUF->icmpchksum =
+      uip_chksum_update16(UIP_ICMP_BUF->icmpchksum,
+                          UIP_HTONS((UIP_ICMP_BUF->type << 8) |
+                                    UIP_ICMP_BUF->icode),
+                          UIP_HTONS(ICMP6_ECHO_REPLY << 8));
+    UIP_ICMP_BUF->type = ICMP6_ECHO_REPLY;
+    UIP_ICMP_BUF->icode = 0;
+  } else {
+    UIP_ICMP_BUF->type = ICMP6_ECHO_REPLY;
+    UIP_ICMP_BUF->icode = 0;
+    UIP_ICMP_BUF->icmpchksum = 0;
+    UIP_ICMP_BUF->icmpchksum = ~uip_icmp6chksum();
+  }
 
   PRINTF("Sending Echo Reply to");
   PRINT6ADDR(&UIP_IP_BUF->destipaddr);
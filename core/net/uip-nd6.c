@@ -194,8 +194,11 @@ uip_nd6_ns_input(void)
           uip_lladdr_t *lladdr = uip_ds6_nbr_get_ll(nbr);
           if(memcmp(&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
 		    lladdr, UIP_LLADDR_LEN) != 0) {
-            memcpy(lladdr, &nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
-		   UIP_LLADDR_LEN);
+            uip_ds6_nbr_t *moved = uip_ds6_nbr_update_ll(nbr,
+                (uip_lladdr_t *)&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET]);
+            if(moved != NULL) {
+              nbr = moved;
+            }
             nbr->state = NBR_STALE;
           } else {
             if(nbr->state == NBR_INCOMPLETE) {
@@ -476,8 +479,11 @@ uip_nd6_na_input(void)
       if(nd6_opt_llao == NULL) {
         goto discard;
       }
-      memcpy(lladdr, &nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
-	     UIP_LLADDR_LEN);
+      nbr = uip_ds6_nbr_update_ll(nbr,
+          (uip_lladdr_t *)&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET]);
+      if(nbr == NULL) {
+        goto discard;
+      }
       if(is_solicited) {
         nbr->state = NBR_REACHABLE;
         nbr->nscount = 0;
@@ -499,8 +505,11 @@ uip_nd6_na_input(void)
         if(is_override || (!is_override && nd6_opt_llao != 0 && !is_llchange)
            || nd6_opt_llao == 0) {
           if(nd6_opt_llao != 0) {
-            memcpy(lladdr, &nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
-		   UIP_LLADDR_LEN);
+            uip_ds6_nbr_t *moved = uip_ds6_nbr_update_ll(nbr,
+                (uip_lladdr_t *)&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET]);
+            if(moved != NULL) {
+              nbr = moved;
+            }
           }
           if(is_solicited) {
             nbr->state = NBR_REACHABLE;
@@ -822,8 +831,11 @@ uip_nd6_ra_input(void)
         uip_lladdr_t *lladdr = uip_ds6_nbr_get_ll(nbr);
         if(memcmp(&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
 		  lladdr, UIP_LLADDR_LEN) != 0) {
-          memcpy(lladdr, &nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET],
-		 UIP_LLADDR_LEN);
+          uip_ds6_nbr_t *moved = uip_ds6_nbr_update_ll(nbr,
+              (uip_lladdr_t *)&nd6_opt_llao[UIP_ND6_OPT_DATA_OFFSET]);
+          if(moved != NULL) {
+            nbr = moved;
+          }
           nbr->state = NBR_STALE;
         }
         nbr->isrouter = 1;
@@ -45,33 +45,49 @@ extern uint16_t uip_slen;
 
 #include <string.h>
 
+#define UDP_PAYLOAD     (&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN])
+#define UDP_PAYLOAD_MAX (UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPUDPH_LEN)
+/*---------------------------------------------------------------------------*/
+static void
+copy_payload(const void *data, int len)
+{
+  /* Data that was built with uip_udp_packet_buf() is already in
+     place. */
+  if(data != UDP_PAYLOAD) {
+    memcpy(UDP_PAYLOAD, data, len > UDP_PAYLOAD_MAX ? UDP_PAYLOAD_MAX : len);
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint8_t *
+uip_udp_packet_buf(int *maxlen)
+{
+  if(maxlen != NULL) {
+    *maxlen = UDP_PAYLOAD_MAX;
+  }
+  return UDP_PAYLOAD;
+}
 /*---------------------------------------------------------------------------*/
 void
-uip_udp_packet_send(struct uip_udp_conn *c, const void *data, int len)
+uip_udp_packet_commit(struct uip_udp_conn *c, int len)
 {
 #if UIP_UDP
-  if(data != NULL) {
-    uip_udp_conn = c;
-    uip_slen = len;
-    memcpy(&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN], data,
-           len > UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPUDPH_LEN?
-           UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPUDPH_LEN: len);
-    uip_process(UIP_UDP_SEND_CONN);
+  uip_udp_conn = c;
+  uip_slen = len > UDP_PAYLOAD_MAX ? UDP_PAYLOAD_MAX : len;
+  uip_process(UIP_UDP_SEND_CONN);
 #if UIP_CONF_IPV6
-    tcpip_ipv6_output();
+  tcpip_ipv6_output();
 #else
-    if(uip_len > 0) {
-      tcpip_output();
-    }
-#endif
+  if(uip_len > 0) {
+    tcpip_output();
   }
+#endif
   uip_slen = 0;
 #endif /* UIP_UDP */
 }
 /*---------------------------------------------------------------------------*/
 void
-uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
-		      const uip_ipaddr_t *toaddr, uint16_t toport)
+uip_udp_packet_committo(struct uip_udp_conn *c, int len,
+                        const uip_ipaddr_t *toaddr, uint16_t toport)
 {
   uip_ipaddr_t curaddr;
   uint16_t curport;
@@ -85,7 +101,7 @@ uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
     uip_ipaddr_copy(&c->ripaddr, toaddr);
     c->rport = toport;
 
-    uip_udp_packet_send(c, data, len);
+    uip_udp_packet_commit(c, len);
 
     /* Restore old IP addr/port */
     uip_ipaddr_copy(&c->ripaddr, &curaddr);
@@ -93,3 +109,24 @@ uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
   }
 }
 /*---------------------------------------------------------------------------*/
+void
+uip_udp_packet_send(struct uip_udp_conn *c, const void *data, int len)
+{
+#if UIP_UDP
+  if(data != NULL) {
+    copy_payload(data, len);
+    uip_udp_packet_commit(c, len);
+  }
+#endif /* UIP_UDP */
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
+		      const uip_ipaddr_t *toaddr, uint16_t toport)
+{
+  if(data != NULL && toaddr != NULL) {
+    copy_payload(data, len);
+    uip_udp_packet_committo(c, len, toaddr, toport);
+  }
+}
+/*---------------------------------------------------------------------------*/
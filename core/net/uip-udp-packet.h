@@ -46,4 +46,40 @@ void uip_udp_packet_send(struct uip_udp_conn *c, const void *data, int len);
 void uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
 			   const uip_ipaddr_t *toaddr, uint16_t toport);
 
+/**
+ * \brief      Get the buffer in which to build the payload of a UDP packet
+ * \param maxlen A pointer to where the size of the buffer is stored, or NULL
+ * \return     A pointer to the payload of the next outgoing UDP packet
+ *
+ *             This function lets an application serialize its data
+ *             directly into uip_buf, instead of into a buffer of its own
+ *             that uip_udp_packet_send() would then copy. The packet is
+ *             sent with uip_udp_packet_commit() or
+ *             uip_udp_packet_committo(), or by passing the returned
+ *             pointer to uip_udp_packet_send(), uip_udp_packet_sendto()
+ *             or simple_udp_sendto(), which then do not copy it.
+ *
+ *             The buffer is uip_buf, so the packet must be sent before
+ *             the process yields, and must not be built while the
+ *             incoming packet in uip_buf is still needed.
+ */
+uint8_t *uip_udp_packet_buf(int *maxlen);
+
+/**
+ * \brief      Send the UDP packet built with uip_udp_packet_buf()
+ * \param c    The UDP connection
+ * \param len  The length of the payload
+ */
+void uip_udp_packet_commit(struct uip_udp_conn *c, int len);
+
+/**
+ * \brief      Send the UDP packet built with uip_udp_packet_buf() to an address
+ * \param c    The UDP connection
+ * \param len  The length of the payload
+ * \param toaddr The IP address of the receiver
+ * \param toport The UDP port of the receiver, in network byte order
+ */
+void uip_udp_packet_committo(struct uip_udp_conn *c, int len,
+                             const uip_ipaddr_t *toaddr, uint16_t toport);
+
 #endif /* __UIP_UDP_PACKET_H__ */
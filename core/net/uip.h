@@ -559,7 +559,43 @@ void uip_unlisten(uint16_t port);
  */
 struct uip_conn *uip_connect(uip_ipaddr_t *ripaddr, uint16_t port);
 
+#if UIP_TCP_SEND_WINDOW
+/**
+ * Set the send buffer of a TCP connection.
+ *
+ * With a send buffer, uIP keeps the data sent on the connection until
+ * it is acknowledged, and the application may send a new segment as
+ * soon as the previous one is buffered instead of waiting for its
+ * acknowledgment. uIP reports buffered data as acknowledged
+ * (uip_acked()) and retransmits it by itself, so applications written
+ * for the single-segment API, such as protosockets, need no change.
+ * The application is asked to retransmit (uip_rexmit()) only data
+ * that did not fit in the buffer.
+ *
+ * The buffer must be set before data is sent on the connection, for
+ * instance when it is connected, and stay valid until the connection
+ * is closed. A NULL buffer makes the connection send one segment at a
+ * time.
+ *
+ * \param conn A pointer to the uip_conn structure for the connection.
+ * \param buf The buffer, or NULL.
+ * \param size The size of the buffer, at least UIP_TCP_MSS bytes.
+ *
+ * \return Non-zero if the buffer was set, zero if the buffer is too
+ * small or the connection has data in flight.
+ */
+int uip_tcp_set_sndbuf(struct uip_conn *conn, uint8_t *buf, uint16_t size);
 
+/**
+ * \internal
+ *
+ * Check if the application of a connection can be called right away
+ * to send another segment.
+ *
+ * \param conn A pointer to the uip_conn structure for the connection.
+ */
+int uip_tcp_sndbuf_ready(struct uip_conn *conn);
+#endif /* UIP_TCP_SEND_WINDOW */
 
 /**
  * \internal
@@ -1319,6 +1355,17 @@ struct uip_conn {
   uint8_t timer;         /**< The retransmission timer. */
   uint8_t nrtx;          /**< The number of retransmissions for the last
 			 segment sent. */
+#if UIP_TCP_SEND_WINDOW
+  uint8_t *sndbuf;       /**< The send buffer, holding the len bytes
+                         in flight, or NULL. */
+  uint16_t sndbuf_size;  /**< The size of the send buffer. */
+  uint16_t sndwnd;       /**< The window advertised by the remote host. */
+  uint16_t recover;      /**< The data in flight that is left to be
+                         retransmitted after a loss. */
+  uint8_t dupacks;       /**< The number of duplicate acknowledgments
+                         received. */
+  uint8_t sndflags;      /**< Send buffer state flags. */
+#endif /* UIP_TCP_SEND_WINDOW */
 
   /** The application state. */
   uip_tcp_appstate_t appstate;
@@ -1419,6 +1466,8 @@ struct uip_stats {
 			     checksum errors. */
     uip_stats_t protoerr; /**< Number of packets dropped because they
 			     were neither ICMP, UDP nor TCP. */
+    uip_stats_t qdrop;    /**< Number of received packets dropped
+			     because the input queue was full. */
   } ip;                   /**< IP statistics. */
   struct {
     uip_stats_t recv;     /**< Number of received ICMP packets. */
@@ -2152,6 +2201,44 @@ CCIF extern uip_lladdr_t uip_lladdr;
  */
 uint16_t uip_chksum(uint16_t *buf, uint16_t len);
 
+/**
+ * Update a checksum after a 16-bit word of the data it covers was
+ * changed, without summing the data again (RFC1624).
+ *
+ * All values are taken as they are stored in the packet, so no byte
+ * order conversion is needed. The result may be 0x0000, which a UDP
+ * sender must transmit as 0xffff.
+ *
+ * \param chksum The checksum field before the change.
+ *
+ * \param old_word The word before the change.
+ *
+ * \param new_word The word after the change.
+ *
+ * \return The new value of the checksum field.
+ */
+uint16_t uip_chksum_update16(uint16_t chksum, uint16_t old_word,
+                             uint16_t new_word);
+
+/**
+ * Update a checksum after a block of the data it covers was changed.
+ *
+ * The block must start at an even offset of the checksummed data,
+ * and only the old and new contents of the block are summed.
+ *
+ * \param chksum The checksum field before the change.
+ *
+ * \param old_data The block before the change.
+ *
+ * \param new_data The block after the change.
+ *
+ * \param len The length of the block.
+ *
+ * \return The new value of the checksum field.
+ */
+uint16_t uip_chksum_update(uint16_t chksum, const void *old_data,
+                           const void *new_data, uint16_t len);
+
 /**
  * Calculate the IP header checksum of the packet header in uip_buf.
  *
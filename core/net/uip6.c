@@ -243,6 +243,29 @@ static uint8_t iss[4];
 uint8_t uip_acc32[4];
 static uint8_t opt;
 static uint16_t tmp16;
+
+#if UIP_TCP_SEND_WINDOW
+#if UIP_TCP_SNDBUF_SIZE > 0
+/* The send buffers that uIP gives to new connections. */
+static uint8_t uip_tcp_sndbufs[UIP_CONNS][UIP_TCP_SNDBUF_SIZE];
+#endif /* UIP_TCP_SNDBUF_SIZE > 0 */
+
+/* The uip_conn sndflags. */
+#define SND_ACKED  0x01 /* Buffered data is to be reported as acked. */
+#define SND_REXMIT 0x02 /* Data did not fit and is to be sent again. */
+#define SND_CLOSE  0x04 /* A FIN is to be sent once the buffer drains. */
+
+/* The number of duplicate ACKs that trigger a fast retransmit. */
+#define TCP_DUPACK_THRESHOLD 3
+
+/* The offset in the send buffer of the segment being sent; SNDOFF_NXT
+   stands for the end of the data in flight. */
+#define SNDOFF_NXT 0xffff
+static uint16_t sndoff = SNDOFF_NXT;
+static uint32_t acked;
+
+static void sndbuf_init(struct uip_conn *conn);
+#endif /* UIP_TCP_SEND_WINDOW */
 #endif /* UIP_TCP */
 /** @} */
 
@@ -299,36 +322,47 @@ uip_add32(uint8_t *op32, uint16_t op16)
 
 #if ! UIP_ARCH_CHKSUM
 /*---------------------------------------------------------------------------*/
+#if UIP_ARCH_CHKSUM_ADD
+#include "net/uip_arch.h"
+#define chksum uip_arch_chksum_add
+#else /* UIP_ARCH_CHKSUM_ADD */
 static uint16_t
 chksum(uint16_t sum, const uint8_t *data, uint16_t len)
 {
-  uint16_t t;
+  uint32_t acc;
   const uint8_t *dataptr;
-  const uint8_t *last_byte;
+  const uint8_t *last_word;
 
+  /* The words are accumulated in 32 bits, and the carries are folded
+     back once at the end. Even a 64 kB buffer cannot overflow the
+     accumulator. */
+  acc = sum;
   dataptr = data;
-  last_byte = data + len - 1;
-  
-  while(dataptr < last_byte) {   /* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
+  last_word = data + (len & ~1);
+
+  while(last_word - dataptr >= 8) {
+    acc += ((uint16_t)dataptr[0] << 8) | dataptr[1];
+    acc += ((uint16_t)dataptr[2] << 8) | dataptr[3];
+    acc += ((uint16_t)dataptr[4] << 8) | dataptr[5];
+    acc += ((uint16_t)dataptr[6] << 8) | dataptr[7];
+    dataptr += 8;
+  }
+  while(dataptr < last_word) {
+    acc += ((uint16_t)dataptr[0] << 8) | dataptr[1];
     dataptr += 2;
   }
-  
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
+
+  if(len & 1) {
+    acc += (uint16_t)dataptr[0] << 8;
   }
 
+  acc = (acc >> 16) + (acc & 0xffff);
+  acc += acc >> 16;
+
   /* Return sum in host byte order. */
-  return sum;
+  return (uint16_t)acc;
 }
+#endif /* UIP_ARCH_CHKSUM_ADD */
 /*---------------------------------------------------------------------------*/
 uint16_t
 uip_chksum(uint16_t *data, uint16_t len)
@@ -405,6 +439,28 @@ uip_udpchksum(void)
 #endif /* UIP_UDP && UIP_UDP_CHECKSUMS */
 #endif /* UIP_ARCH_CHKSUM */
 /*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update16(uint16_t chksum, uint16_t old_word, uint16_t new_word)
+{
+  uint32_t acc;
+
+  /* RFC 1624, equation 3: HC' = ~(~HC + ~m + m'). */
+  acc = (uint16_t)~chksum;
+  acc += (uint16_t)~old_word;
+  acc += new_word;
+  acc = (acc >> 16) + (acc & 0xffff);
+  acc += acc >> 16;
+  return ~acc;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update(uint16_t chksum, const void *old_data,
+                  const void *new_data, uint16_t len)
+{
+  return uip_chksum_update16(chksum, uip_chksum((uint16_t *)old_data, len),
+                             uip_chksum((uint16_t *)new_data, len));
+}
+/*---------------------------------------------------------------------------*/
 void
 uip_init(void)
 {
@@ -487,6 +543,9 @@ uip_connect(uip_ipaddr_t *ripaddr, uint16_t rport)
   conn->rcv_nxt[3] = 0;
 
   conn->initialmss = conn->mss = UIP_TCP_MSS;
+#if UIP_TCP_SEND_WINDOW
+  sndbuf_init(conn);
+#endif /* UIP_TCP_SEND_WINDOW */
   
   conn->len = 1;   /* TCP length of the SYN is one. */
   conn->nrtx = 0;
@@ -822,7 +881,122 @@ uip_add_rcv_nxt(uint16_t n)
   uip_conn->rcv_nxt[2] = uip_acc32[2];
   uip_conn->rcv_nxt[3] = uip_acc32[3];
 }
-#endif
+/*---------------------------------------------------------------------------*/
+static void
+uip_update_rto(struct uip_conn *conn)
+{
+  signed char m;
+
+  m = conn->rto - conn->timer;
+  /* This is taken directly from VJs original code in his paper */
+  m = m - (conn->sa >> 3);
+  conn->sa += m;
+  if(m < 0) {
+    m = -m;
+  }
+  m = m - (conn->sv >> 2);
+  conn->sv += m;
+  conn->rto = (conn->sa >> 3) + conn->sv;
+}
+#if UIP_TCP_SEND_WINDOW
+/*---------------------------------------------------------------------------*/
+static void
+sndbuf_init(struct uip_conn *conn)
+{
+#if UIP_TCP_SNDBUF_SIZE > 0
+  conn->sndbuf = uip_tcp_sndbufs[conn - uip_conns];
+  conn->sndbuf_size = UIP_TCP_SNDBUF_SIZE;
+#else
+  conn->sndbuf = NULL;
+  conn->sndbuf_size = 0;
+#endif /* UIP_TCP_SNDBUF_SIZE > 0 */
+  conn->sndwnd = conn->initialmss;
+  conn->recover = 0;
+  conn->dupacks = 0;
+  conn->sndflags = 0;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+sndbuf_room(struct uip_conn *conn)
+{
+  uint16_t limit;
+
+  limit = conn->sndwnd < conn->sndbuf_size ? conn->sndwnd : conn->sndbuf_size;
+  return limit > conn->len ? limit - conn->len : 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+sndbuf_can_send(struct uip_conn *conn)
+{
+  return (conn->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
+    !(conn->sndflags & SND_CLOSE) && conn->recover == 0 &&
+    sndbuf_room(conn) >= conn->mss;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Set the flags the application is called with. Buffered data is
+ * reported as acknowledged, and data that did not fit in the buffer
+ * is asked for again, once a full segment fits.
+ */
+static void
+sndbuf_appflags(struct uip_conn *conn)
+{
+  if(conn->sndbuf == NULL) {
+    return;
+  }
+  uip_flags &= ~(UIP_ACKDATA | UIP_REXMIT);
+  if(sndbuf_can_send(conn)) {
+    if(conn->sndflags & SND_REXMIT) {
+      uip_flags |= UIP_REXMIT;
+    } else if(conn->sndflags & SND_ACKED) {
+      uip_flags |= UIP_ACKDATA;
+    }
+    conn->sndflags &= ~(SND_ACKED | SND_REXMIT);
+  }
+  if(uip_flags == 0) {
+    uip_flags = UIP_POLL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+seq_diff(const uint8_t *a, const uint8_t *b)
+{
+  return (((uint32_t)a[0] << 24) | ((uint32_t)a[1] << 16) |
+          ((uint32_t)a[2] << 8) | a[3]) -
+    (((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) |
+     ((uint32_t)b[2] << 8) | b[3]);
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_tcp_set_sndbuf(struct uip_conn *conn, uint8_t *buf, uint16_t size)
+{
+  if((buf != NULL && size < UIP_TCP_MSS) ||
+     ((conn->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
+      uip_outstanding(conn))) {
+    return 0;
+  }
+  conn->sndbuf = buf;
+  conn->sndbuf_size = buf == NULL ? 0 : size;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+uip_tcp_sndbuf_ready(struct uip_conn *conn)
+{
+  return conn->sndbuf != NULL &&
+    (conn->sndflags & (SND_ACKED | SND_REXMIT)) != 0 &&
+    sndbuf_can_send(conn);
+}
+/*---------------------------------------------------------------------------*/
+/* Whether the application of an established connection may send. */
+#define TCP_CAN_SEND(conn) ((conn)->sndbuf != NULL ?     \
+                            sndbuf_can_send(conn) :      \
+                            !uip_outstanding(conn))
+#else /* UIP_TCP_SEND_WINDOW */
+#define TCP_CAN_SEND(conn) (!uip_outstanding(conn))
+#define sndbuf_appflags(conn)
+#endif /* UIP_TCP_SEND_WINDOW */
+#endif /* UIP_TCP */
 /*---------------------------------------------------------------------------*/
 
 /**
@@ -927,8 +1101,9 @@ uip_process(uint8_t flag)
   if(flag == UIP_POLL_REQUEST) {
 #if UIP_TCP
     if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
-       !uip_outstanding(uip_connr)) {
+       TCP_CAN_SEND(uip_connr)) {
       uip_flags = UIP_POLL;
+      sndbuf_appflags(uip_connr);
       UIP_APPCALL();
       goto appsend;
 #if UIP_ACTIVE_OPEN
@@ -1023,6 +1198,13 @@ uip_process(uint8_t flag)
 #endif /* UIP_ACTIVE_OPEN */
                      
             case UIP_ESTABLISHED:
+#if UIP_TCP_SEND_WINDOW
+              /* Buffered data is retransmitted by uIP itself. */
+              if(uip_connr->sndbuf != NULL) {
+                uip_connr->recover = uip_connr->len;
+                goto sndbuf_rexmit;
+              }
+#endif /* UIP_TCP_SEND_WINDOW */
               /*
                * In the ESTABLISHED state, we call upon the application
                * to do the actual retransmit after which we jump into
@@ -1040,12 +1222,15 @@ uip_process(uint8_t flag)
               goto tcp_send_finack;
           }
         }
-      } else if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+      }
+      if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
+         TCP_CAN_SEND(uip_connr)) {
         /*
          * If there was no need for a retransmission, we poll the
          * application for new data.
          */
         uip_flags = UIP_POLL;
+        sndbuf_appflags(uip_connr);
         UIP_APPCALL();
         goto appsend;
       }
@@ -1309,6 +1494,24 @@ uip_process(uint8_t flag)
 
         PRINTF("Processing Routing header\n");
         if(UIP_ROUTING_BUF->seg_left > 0) {
+#if UIP_CONF_IPV6_RPL
+          if(rpl_process_srh_header()) {
+            /* The destination address now is the next hop of the RPL
+               source route: forward the packet. */
+            if(UIP_IP_BUF->ttl <= 1) {
+              uip_icmp6_error_output(ICMP6_TIME_EXCEEDED,
+                                     ICMP6_TIME_EXCEED_TRANSIT, 0);
+              UIP_STAT(++uip_stat.ip.drop);
+              goto send;
+            }
+            UIP_IP_BUF->ttl = UIP_IP_BUF->ttl - 1;
+            PRINTF("Forwarding source routed packet to ");
+            PRINT6ADDR(&UIP_IP_BUF->destipaddr);
+            PRINTF("\n");
+            UIP_STAT(++uip_stat.ip.forwarded);
+            goto send;
+          }
+#endif /* UIP_CONF_IPV6_RPL */
           uip_icmp6_error_output(ICMP6_PARAM_PROB, ICMP6_PARAMPROB_HEADER, UIP_IPH_LEN + uip_ext_len + 2);
           UIP_STAT(++uip_stat.ip.drop);
           UIP_LOG("ip6: unrecognized routing type");
@@ -1770,6 +1973,9 @@ uip_process(uint8_t flag)
       }
     }
   }
+#if UIP_TCP_SEND_WINDOW
+  sndbuf_init(uip_connr);
+#endif /* UIP_TCP_SEND_WINDOW */
   
   /* Our response will be a SYNACK. */
 #if UIP_ACTIVE_OPEN
@@ -1844,42 +2050,76 @@ uip_process(uint8_t flag)
      the outstanding data, calculate RTT estimations, and reset the
      retransmission timer. */
   if((UIP_TCP_BUF->flags & TCP_ACK) && uip_outstanding(uip_connr)) {
-    uip_add32(uip_connr->snd_nxt, uip_connr->len);
-
-    if(UIP_TCP_BUF->ackno[0] == uip_acc32[0] &&
-       UIP_TCP_BUF->ackno[1] == uip_acc32[1] &&
-       UIP_TCP_BUF->ackno[2] == uip_acc32[2] &&
-       UIP_TCP_BUF->ackno[3] == uip_acc32[3]) {
-      /* Update sequence number. */
-      uip_connr->snd_nxt[0] = uip_acc32[0];
-      uip_connr->snd_nxt[1] = uip_acc32[1];
-      uip_connr->snd_nxt[2] = uip_acc32[2];
-      uip_connr->snd_nxt[3] = uip_acc32[3];
-   
-      /* Do RTT estimation, unless we have done retransmissions. */
-      if(uip_connr->nrtx == 0) {
-        signed char m;
-        m = uip_connr->rto - uip_connr->timer;
-        /* This is taken directly from VJs original code in his paper */
-        m = m - (uip_connr->sa >> 3);
-        uip_connr->sa += m;
-        if(m < 0) {
-          m = -m;
+#if UIP_TCP_SEND_WINDOW
+    /* With a send buffer, the data in flight is acknowledged piecewise,
+       and the buffered data past the acknowledgment is kept. */
+    if(uip_connr->sndbuf != NULL &&
+       (uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+      acked = seq_diff(UIP_TCP_BUF->ackno, uip_connr->snd_nxt);
+      if(acked > 0 && acked <= uip_connr->len) {
+        uip_add32(uip_connr->snd_nxt, (uint16_t)acked);
+        uip_connr->snd_nxt[0] = uip_acc32[0];
+        uip_connr->snd_nxt[1] = uip_acc32[1];
+        uip_connr->snd_nxt[2] = uip_acc32[2];
+        uip_connr->snd_nxt[3] = uip_acc32[3];
+        if(uip_connr->nrtx == 0) {
+          uip_update_rto(uip_connr);
+        }
+        uip_connr->len -= (uint16_t)acked;
+        memmove(uip_connr->sndbuf, uip_connr->sndbuf + (uint16_t)acked,
+                uip_connr->len);
+        uip_connr->timer = uip_connr->rto;
+        uip_connr->nrtx = 0;
+        uip_connr->dupacks = 0;
+        uip_flags = UIP_ACKDATA;
+        if(uip_connr->recover > (uint16_t)acked && uip_outstanding(uip_connr) &&
+           uip_len == 0) {
+          /* Part of the data that was in flight when a segment was lost
+             is acknowledged: the next segment was likely lost too. */
+          uip_connr->recover -= (uint16_t)acked;
+          goto sndbuf_rexmit;
+        }
+        uip_connr->recover = 0;
+      } else if(acked == 0 && uip_len == 0 &&
+                (UIP_TCP_BUF->flags & (TCP_SYN | TCP_FIN)) == 0 &&
+                ((uint16_t)UIP_TCP_BUF->wnd[0] << 8 | UIP_TCP_BUF->wnd[1]) ==
+                uip_connr->sndwnd) {
+        /* A duplicate ACK: the segment at its sequence number is likely
+           lost, send it again without waiting for the timer. */
+        if(++uip_connr->dupacks == TCP_DUPACK_THRESHOLD) {
+          UIP_STAT(++uip_stat.tcp.rexmit);
+          uip_connr->recover = uip_connr->len;
+          goto sndbuf_rexmit;
         }
-        m = m - (uip_connr->sv >> 2);
-        uip_connr->sv += m;
-        uip_connr->rto = (uip_connr->sa >> 3) + uip_connr->sv;
-
       }
-      /* Set the acknowledged flag. */
-      uip_flags = UIP_ACKDATA;
-      /* Reset the retransmission timer. */
-      uip_connr->timer = uip_connr->rto;
+    } else
+#endif /* UIP_TCP_SEND_WINDOW */
+    {
+      uip_add32(uip_connr->snd_nxt, uip_connr->len);
+
+      if(UIP_TCP_BUF->ackno[0] == uip_acc32[0] &&
+         UIP_TCP_BUF->ackno[1] == uip_acc32[1] &&
+         UIP_TCP_BUF->ackno[2] == uip_acc32[2] &&
+         UIP_TCP_BUF->ackno[3] == uip_acc32[3]) {
+        /* Update sequence number. */
+        uip_connr->snd_nxt[0] = uip_acc32[0];
+        uip_connr->snd_nxt[1] = uip_acc32[1];
+        uip_connr->snd_nxt[2] = uip_acc32[2];
+        uip_connr->snd_nxt[3] = uip_acc32[3];
+     
+        /* Do RTT estimation, unless we have done retransmissions. */
+        if(uip_connr->nrtx == 0) {
+          uip_update_rto(uip_connr);
+        }
+        /* Set the acknowledged flag. */
+        uip_flags = UIP_ACKDATA;
+        /* Reset the retransmission timer. */
+        uip_connr->timer = uip_connr->rto;
 
-      /* Reset length of outstanding data. */
-      uip_connr->len = 0;
+        /* Reset length of outstanding data. */
+        uip_connr->len = 0;
+      }
     }
-    
   }
 
   /* Do different things depending on in what state the connection is. */
@@ -2051,6 +2291,34 @@ uip_process(uint8_t flag)
         tmp16 = uip_connr->initialmss;
       }
       uip_connr->mss = tmp16;
+#if UIP_TCP_SEND_WINDOW
+      /* The data in flight is limited by the window, a zero window
+         being probed by a full segment like above. */
+      tmp16 = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) + (uint16_t)UIP_TCP_BUF->wnd[1];
+      uip_connr->sndwnd = tmp16 == 0 ? uip_connr->initialmss : tmp16;
+
+      /* With a send buffer, the application is called on acknowledgments
+         only when it can send a new segment, and not at all once it has
+         closed the connection. */
+      if(uip_connr->sndbuf != NULL) {
+        if(uip_connr->sndflags & SND_CLOSE) {
+          if(!uip_outstanding(uip_connr)) {
+            uip_connr->sndflags &= ~SND_CLOSE;
+            goto tcp_close;
+          }
+          if(uip_flags & UIP_NEWDATA) {
+            goto tcp_send_ack;
+          }
+          goto drop;
+        }
+        if((uip_flags & UIP_ACKDATA) && !sndbuf_can_send(uip_connr)) {
+          uip_flags &= ~UIP_ACKDATA;
+        }
+        if(uip_flags & (UIP_NEWDATA | UIP_ACKDATA)) {
+          sndbuf_appflags(uip_connr);
+        }
+      }
+#endif /* UIP_TCP_SEND_WINDOW */
 
       /* If this packet constitutes an ACK for outstanding data (flagged
          by the UIP_ACKDATA flag, we should call the application since it
@@ -2083,6 +2351,17 @@ uip_process(uint8_t flag)
 
         if(uip_flags & UIP_CLOSE) {
           uip_slen = 0;
+#if UIP_TCP_SEND_WINDOW
+          if(uip_connr->sndbuf != NULL && uip_outstanding(uip_connr)) {
+            /* Send the FIN after the buffered data is acknowledged. */
+            uip_connr->sndflags |= SND_CLOSE;
+            if(uip_flags & UIP_NEWDATA) {
+              goto tcp_send_ack;
+            }
+            goto drop;
+          }
+        tcp_close:
+#endif /* UIP_TCP_SEND_WINDOW */
           uip_connr->len = 1;
           uip_connr->tcpstateflags = UIP_FIN_WAIT_1;
           uip_connr->nrtx = 0;
@@ -2090,6 +2369,38 @@ uip_process(uint8_t flag)
           goto tcp_send_nodata;
         }
 
+#if UIP_TCP_SEND_WINDOW
+        /* With a send buffer, new data is sent behind the data in
+           flight as long as it fits in the buffer and in the window. */
+        if(uip_connr->sndbuf != NULL) {
+          if(uip_slen > uip_connr->mss) {
+            uip_slen = uip_connr->mss;
+          }
+          if(uip_slen > sndbuf_room(uip_connr)) {
+            /* The application will be asked to send it again. */
+            uip_connr->sndflags |= SND_REXMIT;
+          } else if(uip_slen > 0) {
+            memcpy(uip_connr->sndbuf + uip_connr->len, uip_sappdata, uip_slen);
+            if(!uip_outstanding(uip_connr)) {
+              uip_connr->timer = uip_connr->rto;
+              uip_connr->nrtx = 0;
+            }
+            sndoff = uip_connr->len;
+            uip_connr->len += uip_slen;
+            uip_connr->sndflags |= SND_ACKED;
+            uip_len = uip_slen + UIP_TCPIP_HLEN;
+            UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+            goto tcp_send_noopts;
+          }
+          if(uip_flags & UIP_NEWDATA) {
+            uip_len = UIP_TCPIP_HLEN;
+            UIP_TCP_BUF->flags = TCP_ACK;
+            goto tcp_send_noopts;
+          }
+          goto drop;
+        }
+#endif /* UIP_TCP_SEND_WINDOW */
+
         /* If uip_slen > 0, the application has data to be sent. */
         if(uip_slen > 0) {
 
@@ -2211,6 +2522,18 @@ uip_process(uint8_t flag)
       }
   }
   goto drop;
+
+#if UIP_TCP_SEND_WINDOW
+  /* We jump here to retransmit the oldest segment of the send buffer,
+     on timeouts and on duplicate ACKs. */
+ sndbuf_rexmit:
+  uip_slen = uip_connr->len < uip_connr->mss ? uip_connr->len : uip_connr->mss;
+  memcpy(uip_sappdata, uip_connr->sndbuf, uip_slen);
+  sndoff = 0;
+  uip_len = uip_slen + UIP_TCPIP_HLEN;
+  UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+  goto tcp_send_noopts;
+#endif /* UIP_TCP_SEND_WINDOW */
   
   /* We jump here when we are ready to send the packet, and just want
      to set the appropriate TCP sequence numbers in the TCP header. */
@@ -2235,10 +2558,27 @@ uip_process(uint8_t flag)
   UIP_TCP_BUF->ackno[2] = uip_connr->rcv_nxt[2];
   UIP_TCP_BUF->ackno[3] = uip_connr->rcv_nxt[3];
   
-  UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
-  UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
-  UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
-  UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+#if UIP_TCP_SEND_WINDOW
+  if(uip_connr->sndbuf != NULL &&
+     (uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+    /* snd_nxt is the oldest unacknowledged byte of the buffer. */
+    uip_add32(uip_connr->snd_nxt,
+              sndoff == SNDOFF_NXT ? uip_connr->len : sndoff);
+    UIP_TCP_BUF->seqno[0] = uip_acc32[0];
+    UIP_TCP_BUF->seqno[1] = uip_acc32[1];
+    UIP_TCP_BUF->seqno[2] = uip_acc32[2];
+    UIP_TCP_BUF->seqno[3] = uip_acc32[3];
+  } else
+#endif /* UIP_TCP_SEND_WINDOW */
+  {
+    UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
+    UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
+    UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
+    UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+  }
+#if UIP_TCP_SEND_WINDOW
+  sndoff = SNDOFF_NXT;
+#endif /* UIP_TCP_SEND_WINDOW */
 
   UIP_IP_BUF->proto = UIP_PROTO_TCP;
 
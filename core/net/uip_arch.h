@@ -103,6 +103,27 @@ void uip_add32(uint8_t *op32, uint16_t op16);
  */
 uint16_t uip_chksum(uint16_t *buf, uint16_t len);
 
+/**
+ * Add the 16-bit words of a buffer to a one's complement sum.
+ *
+ * An architecture that defines UIP_ARCH_CHKSUM_ADD to 1 provides
+ * this function, which the portable checksum functions of the IPv6
+ * stack then use for all their summing. It is the way to speed up
+ * checksums with wide loads or carry instructions without rewriting
+ * the whole checksum code, as UIP_ARCH_CHKSUM requires.
+ *
+ * \param sum The sum so far, in host byte order.
+ *
+ * \param data A pointer to the data, which needs not be aligned.
+ *
+ * \param len The length of the data. If it is odd, the last byte is
+ * padded with zero.
+ *
+ * \return The one's complement sum of the data and sum, in host byte
+ * order, with its carries folded in.
+ */
+uint16_t uip_arch_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len);
+
 /**
  * Calculate the IP header checksum of the packet header in uip_buf.
  *
@@ -398,6 +398,47 @@
 #define UIP_RECEIVE_WINDOW (UIP_CONF_RECEIVE_WINDOW)
 #endif
 
+/**
+ * The size of the TCP send buffer that uIP allocates for each
+ * connection.
+ *
+ * When non-zero, uIP keeps a copy of the data sent on every TCP
+ * connection until it is acknowledged, so that several segments can
+ * be in flight at once and lost segments are retransmitted by uIP
+ * itself. Applications may also provide their own buffer with
+ * uip_tcp_set_sndbuf(). Must be at least UIP_TCP_MSS.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_TCP_SNDBUF_SIZE
+#define UIP_TCP_SNDBUF_SIZE (UIP_CONF_TCP_SNDBUF_SIZE)
+#else
+#define UIP_TCP_SNDBUF_SIZE 0
+#endif
+
+/**
+ * Determines if support for sending several TCP segments per
+ * connection before they are acknowledged should be compiled in.
+ *
+ * This is on when uIP allocates send buffers, and can be turned on
+ * without them for applications that provide their own with
+ * uip_tcp_set_sndbuf(). Only the IPv6 stack supports it.
+ *
+ * \hideinitializer
+ */
+#if !UIP_CONF_IPV6
+#define UIP_TCP_SEND_WINDOW 0
+#elif defined(UIP_CONF_TCP_SEND_WINDOW)
+#define UIP_TCP_SEND_WINDOW (UIP_CONF_TCP_SEND_WINDOW)
+#else
+#define UIP_TCP_SEND_WINDOW (UIP_TCP_SNDBUF_SIZE > 0)
+#endif
+
+#if UIP_TCP_SEND_WINDOW && UIP_TCP_SNDBUF_SIZE > 0 && \
+  UIP_TCP_SNDBUF_SIZE < UIP_TCP_MSS
+#error UIP_CONF_TCP_SNDBUF_SIZE must be at least UIP_TCP_MSS
+#endif
+
 /**
  * How long a connection should stay in the TIME_WAIT state.
  *
@@ -468,6 +509,50 @@
 #define SICSLOWPAN_REASS_MAXAGE 20
 #endif
 
+/**
+ * How many packets can be reassembled at the same time at the 6lowpan
+ * layer. Each reassembly uses a buffer of UIP_BUFSIZE bytes
+ * (default: 1, platforms with enough RAM may raise it)
+ */
+#ifdef SICSLOWPAN_CONF_REASS_CONTEXTS
+#define SICSLOWPAN_REASS_CONTEXTS (SICSLOWPAN_CONF_REASS_CONTEXTS)
+#else
+#define SICSLOWPAN_REASS_CONTEXTS 1
+#endif
+
+/**
+ * Do we relay the fragments of packets that are not for us as they
+ * arrive, instead of reassembling the whole packet before routing it
+ * (default: no)
+ */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARDING
+#define SICSLOWPAN_FRAG_FORWARDING (SICSLOWPAN_CONF_FRAG_FORWARDING)
+#else
+#define SICSLOWPAN_FRAG_FORWARDING 0
+#endif
+
+/**
+ * How many fragmented packets can be relayed at the same time when
+ * SICSLOWPAN_FRAG_FORWARDING is enabled.
+ */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARD_ENTRIES
+#define SICSLOWPAN_FRAG_FORWARD_ENTRIES (SICSLOWPAN_CONF_FRAG_FORWARD_ENTRIES)
+#else
+#define SICSLOWPAN_FRAG_FORWARD_ENTRIES 4
+#endif
+
+/**
+ * Do we compress the RPL hop-by-hop option and the RPL source routing
+ * header of the packets with 6LoRH headers, when using IPHC. This
+ * changes the frame format, so all the nodes of the network must
+ * agree on it (default: no)
+ */
+#ifdef SICSLOWPAN_CONF_6LORH
+#define SICSLOWPAN_6LORH (SICSLOWPAN_CONF_6LORH)
+#else
+#define SICSLOWPAN_6LORH 0
+#endif
+
 /**
  * Do we compress the IP header or not (default: no)
  */
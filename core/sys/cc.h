@@ -118,6 +118,18 @@
 #define CC_ASSIGN_AGGREGATE(dest, src)	*dest = *src
 #endif /* CC_CONF_ASSIGN_AGGREGATE */
 
+/**
+ * A compiler barrier: the compiler may not move memory accesses
+ * across it. It does not order the accesses of the CPU itself.
+ */
+#ifdef CC_CONF_BARRIER
+#define CC_BARRIER() CC_CONF_BARRIER()
+#elif defined(__GNUC__)
+#define CC_BARRIER() __asm__ __volatile__("" : : : "memory")
+#else /* CC_CONF_BARRIER */
+#define CC_BARRIER()
+#endif /* CC_CONF_BARRIER */
+
 #if CC_CONF_NO_VA_ARGS
 #define CC_NO_VA_ARGS CC_CONF_VA_ARGS
 #endif
@@ -36,6 +36,7 @@
  */
 
 #include "net/uip.h"
+#include "net/uip_arch.h"
 
 #define asmv(arg) __asm__ __volatile__(arg)
 /*---------------------------------------------------------------------------*/
@@ -74,3 +75,65 @@ uip_ipchksum(void)
 #endif
 #endif
 /*---------------------------------------------------------------------------*/
+#if UIP_ARCH_CHKSUM_ADD && !defined(__IAR_SYSTEMS_ICC__)
+uint16_t
+uip_arch_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  register uint16_t acc;
+  register const uint16_t *p;
+  uint16_t words;
+  uint32_t acc32;
+
+  if((uintptr_t)data & 1) {
+    /* Word loads must be aligned: sum the bytes in network order. */
+    acc32 = sum;
+    for(; len > 1; len -= 2, data += 2) {
+      acc32 += ((uint16_t)data[0] << 8) | data[1];
+    }
+    if(len) {
+      acc32 += (uint16_t)data[0] << 8;
+    }
+    acc32 = (acc32 >> 16) + (acc32 & 0xffff);
+    acc32 += acc32 >> 16;
+    return (uint16_t)acc32;
+  }
+
+  /* Sum the little-endian words with the carry flag, eight words per
+     turn, and swap the result to network byte order at the end. */
+  acc = 0;
+  p = (const uint16_t *)data;
+  words = len >> 1;
+  while(words >= 8) {
+    __asm__ __volatile__("add  @%[p]+, %[acc]\n\t"
+                         "addc @%[p]+, %[acc]\n\t"
+                         "addc @%[p]+, %[acc]\n\t"
+                         "addc @%[p]+, %[acc]\n\t"
+                         "addc @%[p]+, %[acc]\n\t"
+                         "addc @%[p]+, %[acc]\n\t"
+                         "addc @%[p]+, %[acc]\n\t"
+                         "addc @%[p]+, %[acc]\n\t"
+                         "addc #0, %[acc]"
+                         : [acc] "+r" (acc), [p] "+r" (p));
+    words -= 8;
+  }
+  while(words > 0) {
+    __asm__ __volatile__("add  @%[p]+, %[acc]\n\t"
+                         "addc #0, %[acc]"
+                         : [acc] "+r" (acc), [p] "+r" (p));
+    words--;
+  }
+  if(len & 1) {
+    /* The last byte is the high byte of a network order word. */
+    __asm__ __volatile__("add  %[b], %[acc]\n\t"
+                         "addc #0, %[acc]"
+                         : [acc] "+r" (acc) : [b] "r" ((uint16_t)*(const uint8_t *)p));
+  }
+
+  acc = (acc << 8) | (acc >> 8);
+  __asm__ __volatile__("add  %[sum], %[acc]\n\t"
+                       "addc #0, %[acc]"
+                       : [acc] "+r" (acc) : [sum] "r" (sum));
+  return acc;
+}
+#endif /* UIP_ARCH_CHKSUM_ADD */
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026, The Contiki-PLB contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         uIP checksum summing for native hosts, using wide loads
+ */
+
+#include "net/uip.h"
+#include "net/uip_arch.h"
+
+#include <string.h>
+
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_arch_chksum_add(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint64_t acc;
+  uint32_t w0, w1, w2, w3;
+  uint16_t h;
+  uint8_t last[2];
+
+  /* The data is loaded 32 bits at a time, in the byte order of the
+     host, into a 64-bit accumulator. The one's complement sum does
+     not depend on the byte order (RFC1071), so the folded result only
+     needs one swap to network order at the end. memcpy() does the
+     unaligned loads, and compiles into plain loads on hosts that
+     allow them. */
+  acc = 0;
+  while(len >= 16) {
+    memcpy(&w0, data, 4);
+    memcpy(&w1, data + 4, 4);
+    memcpy(&w2, data + 8, 4);
+    memcpy(&w3, data + 12, 4);
+    acc += (uint64_t)w0 + w1 + w2 + w3;
+    data += 16;
+    len -= 16;
+  }
+  while(len >= 4) {
+    memcpy(&w0, data, 4);
+    acc += w0;
+    data += 4;
+    len -= 4;
+  }
+  if(len >= 2) {
+    memcpy(&h, data, 2);
+    acc += h;
+    data += 2;
+    len -= 2;
+  }
+  if(len == 1) {
+    last[0] = data[0];
+    last[1] = 0;
+    memcpy(&h, last, 2);
+    acc += h;
+  }
+
+  acc = (acc >> 32) + (acc & 0xffffffff);
+  acc = (acc >> 16) + (acc & 0xffff);
+  acc = (acc >> 16) + (acc & 0xffff);
+  acc = (acc >> 16) + (acc & 0xffff);
+
+  /* Add the sum so far, which is in host byte order. */
+  acc = uip_ntohs((uint16_t)acc) + (uint32_t)sum;
+  acc = (acc >> 16) + (acc & 0xffff);
+
+  return (uint16_t)acc;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2026, The Contiki-PLB contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Benchmark of the uIP IPv6 checksum functions.
+ *
+ *         Checks uip_udpchksum() and uip_chksum_update16() against a
+ *         plain byte-pair implementation, and reports how many
+ *         rtimer ticks a batch of checksums takes for several
+ *         payload sizes. Build it with and without
+ *         UIP_ARCH_CHKSUM_ADD to compare the architecture summing.
+ */
+
+#include "contiki.h"
+#include "net/uip.h"
+#include "sys/rtimer.h"
+#include "lib/random.h"
+#include "dev/watchdog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define UIP_IP_BUF   ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_UDP_BUF  ((struct uip_udp_hdr *)&uip_buf[UIP_LLIPH_LEN])
+
+#define ROUNDS       1000
+#define MAX_PAYLOAD  (UIP_BUFSIZE - UIP_LLH_LEN - UIP_IPUDPH_LEN)
+
+static const uint16_t sizes[] = { 8, 32, 64, 128, 256, MAX_PAYLOAD };
+/*---------------------------------------------------------------------------*/
+PROCESS(chksum_bench_process, "Checksum benchmark");
+AUTOSTART_PROCESSES(&chksum_bench_process);
+/*---------------------------------------------------------------------------*/
+static uint16_t
+ref_sum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint16_t t;
+
+  for(; len > 1; len -= 2, data += 2) {
+    t = (data[0] << 8) + data[1];
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+  }
+  if(len == 1) {
+    t = data[0] << 8;
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+  }
+  return sum;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+ref_udpchksum(void)
+{
+  uint16_t len;
+  uint16_t sum;
+
+  len = (UIP_IP_BUF->len[0] << 8) + UIP_IP_BUF->len[1];
+  sum = len + UIP_PROTO_UDP;
+  sum = ref_sum(sum, (uint8_t *)&UIP_IP_BUF->srcipaddr,
+                2 * sizeof(uip_ipaddr_t));
+  sum = ref_sum(sum, &uip_buf[UIP_LLIPH_LEN], len);
+  return (sum == 0) ? 0xffff : uip_htons(sum);
+}
+/*---------------------------------------------------------------------------*/
+static void
+make_packet(uint16_t payload_len)
+{
+  uint16_t i;
+  uint16_t len;
+
+  for(i = 0; i < UIP_BUFSIZE; i++) {
+    uip_buf[i] = random_rand();
+  }
+  len = UIP_UDPH_LEN + payload_len;
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->tcflow = 0;
+  UIP_IP_BUF->flow = 0;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  UIP_IP_BUF->len[0] = len >> 8;
+  UIP_IP_BUF->len[1] = len & 0xff;
+  UIP_UDP_BUF->udplen = UIP_HTONS(len);
+  UIP_UDP_BUF->udpchksum = 0;
+  uip_len = UIP_IPH_LEN + len;
+  uip_ext_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+check(void)
+{
+  int errors;
+  uint16_t i, s;
+  uint16_t payload_len;
+  uint16_t old_word, new_word;
+  uint8_t *word;
+
+  errors = 0;
+  for(i = 0; i < 200; i++) {
+    /* Odd sizes too, to check the padding of the last byte. */
+    payload_len = 2 + random_rand() % (MAX_PAYLOAD - 1);
+    make_packet(payload_len);
+    if(uip_udpchksum() != ref_udpchksum()) {
+      errors++;
+    }
+
+    /* Rewrite a word of the payload and update the checksum. */
+    UIP_UDP_BUF->udpchksum = ~uip_udpchksum();
+    s = UIP_UDP_BUF->udpchksum;
+    word = &uip_buf[UIP_LLIPH_LEN + UIP_UDPH_LEN +
+                    2 * (random_rand() % (payload_len / 2))];
+    memcpy(&old_word, word, 2);
+    new_word = random_rand();
+    memcpy(word, &new_word, 2);
+    UIP_UDP_BUF->udpchksum = uip_chksum_update16(s, old_word, new_word);
+    if(uip_udpchksum() != 0xffff) {
+      errors++;
+    }
+  }
+  return errors;
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench(uint16_t payload_len)
+{
+  rtimer_clock_t start;
+  rtimer_clock_t full, ref, update;
+  uint16_t i;
+  volatile uint16_t s;
+
+  make_packet(payload_len);
+
+  start = RTIMER_NOW();
+  for(i = 0; i < ROUNDS; i++) {
+    s = ref_udpchksum();
+  }
+  ref = RTIMER_NOW() - start;
+  watchdog_periodic();
+
+  start = RTIMER_NOW();
+  for(i = 0; i < ROUNDS; i++) {
+    s = uip_udpchksum();
+  }
+  full = RTIMER_NOW() - start;
+  watchdog_periodic();
+
+  start = RTIMER_NOW();
+  for(i = 0; i < ROUNDS; i++) {
+    s = uip_chksum_update16(s, i, i + 1);
+  }
+  update = RTIMER_NOW() - start;
+  watchdog_periodic();
+
+  printf("%4u bytes: byte-pair %5u, uip %5u, incremental %5u ticks\n",
+         payload_len, (unsigned)ref, (unsigned)full, (unsigned)update);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(chksum_bench_process, ev, data)
+{
+  static int i;
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  printf("Checksum benchmark: %u checksums per batch, %lu ticks/s\n",
+         ROUNDS, (unsigned long)RTIMER_SECOND);
+  printf("Correctness: %d errors\n", check());
+
+  for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    if(sizes[i] > MAX_PAYLOAD) {
+      continue;
+    }
+    bench(sizes[i]);
+    /* Let the rest of the system run between the batches. */
+    etimer_set(&et, CLOCK_SECOND / 8);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -60,8 +60,7 @@ static int callback_pos;
 struct tx_callback {
   mac_callback_t cback;
   void *ptr;
-  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
-  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  struct packetbuf_attrs_packed attrs;
 };
 
 static struct tx_callback callbacks[MAX_CALLBACKS];
@@ -72,7 +71,7 @@ void packet_sent(uint8_t sessionid, uint8_t status, uint8_t tx)
     struct tx_callback *callback;
     callback = &callbacks[sessionid];
     packetbuf_clear();
-    packetbuf_attr_copyfrom(callback->attrs, callback->addrs);
+    packetbuf_attr_unpack(&callback->attrs);
     mac_call_sent_callback(callback->cback, callback->ptr, status, tx);
   } else {
     PRINTF("*** ERROR: too high session id %d\n", sessionid);
@@ -87,7 +86,7 @@ setup_callback(mac_callback_t sent, void *ptr)
   callback = &callbacks[callback_pos];
   callback->cback = sent;
   callback->ptr = ptr;
-  packetbuf_attr_copyto(callback->attrs, callback->addrs);
+  packetbuf_attr_pack(&callback->attrs);
 
   callback_pos++;
   if(callback_pos >= MAX_CALLBACKS) {
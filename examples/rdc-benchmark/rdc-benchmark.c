@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2026, The Contiki-PLB contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A benchmark for comparing the RDC drivers under identical
+ *         traffic
+ *
+ *         Node 1 is the sink. The other nodes send to it with the
+ *         traffic pattern selected at compile time with
+ *         RDC_BENCHMARK_CONF_PATTERN:
+ *
+ *         - PERIODIC: one unicast packet per interval.
+ *         - BURSTY: a burst of packets per burst interval.
+ *         - CONVERGECAST: one packet per interval, collected over
+ *           multiple hops.
+ *         - BIDIRECTIONAL: as PERIODIC, and the sink echoes every
+ *           packet back to its originator.
+ *
+ *         The nodes log every packet sent and received, and their
+ *         energest and rimestats counters, on the serial port. The
+ *         latency, the delivery ratio, the duty cycle and the number
+ *         of transmissions per packet are computed from the log by
+ *         the script of rdc-benchmark.csc, so that the latency is
+ *         measured on the simulation clock.
+ */
+
+#include "contiki.h"
+#include "net/rime.h"
+#include "net/rime/collect.h"
+#include "net/rime/rimestats.h"
+#include "net/netstack.h"
+#include "lib/random.h"
+#include "sys/energest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define RDC_BENCHMARK_PERIODIC      1
+#define RDC_BENCHMARK_BURSTY        2
+#define RDC_BENCHMARK_CONVERGECAST  3
+#define RDC_BENCHMARK_BIDIRECTIONAL 4
+
+#ifdef RDC_BENCHMARK_CONF_PATTERN
+#define PATTERN RDC_BENCHMARK_CONF_PATTERN
+#else
+#define PATTERN RDC_BENCHMARK_PERIODIC
+#endif
+
+#ifdef RDC_BENCHMARK_CONF_INTERVAL
+#define INTERVAL RDC_BENCHMARK_CONF_INTERVAL
+#else
+#define INTERVAL (CLOCK_SECOND * 10)
+#endif
+
+#ifdef RDC_BENCHMARK_CONF_BURST_SIZE
+#define BURST_SIZE RDC_BENCHMARK_CONF_BURST_SIZE
+#else
+#define BURST_SIZE 5
+#endif
+
+#ifdef RDC_BENCHMARK_CONF_BURST_INTERVAL
+#define BURST_INTERVAL RDC_BENCHMARK_CONF_BURST_INTERVAL
+#else
+#define BURST_INTERVAL (CLOCK_SECOND * 60)
+#endif
+
+#ifdef RDC_BENCHMARK_CONF_PAYLOAD_SIZE
+#define PAYLOAD_SIZE RDC_BENCHMARK_CONF_PAYLOAD_SIZE
+#else
+#define PAYLOAD_SIZE 32
+#endif
+
+#ifdef RDC_BENCHMARK_CONF_STATS_INTERVAL
+#define STATS_INTERVAL RDC_BENCHMARK_CONF_STATS_INTERVAL
+#else
+#define STATS_INTERVAL (CLOCK_SECOND * 30)
+#endif
+
+#if PATTERN == RDC_BENCHMARK_BURSTY
+#define SEND_INTERVAL BURST_INTERVAL
+#else
+#define SEND_INTERVAL INTERVAL
+#endif
+
+/* The time to let the network settle before sending. */
+#define WARMUP_TIME (CLOCK_SECOND * 30)
+
+#define SINK_ID 1
+#define CHANNEL 140
+
+struct benchmark_msg {
+  uint16_t seqno;
+  uint8_t pattern;
+  uint8_t padding[PAYLOAD_SIZE - 3];
+};
+
+static uint16_t seqno;
+static unsigned long packets_sent;
+static unsigned long mac_transmissions;
+/*---------------------------------------------------------------------------*/
+PROCESS(rdc_benchmark_process, "RDC benchmark");
+PROCESS(stats_process, "RDC benchmark statistics");
+AUTOSTART_PROCESSES(&rdc_benchmark_process, &stats_process);
+/*---------------------------------------------------------------------------*/
+static int
+addr_to_id(const rimeaddr_t *addr)
+{
+  return addr->u8[0] + (addr->u8[1] << 8);
+}
+/*---------------------------------------------------------------------------*/
+static int
+is_sink(void)
+{
+  return addr_to_id(&rimeaddr_node_addr) == SINK_ID;
+}
+/*---------------------------------------------------------------------------*/
+static void
+prepare_packet(uint16_t s)
+{
+  struct benchmark_msg msg;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.seqno = s;
+  msg.pattern = PATTERN;
+  packetbuf_copyfrom(&msg, sizeof(msg));
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+received_seqno(void)
+{
+  struct benchmark_msg msg;
+
+  memcpy(&msg, packetbuf_dataptr(), sizeof(msg.seqno));
+  return msg.seqno;
+}
+/*---------------------------------------------------------------------------*/
+#if PATTERN == RDC_BENCHMARK_CONVERGECAST
+static struct collect_conn collect;
+
+static void
+collect_recv(const rimeaddr_t *originator, uint8_t collect_seqno, uint8_t hops)
+{
+  printf("BM RX %d %u %u\n", addr_to_id(originator), received_seqno(), hops);
+}
+static const struct collect_callbacks collect_call = {collect_recv};
+/*---------------------------------------------------------------------------*/
+static void
+send_to_sink(void)
+{
+  prepare_packet(++seqno);
+  printf("BM TX %u %d\n", seqno, SINK_ID);
+  packets_sent++;
+  collect_send(&collect, 15);
+}
+#else /* PATTERN == RDC_BENCHMARK_CONVERGECAST */
+static struct unicast_conn uc;
+
+static void
+send_unicast(const rimeaddr_t *to, uint16_t s)
+{
+  prepare_packet(s);
+  printf("BM TX %u %d\n", s, addr_to_id(to));
+  packets_sent++;
+  unicast_send(&uc, to);
+}
+/*---------------------------------------------------------------------------*/
+static void
+recv_uc(struct unicast_conn *c, const rimeaddr_t *from)
+{
+  uint16_t s;
+
+  s = received_seqno();
+  printf("BM RX %d %u 1\n", addr_to_id(from), s);
+#if PATTERN == RDC_BENCHMARK_BIDIRECTIONAL
+  if(is_sink()) {
+    /* Echo the packet back to its originator. */
+    send_unicast(from, s);
+  }
+#endif /* PATTERN == RDC_BENCHMARK_BIDIRECTIONAL */
+}
+/*---------------------------------------------------------------------------*/
+static void
+sent_uc(struct unicast_conn *c, int status, int num_tx)
+{
+  mac_transmissions += num_tx;
+}
+static const struct unicast_callbacks unicast_callbacks = {recv_uc, sent_uc};
+/*---------------------------------------------------------------------------*/
+static void
+send_to_sink(void)
+{
+  rimeaddr_t sink;
+
+  sink.u8[0] = SINK_ID & 0xff;
+  sink.u8[1] = SINK_ID >> 8;
+  send_unicast(&sink, ++seqno);
+}
+#endif /* PATTERN == RDC_BENCHMARK_CONVERGECAST */
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(rdc_benchmark_process, ev, data)
+{
+  static struct etimer periodic, et;
+#if PATTERN == RDC_BENCHMARK_BURSTY
+  static int i;
+#endif /* PATTERN == RDC_BENCHMARK_BURSTY */
+
+  PROCESS_BEGIN();
+
+  printf("BM START %s %d\n", NETSTACK_RDC.name, PATTERN);
+
+#if PATTERN == RDC_BENCHMARK_CONVERGECAST
+  collect_open(&collect, CHANNEL, COLLECT_ROUTER, &collect_call);
+  if(is_sink()) {
+    collect_set_sink(&collect, 1);
+  }
+#else /* PATTERN == RDC_BENCHMARK_CONVERGECAST */
+  unicast_open(&uc, CHANNEL, &unicast_callbacks);
+#endif /* PATTERN == RDC_BENCHMARK_CONVERGECAST */
+
+  if(is_sink()) {
+    PROCESS_EXIT();
+  }
+
+  etimer_set(&et, WARMUP_TIME);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  etimer_set(&periodic, SEND_INTERVAL);
+
+  while(1) {
+    /* Send at a random point of the first half of each interval, so
+       that the nodes do not stay in step. */
+    etimer_set(&et, random_rand() % (SEND_INTERVAL / 2));
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+#if PATTERN == RDC_BENCHMARK_BURSTY
+    for(i = 0; i < BURST_SIZE; i++) {
+      send_to_sink();
+      /* Let the MAC layer take the packet before the next one. */
+      PROCESS_PAUSE();
+    }
+#else /* PATTERN == RDC_BENCHMARK_BURSTY */
+    send_to_sink();
+#endif /* PATTERN == RDC_BENCHMARK_BURSTY */
+
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&periodic));
+    etimer_reset(&periodic);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(stats_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&et, STATS_INTERVAL);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+
+    /* The counters are cumulative; the script uses the last ones. */
+    energest_flush();
+    printf("BM STATS %lu %lu %lu %lu %lu %lu %lu\n",
+           energest_type_time(ENERGEST_TYPE_CPU),
+           energest_type_time(ENERGEST_TYPE_LPM),
+           energest_type_time(ENERGEST_TYPE_TRANSMIT),
+           energest_type_time(ENERGEST_TYPE_LISTEN),
+           (unsigned long)RIMESTATS_GET(lltx),
+           mac_transmissions, packets_sent);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,232 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<simconf>
+  <project EXPORT="discard">[CONTIKI_DIR]/tools/cooja/apps/mspsim</project>
+  <simulation>
+    <title>RDC benchmark: @RDC@, @PATTERN@</title>
+    <delaytime>0</delaytime>
+    <randomseed>@SEED@</randomseed>
+    <motedelay_us>1000000</motedelay_us>
+    <radiomedium>
+      se.sics.cooja.radiomediums.UDGM
+      <transmitting_range>@RANGE@</transmitting_range>
+      <interference_range>@INTERFERENCE_RANGE@</interference_range>
+      <success_ratio_tx>1.0</success_ratio_tx>
+      <success_ratio_rx>@SUCCESS_RATIO@</success_ratio_rx>
+    </radiomedium>
+    <events>
+      <logoutput>40000</logoutput>
+    </events>
+    <motetype>
+      se.sics.cooja.mspmote.SkyMoteType
+      <identifier>sky1</identifier>
+      <description>RDC benchmark node</description>
+      <source EXPORT="discard">[CONTIKI_DIR]/examples/rdc-benchmark/rdc-benchmark.c</source>
+      <commands EXPORT="discard">make rdc-benchmark.sky TARGET=sky RDC=@RDC@ PATTERN=@PATTERN@</commands>
+      <firmware EXPORT="copy">[CONTIKI_DIR]/examples/rdc-benchmark/rdc-benchmark.sky</firmware>
+      <moteinterface>se.sics.cooja.interfaces.Position</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.RimeAddress</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.IPAddress</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.MoteAttributes</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspClock</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspMoteID</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyButton</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyFlash</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyCoffeeFilesystem</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyByteRadio</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspSerial</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyLED</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.MspDebugOutput</moteinterface>
+      <moteinterface>se.sics.cooja.mspmote.interfaces.SkyTemperature</moteinterface>
+    </motetype>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>0.0</x>
+        <y>0.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>1</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>30.0</x>
+        <y>20.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>2</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>30.0</x>
+        <y>-20.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>3</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>65.0</x>
+        <y>20.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>4</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>65.0</x>
+        <y>-20.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>5</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>95.0</x>
+        <y>10.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>6</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+    <mote>
+      <breakpoints />
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>95.0</x>
+        <y>-10.0</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.mspmote.interfaces.MspMoteID
+        <id>7</id>
+      </interface_config>
+      <motetype_identifier>sky1</motetype_identifier>
+    </mote>
+  </simulation>
+  <plugin>
+    se.sics.cooja.plugins.ScriptRunner
+    <plugin_config>
+      <script>/*
+ * Computes the benchmark results from the BM lines of the motes
+ * and logs them as a CSV line:
+ * CSV,rdc,pattern,sent,received,pdr,latency_p50_ms,latency_p90_ms,
+ *   latency_p99_ms,duty_cycle_pct,mac_tx_per_packet,radio_tx_per_packet
+ * Packets sent in the last DRAIN seconds are not counted, to let them
+ * arrive.
+ */
+DURATION = @DURATION@ * 1000000;
+DRAIN = 30 * 1000000;
+TIMEOUT(@DURATION@ * 1000 + 120000);
+
+rdc = "@RDC@";
+pattern = "@PATTERN@";
+txTime = new Object();
+latencies = new Array();
+sent = 0;
+received = 0;
+stats = new Object();
+
+function percentile(a, p) {
+  if(a.length == 0) {
+    return "NA";
+  }
+  return a[Math.min(a.length - 1, Math.floor(a.length * p / 100))] / 1000;
+}
+
+while(time &lt; DURATION) {
+  YIELD();
+
+  m = msg.split(" ");
+  if(m.length &lt; 2 || !m[0].equals("BM")) {
+    continue;
+  }
+  if(m[1].equals("TX") &amp;&amp; time &lt; DURATION - DRAIN) {
+    /* BM TX seqno destination */
+    txTime[id + ":" + m[3] + ":" + m[2]] = time;
+    sent++;
+  } else if(m[1].equals("RX")) {
+    /* BM RX source seqno hops */
+    key = m[2] + ":" + id + ":" + m[3];
+    if(txTime[key] != undefined) {
+      latencies.push(time - txTime[key]);
+      delete txTime[key];
+      received++;
+    }
+  } else if(m[1].equals("STATS")) {
+    /* BM STATS cpu lpm transmit listen lltx mactx sent */
+    stats[id] = m;
+  }
+}
+
+latencies.sort(function(a, b) { return a - b; });
+
+dutyCycle = 0;
+nodes = 0;
+lltx = 0;
+mactx = 0;
+packets = 0;
+for(n in stats) {
+  s = stats[n];
+  total = parseInt(s[2]) + parseInt(s[3]);
+  if(total &gt; 0) {
+    dutyCycle += (parseInt(s[4]) + parseInt(s[5])) / total;
+    nodes++;
+  }
+  lltx += parseInt(s[6]);
+  mactx += parseInt(s[7]);
+  packets += parseInt(s[8]);
+}
+
+log.log("CSV," + rdc + "," + pattern + "," + sent + "," + received + "," +
+        (sent &gt; 0 ? received / sent : "NA") + "," +
+        percentile(latencies, 50) + "," +
+        percentile(latencies, 90) + "," +
+        percentile(latencies, 99) + "," +
+        (nodes &gt; 0 ? 100 * dutyCycle / nodes : "NA") + "," +
+        (packets &gt; 0 &amp;&amp; mactx &gt; 0 ? mactx / packets : "NA") + "," +
+        (packets &gt; 0 ? lltx / packets : "NA") + "\n");
+log.testOK();</script>
+      <active>true</active>
+    </plugin_config>
+    <width>600</width>
+    <z>0</z>
+    <height>700</height>
+    <location_x>0</location_x>
+    <location_y>0</location_y>
+  </plugin>
+</simconf>
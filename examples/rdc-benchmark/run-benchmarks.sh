@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Run the RDC benchmark in Cooja for each RDC driver and traffic
+# pattern, and collect the results in results.csv.
+#
+# The drivers and patterns, and the simulation parameters, may be
+# overridden from the environment, for example
+#   RDCS="contikimac plb" PATTERNS=BURSTY DURATION=1200 ./run-benchmarks.sh
+#
+# The single hop patterns run with all nodes in range of the sink,
+# CONVERGECAST with a shorter range that makes a three hop network.
+
+CONTIKI=../..
+RDCS=${RDCS:-"nullrdc contikimac xmac cxmac lpp plb"}
+PATTERNS=${PATTERNS:-"PERIODIC BURSTY CONVERGECAST BIDIRECTIONAL"}
+DURATION=${DURATION:-600}
+SUCCESS_RATIO=${SUCCESS_RATIO:-1.0}
+SEED=${SEED:-123456}
+RESULTS=${RESULTS:-results.csv}
+
+if [ ! -f $CONTIKI/tools/cooja/dist/cooja.jar ]; then
+  (cd $CONTIKI/tools/cooja && ant jar) || exit 1
+fi
+
+echo "rdc,pattern,sent,received,pdr,latency_p50_ms,latency_p90_ms,latency_p99_ms,duty_cycle_pct,mac_tx_per_packet,radio_tx_per_packet" > $RESULTS
+
+for rdc in $RDCS; do
+  for pattern in $PATTERNS; do
+    if [ $pattern = CONVERGECAST ]; then
+      range=40.0
+    else
+      range=100.0
+    fi
+    sed -e "s/@RDC@/$rdc/g" \
+        -e "s/@PATTERN@/$pattern/g" \
+        -e "s/@DURATION@/$DURATION/g" \
+        -e "s/@RANGE@/$range/g" \
+        -e "s/@INTERFERENCE_RANGE@/$range/g" \
+        -e "s/@SUCCESS_RATIO@/$SUCCESS_RATIO/g" \
+        -e "s/@SEED@/$SEED/g" \
+        rdc-benchmark.csc > rdc-benchmark-run.csc
+
+    # The defines are compiled into all objects.
+    make TARGET=sky clean > /dev/null
+
+    echo "Running $rdc $pattern"
+    rm -f COOJA.testlog
+    java -jar $CONTIKI/tools/cooja/dist/cooja.jar \
+      -nogui=rdc-benchmark-run.csc -contiki=$CONTIKI > rdc-benchmark-$rdc-$pattern.log
+    if grep -q "^CSV," COOJA.testlog 2> /dev/null; then
+      grep "^CSV," COOJA.testlog | sed -e 's/^CSV,//' >> $RESULTS
+    else
+      echo "$rdc,$pattern,FAILED" >> $RESULTS
+    fi
+  done
+done
+
+rm -f rdc-benchmark-run.csc
@@ -74,6 +74,10 @@ typedef unsigned short uip_stats_t;
 #define UIP_CONF_TCP_SPLIT       0
 #define UIP_CONF_LOGGING         0
 #define UIP_CONF_UDP_CHECKSUMS   1
+/* Sum checksums with wide loads, see cpu/native/uip-chksum.c */
+#define UIP_ARCH_CHKSUM_ADD      1
+/* Queue packets received while tcpip_process is busy */
+#define UIP_CONF_INPUT_QUEUE_LEN 4
 
 #ifndef NETSTACK_CONF_RDC_CHANNEL_CHECK_RATE
 #define NETSTACK_CONF_RDC_CHANNEL_CHECK_RATE 8
@@ -0,0 +1,79 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<simconf>
+  <project>[CONTIKI_DIR]/tools/cooja/apps/mrm</project>
+  <project>[CONTIKI_DIR]/tools/cooja/apps/mspsim</project>
+  <project>[CONTIKI_DIR]/tools/cooja/apps/avrora</project>
+  <project>[CONTIKI_DIR]/tools/cooja/apps/native_gateway</project>
+  <simulation>
+    <title>My simulation</title>
+    <delaytime>0</delaytime>
+    <randomseed>generated</randomseed>
+    <motedelay_us>1000000</motedelay_us>
+    <radiomedium>
+      se.sics.cooja.radiomediums.UDGM
+      <transmitting_range>50.0</transmitting_range>
+      <interference_range>100.0</interference_range>
+      <success_ratio_tx>1.0</success_ratio_tx>
+      <success_ratio_rx>1.0</success_ratio_rx>
+    </radiomedium>
+    <events>
+      <logoutput>40000</logoutput>
+    </events>
+    <motetype>
+      se.sics.cooja.contikimote.ContikiMoteType
+      <identifier>mtype783</identifier>
+      <description>nbr-table test</description>
+      <contikiapp>[CONFIG_DIR]/code/nbr-table/nbr-table-test.c</contikiapp>
+      <commands>make TARGET=cooja clean
+make nbr-table-test.cooja TARGET=cooja</commands>
+      <moteinterface>se.sics.cooja.interfaces.Position</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.Battery</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiVib</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiMoteID</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiRS232</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiBeeper</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiIPAddress</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiRadio</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiButton</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiPIR</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiClock</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiLED</moteinterface>
+      <moteinterface>se.sics.cooja.contikimote.interfaces.ContikiCFS</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.RimeAddress</moteinterface>
+      <moteinterface>se.sics.cooja.interfaces.MoteAttributes</moteinterface>
+      <symbols>false</symbols>
+    </motetype>
+    <mote>
+      <interface_config>
+        se.sics.cooja.interfaces.Position
+        <x>98.76075470611741</x>
+        <y>30.469519951198897</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        se.sics.cooja.contikimote.interfaces.ContikiMoteID
+        <id>1</id>
+      </interface_config>
+      <motetype_identifier>mtype783</motetype_identifier>
+    </mote>
+  </simulation>
+  <plugin>
+    se.sics.cooja.plugins.ScriptRunner
+    <plugin_config>
+      <script>TIMEOUT(10000, log.log("last msg: " + msg + "\n")); /* print last msg at timeout */
+YIELD_THEN_WAIT_UNTIL(msg.contains("TEST OK") || msg.contains("TEST FAILED"));
+if(msg.contains("TEST FAILED")) {
+  log.testFailed();
+}
+log.testOK(); /* Report test success and quit */</script>
+      <active>true</active>
+    </plugin_config>
+    <width>600</width>
+    <z>0</z>
+    <height>520</height>
+    <location_x>250</location_x>
+    <location_y>-1</location_y>
+    <minimized>false</minimized>
+  </plugin>
+</simconf>
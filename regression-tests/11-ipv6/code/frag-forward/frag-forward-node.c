@@ -0,0 +1,111 @@
+/*
+ * Sends a fragmented UDP packet along a line of four nodes whose
+ * relays forward the fragments without reassembling the packet. The
+ * first relay must carry the source IID inline, which its previous
+ * hop, the source, could elide: the compressed headers grow and no
+ * longer fit in the first fragment.
+ */
+#include "contiki.h"
+#include "contiki-lib.h"
+#include "contiki-net.h"
+#include "sys/node-id.h"
+
+#include <stdio.h>
+
+#define UDP_PORT 61618
+
+#define SOURCE_ID       1
+#define DESTINATION_ID  4
+#define PAYLOAD_LEN     150
+
+#define SEND_INTERVAL   (5 * CLOCK_SECOND)
+
+static struct simple_udp_connection connection;
+static uint8_t payload[PAYLOAD_LEN];
+/*---------------------------------------------------------------------------*/
+/* The addresses of a node, as set by the Cooja platform */
+static void
+node_addr(uint16_t id, uip_lladdr_t *lladdr, uip_ipaddr_t *global,
+          uip_ipaddr_t *local)
+{
+  int i;
+
+  for(i = 0; i < sizeof(lladdr->addr); i += 2) {
+    lladdr->addr[i] = id >> 8;
+    lladdr->addr[i + 1] = id & 0xff;
+  }
+  uip_ip6addr(global, 0xaaaa, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(global, lladdr);
+  uip_create_linklocal_prefix(local);
+  uip_ds6_set_addr_iid(local, lladdr);
+}
+/*---------------------------------------------------------------------------*/
+static void
+receiver(struct simple_udp_connection *c,
+         const uip_ipaddr_t *sender_addr,
+         uint16_t sender_port,
+         const uip_ipaddr_t *receiver_addr,
+         uint16_t receiver_port,
+         const uint8_t *data,
+         uint16_t datalen)
+{
+  int i;
+
+  printf("Data received from %d.%d length %d\n",
+         sender_addr->u8[14], sender_addr->u8[15], datalen);
+  for(i = 0; i < datalen; i++) {
+    if(data[i] != (uint8_t)i) {
+      break;
+    }
+  }
+  if(datalen == PAYLOAD_LEN && i == datalen) {
+    printf("TEST OK\n");
+  } else {
+    printf("TEST FAILED\n");
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(frag_forward_process, "Fragment forwarding test");
+AUTOSTART_PROCESSES(&frag_forward_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(frag_forward_process, ev, data)
+{
+  static struct etimer periodic_timer;
+  static uip_ipaddr_t destination;
+  uip_ipaddr_t global, local;
+  uip_lladdr_t lladdr;
+  int i;
+
+  PROCESS_BEGIN();
+
+  simple_udp_register(&connection, UDP_PORT,
+                      NULL, UDP_PORT, receiver);
+
+  /* Static routes along the line towards the destination */
+  node_addr(DESTINATION_ID, &lladdr, &destination, &local);
+  if(node_id < DESTINATION_ID) {
+    node_addr(node_id + 1, &lladdr, &global, &local);
+    uip_ds6_nbr_add(&local, &lladdr, 0, NBR_REACHABLE);
+    uip_ds6_route_add(&destination, 128, &local);
+  }
+
+  if(node_id != SOURCE_ID) {
+    PROCESS_WAIT_EVENT_UNTIL(0);
+  }
+
+  for(i = 0; i < PAYLOAD_LEN; i++) {
+    payload[i] = i;
+  }
+
+  etimer_set(&periodic_timer, SEND_INTERVAL);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&periodic_timer));
+    etimer_reset(&periodic_timer);
+
+    printf("Sending %d bytes\n", PAYLOAD_LEN);
+    simple_udp_sendto(&connection, payload, PAYLOAD_LEN, &destination);
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,125 @@
+/*
+ * Checks that an INCOMPLETE neighbor cache entry resolves when a
+ * solicited NA carries a link-layer address that another neighbor
+ * table, such as the RPL parent table, already uses.
+ */
+#include "contiki.h"
+#include "contiki-lib.h"
+#include "contiki-net.h"
+#include "net/nbr-table.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define UIP_IP_BUF   ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define UIP_ICMP_BUF ((struct uip_icmp_hdr *)&uip_buf[uip_l2_l3_hdr_len])
+#define UIP_ND6_NA_BUF ((uip_nd6_na *)&uip_buf[uip_l2_l3_icmp_hdr_len])
+
+struct parent {
+  uint16_t rank;
+};
+NBR_TABLE(struct parent, parents);
+
+static int failed;
+/*---------------------------------------------------------------------------*/
+static void
+check(int cond, const char *what)
+{
+  if(!cond) {
+    printf("FAILED: %s\n", what);
+    failed = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Put a solicited NA from ipaddr, with lladdr as TLLAO, into uip_buf
+   and process it */
+static void
+na_input(uip_ipaddr_t *ipaddr, uip_lladdr_t *lladdr)
+{
+  uint8_t *opt;
+
+  memset(uip_buf, 0, UIP_BUFSIZE);
+  uip_ext_len = 0;
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->ttl = UIP_ND6_HOP_LIMIT;
+  UIP_IP_BUF->proto = UIP_PROTO_ICMP6;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, ipaddr);
+  uip_create_linklocal_prefix(&UIP_IP_BUF->destipaddr);
+  uip_ds6_set_addr_iid(&UIP_IP_BUF->destipaddr, &uip_lladdr);
+  UIP_ICMP_BUF->type = ICMP6_NA;
+  UIP_ICMP_BUF->icode = 0;
+  UIP_ND6_NA_BUF->flagsreserved =
+    UIP_ND6_NA_FLAG_SOLICITED | UIP_ND6_NA_FLAG_OVERRIDE;
+  uip_ipaddr_copy(&UIP_ND6_NA_BUF->tgtipaddr, ipaddr);
+  opt = &uip_buf[uip_l2_l3_icmp_hdr_len + UIP_ND6_NA_LEN];
+  opt[UIP_ND6_OPT_TYPE_OFFSET] = UIP_ND6_OPT_TLLAO;
+  opt[UIP_ND6_OPT_LEN_OFFSET] = UIP_ND6_OPT_LLAO_LEN >> 3;
+  memcpy(&opt[UIP_ND6_OPT_DATA_OFFSET], lladdr, UIP_LLADDR_LEN);
+  uip_len = UIP_IPH_LEN + UIP_ICMPH_LEN + UIP_ND6_NA_LEN + UIP_ND6_OPT_LLAO_LEN;
+
+  uip_nd6_na_input();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS(nbr_table_test_process, "nbr-table test");
+AUTOSTART_PROCESSES(&nbr_table_test_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(nbr_table_test_process, ev, data)
+{
+  static uip_ipaddr_t ipaddr, ipaddr2;
+  static uip_lladdr_t lladdr, lladdr2;
+  struct parent *p;
+  uip_ds6_nbr_t *nbr;
+
+  PROCESS_BEGIN();
+
+  nbr_table_register(parents, NULL);
+
+  memset(&lladdr, 0, sizeof(lladdr));
+  lladdr.addr[0] = 0x02;
+  lladdr.addr[UIP_LLADDR_LEN - 1] = 0x2a;
+  uip_create_linklocal_prefix(&ipaddr);
+  uip_ds6_set_addr_iid(&ipaddr, &lladdr);
+
+  /* The peer is already an RPL parent */
+  p = nbr_table_add_lladdr(parents, (rimeaddr_t *)&lladdr);
+  check(p != NULL, "add parent");
+  p->rank = 256;
+
+  /* Resolving its address starts with an INCOMPLETE entry */
+  nbr = uip_ds6_nbr_add(&ipaddr, NULL, 0, NBR_INCOMPLETE);
+  check(nbr != NULL, "add INCOMPLETE neighbor");
+
+  na_input(&ipaddr, &lladdr);
+
+  nbr = uip_ds6_nbr_lookup(&ipaddr);
+  check(nbr != NULL, "neighbor still in the cache");
+  check(nbr != NULL && nbr->state == NBR_REACHABLE, "neighbor REACHABLE");
+  check(uip_ds6_nbr_ll_lookup(&lladdr) == nbr, "neighbor found by lladdr");
+  check(nbr_table_get_from_lladdr(parents, (rimeaddr_t *)&lladdr) == p &&
+        p->rank == 256, "parent entry unchanged");
+  check(nbr_table_get_from_lladdr(ds6_neighbors, NULL) == NULL,
+        "no lladdr-free neighbor left");
+
+  /* A second neighbor cannot take an address of the same table */
+  lladdr2 = lladdr;
+  lladdr2.addr[UIP_LLADDR_LEN - 1] = 0x2b;
+  uip_create_linklocal_prefix(&ipaddr2);
+  uip_ds6_set_addr_iid(&ipaddr2, &lladdr2);
+  nbr = uip_ds6_nbr_add(&ipaddr2, NULL, 0, NBR_INCOMPLETE);
+  check(nbr != NULL, "add second INCOMPLETE neighbor");
+  na_input(&ipaddr2, &lladdr);
+  nbr = uip_ds6_nbr_lookup(&ipaddr2);
+  check(nbr != NULL && nbr->state == NBR_INCOMPLETE,
+        "second neighbor still INCOMPLETE");
+  check(uip_ds6_nbr_ll_lookup(&lladdr) == uip_ds6_nbr_lookup(&ipaddr),
+        "first neighbor keeps its lladdr");
+
+  if(failed) {
+    printf("TEST FAILED\n");
+  } else {
+    printf("TEST OK\n");
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
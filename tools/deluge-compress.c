@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2026, The Contiki-PLB contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/*
+ * Compress an image for dissemination with Deluge, optionally as a
+ * delta against the image that the nodes already have. The output
+ * follows the format described in apps/deluge/deluge.h and is meant
+ * to be disseminated on a network built with DELUGE_CONF_COMPRESSION.
+ *
+ * Usage: deluge-compress <image> [<base image>] > <object>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Keep in sync with apps/deluge/deluge.h. */
+#define MIN_MATCH	3
+#define MAX_MATCH	(14 + MIN_MATCH)
+#define WINDOW		4096
+#define BASE_COPY	15
+#define MAX_BASE_MATCH	4095
+#define MIN_BASE_MATCH	5
+#define MAX_BASE_SIZE	(1L << 24)
+
+#define HASH_BITS	12
+#define HASH_SIZE	(1 << HASH_BITS)
+#define MAX_CHAIN	256
+
+static unsigned char control;
+static int nbits;
+static unsigned char items[8 * 5];
+static long out_size;
+static int nitems;
+/*---------------------------------------------------------------------------*/
+static void
+flush_group(void)
+{
+  if(nbits > 0) {
+    putchar(control);
+    fwrite(items, 1, nitems, stdout);
+    out_size += 1 + nitems;
+  }
+  control = 0;
+  nbits = 0;
+  nitems = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+put_item(int literal, const unsigned char *data, int len)
+{
+  if(literal) {
+    control |= 1 << nbits;
+  }
+  memcpy(&items[nitems], data, len);
+  nitems += len;
+  if(++nbits == 8) {
+    flush_group();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static unsigned char *
+read_file(const char *name, long *size)
+{
+  FILE *f;
+  unsigned char *buf;
+
+  f = fopen(name, "rb");
+  if(f == NULL) {
+    perror(name);
+    exit(1);
+  }
+  fseek(f, 0, SEEK_END);
+  *size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  buf = malloc(*size + 1);
+  if(buf == NULL || fread(buf, 1, *size, f) != (size_t)*size) {
+    fprintf(stderr, "%s: read error\n", name);
+    exit(1);
+  }
+  fclose(f);
+  return buf;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+hash(const unsigned char *p)
+{
+  return ((p[0] << 8) ^ (p[1] << 4) ^ p[2]) & (HASH_SIZE - 1);
+}
+/*---------------------------------------------------------------------------*/
+static long
+match_len(const unsigned char *a, const unsigned char *b, long max)
+{
+  long n;
+
+  for(n = 0; n < max && a[n] == b[n]; n++);
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/* Hash chains over the positions of a buffer, newest first. */
+static long *
+build_chains(const unsigned char *buf, long size, long *head)
+{
+  long *prev;
+  long i;
+
+  prev = malloc((size + 1) * sizeof(long));
+  if(prev == NULL) {
+    exit(1);
+  }
+  for(i = 0; i < HASH_SIZE; i++) {
+    head[i] = -1;
+  }
+  for(i = 0; i + MIN_MATCH <= size; i++) {
+    prev[i] = head[hash(&buf[i])];
+    head[hash(&buf[i])] = i;
+  }
+  return prev;
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  unsigned char *image, *base;
+  long image_size, base_size;
+  long base_head[HASH_SIZE], window_head[HASH_SIZE];
+  long *base_prev, *window_prev;
+  long pos, i, n, chain;
+  long best_len, best_off, base_len, base_off;
+  unsigned char item[5];
+
+  if(argc < 2 || argc > 3) {
+    fprintf(stderr, "usage: %s <image> [<base image>] > <object>\n", argv[0]);
+    return 1;
+  }
+
+  image = read_file(argv[1], &image_size);
+  base = NULL;
+  base_size = 0;
+  base_prev = NULL;
+  if(argc == 3) {
+    base = read_file(argv[2], &base_size);
+    if(base_size > MAX_BASE_SIZE) {
+      fprintf(stderr, "%s: base images are limited to %ld bytes\n",
+	      argv[2], MAX_BASE_SIZE);
+      return 1;
+    }
+    base_prev = build_chains(base, base_size, base_head);
+  }
+
+  window_prev = malloc((image_size + 1) * sizeof(long));
+  if(window_prev == NULL) {
+    return 1;
+  }
+  for(i = 0; i < HASH_SIZE; i++) {
+    window_head[i] = -1;
+  }
+
+  for(pos = 0; pos < image_size;) {
+    best_len = best_off = 0;
+    base_len = base_off = 0;
+
+    if(pos + MIN_MATCH <= image_size) {
+      chain = 0;
+      for(i = window_head[hash(&image[pos])];
+	  i >= 0 && pos - i <= WINDOW && chain < MAX_CHAIN;
+	  i = window_prev[i], chain++) {
+	n = match_len(&image[i], &image[pos],
+		      image_size - pos < MAX_MATCH ? image_size - pos : MAX_MATCH);
+	if(n > best_len) {
+	  best_len = n;
+	  best_off = pos - i;
+	}
+      }
+
+      if(base != NULL) {
+	/* Unchanged code usually stays at the same offset. */
+	if(pos < base_size) {
+	  base_len = match_len(&base[pos], &image[pos], base_size - pos);
+	  base_off = pos;
+	}
+	chain = 0;
+	for(i = base_head[hash(&image[pos])]; i >= 0 && chain < MAX_CHAIN;
+	    i = base_prev[i], chain++) {
+	  n = match_len(&base[i], &image[pos], base_size - i);
+	  if(n > base_len) {
+	    base_len = n;
+	    base_off = i;
+	  }
+	}
+	if(base_len > image_size - pos) {
+	  base_len = image_size - pos;
+	}
+	if(base_len > MAX_BASE_MATCH) {
+	  base_len = MAX_BASE_MATCH;
+	}
+      }
+    }
+
+    if(base_len >= MIN_BASE_MATCH && base_len > best_len) {
+      item[0] = (BASE_COPY << 4) | (base_len >> 8);
+      item[1] = base_len & 0xff;
+      item[2] = (base_off >> 16) & 0xff;
+      item[3] = (base_off >> 8) & 0xff;
+      item[4] = base_off & 0xff;
+      put_item(0, item, 5);
+      n = base_len;
+    } else if(best_len >= MIN_MATCH) {
+      item[0] = ((best_len - MIN_MATCH) << 4) | ((best_off - 1) >> 8);
+      item[1] = (best_off - 1) & 0xff;
+      put_item(0, item, 2);
+      n = best_len;
+    } else {
+      put_item(1, &image[pos], 1);
+      n = 1;
+    }
+
+    for(; n > 0; n--, pos++) {
+      if(pos + MIN_MATCH <= image_size) {
+	window_prev[pos] = window_head[hash(&image[pos])];
+	window_head[hash(&image[pos])] = pos;
+      }
+    }
+  }
+
+  /* The end of the stream. */
+  item[0] = BASE_COPY << 4;
+  item[1] = 0;
+  put_item(0, item, 2);
+  flush_group();
+
+  fprintf(stderr, "%ld bytes compressed into %ld bytes\n",
+	  image_size, out_size);
+  return 0;
+}
+/*---------------------------------------------------------------------------*/